@@ -0,0 +1,367 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChessBitboards.h"
+#include "ChessCpuFeatures.h"
+#include "HAL/IConsoleManager.h"
+
+#if PLATFORM_CPU_X86_FAMILY
+	#include <immintrin.h>
+#endif
+
+namespace
+{
+	//Magic multipliers found offline with a fixed seed search, one per square
+	//Every magic maps the relevant occupancy to exactly PopCount(Mask) bits, so magic and PEXT tables have equal size
+	const uint64 RookMagicNumbers[64] = {
+		0x1080004008801020ull, 0x0840092002C03000ull, 0x1900200010400900ull, 0x0880100008000480ull,
+		0x4200100420080200ull, 0x8100020100080400ull, 0x0200040110886200ull, 0x0200008040220411ull,
+		0x0404800084400220ull, 0x0000401000402000ull, 0x0086001081220440ull, 0x0408800800100280ull,
+		0x000A001201040820ull, 0x8848800200840080ull, 0x4001000100040200ull, 0x0442000102105084ull,
+		0x9080010020804100ull, 0x0040404000201009ull, 0x0000808010002009ull, 0x2200090021D00100ull,
+		0x0008008008040080ull, 0x0004004002010040ull, 0x0011040008015042ull, 0x00000A0001768104ull,
+		0x0000800080204009ull, 0x2010004140002001ull, 0x9800200280100080ull, 0x1000100080080080ull,
+		0x0442000A00049020ull, 0x2100040080020080ull, 0x0800120400900148ull, 0x0010040A00128541ull,
+		0x2800804000800030ull, 0x1010002000400041ull, 0x4000200011004100ull, 0x0610008410800800ull,
+		0x0400802402800800ull, 0xC100020080800400ull, 0x0002000802000401ull, 0x0182085882000401ull,
+		0x0220204000808000ull, 0x2860100040024022ull, 0x0001002004110040ull, 0x99101042000A0020ull,
+		0x0004080004008080ull, 0x0010040002008080ull, 0x2012004881020004ull, 0x8300842444820011ull,
+		0x0088403882010200ull, 0x0820400080210100ull, 0x0110910040A00300ull, 0x0801100280080480ull,
+		0x0242009008200600ull, 0x1002000489500200ull, 0x0040800200010080ull, 0x0091800041000080ull,
+		0x0000209300488001ull, 0x04C1002414824001ull, 0x020020000B001041ull, 0x7000100004200901ull,
+		0x8002002004100802ull, 0x30010002084C0007ull, 0x0888221800813004ull, 0x4000002840840112ull
+	};
+
+	const uint64 BishopMagicNumbers[64] = {
+		0xA010041108003100ull, 0x006082020A002900ull, 0x6810010619200000ull, 0x08281A0520000408ull,
+		0x0001104001000400ull, 0x0018901008048400ull, 0x00040A0210245280ull, 0x000200210808A402ull,
+		0x9140048410821200ull, 0x0800091010820041ull, 0x20504804832202C0ull, 0x0100091401081000ull,
+		0x8021011140000012ull, 0x0810020804450400ull, 0x208B0542109008A2ull, 0x0080084A08040204ull,
+		0x0040E2A80811244Cull, 0x2505022008008108ull, 0x0430220100420040ull, 0x010A040420220040ull,
+		0x1105000290400000ull, 0x0093001200822120ull, 0x4000A62048043004ull, 0x280120048A015004ull,
+		0x006090002A020814ull, 0x44042000240800D0ull, 0x01102800040A4400ull, 0x1004080080220040ull,
+		0x0001001011004024ull, 0x0010044000805040ull, 0x0914041200820100ull, 0x0004821012821480ull,
+		0x0024040500C05021ull, 0x0088611002080200ull, 0x0116080A00040020ull, 0x4000020080080080ull,
+		0x2450450140840040ull, 0x0000880201484100ull, 0x0222020404020092ull, 0x8081110600002E00ull,
+		0x2842101105000801ull, 0x1100809008001025ull, 0x00020202221C0400ull, 0x0422014022009020ull,
+		0x0210046102100C00ull, 0xC004008082029102ull, 0x00AA461801101200ull, 0x0404080080201108ull,
+		0x020542108C205002ull, 0x0410544804100100ull, 0x0040910841100000ull, 0x0400200042021100ull,
+		0x00004204850400C0ull, 0x0200100410A42102ull, 0x1040020801210102ull, 0x0805040410420000ull,
+		0x2884804130100200ull, 0x800C262201242000ull, 0x1058000194108800ull, 0x0014221054420204ull,
+		0x0104000012A02200ull, 0x0200881003300100ull, 0x0140400202840100ull, 0x0402020801010201ull
+	};
+
+	const int32 RookDirections[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+	const int32 BishopDirections[4][2] = { { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+
+	//Sum of 2^PopCount(Mask) over all squares
+	const int32 RookTableSize = 102400;
+	const int32 BishopTableSize = 5248;
+
+	uint64 RookTable[RookTableSize];
+	uint64 BishopTable[BishopTableSize];
+	uint64 RookPextTable[RookTableSize];
+	uint64 BishopPextTable[BishopTableSize];
+
+	//Walk rays from the square until the board edge or the first occupied tile
+	uint64 SlidingAttacks(int32 Square, uint64 Occupancy, const int32 (&Directions)[4][2])
+	{
+		uint64 Attacks = 0;
+
+		const int32 Rank = Square / 8;
+		const int32 File = Square % 8;
+
+		for (auto&& Direction : Directions)
+		{
+			int32 R = Rank + Direction[0];
+			int32 F = File + Direction[1];
+
+			while (R >= 0 && R < 8 && F >= 0 && F < 8)
+			{
+				const uint64 Bit = FChessBitboards::SquareBit(R * 8 + F);
+				Attacks |= Bit;
+
+				if (Occupancy & Bit)
+				{
+					break;
+				}
+
+				R += Direction[0];
+				F += Direction[1];
+			}
+		}
+
+		return Attacks;
+	}
+
+	//Tiles whose occupancy changes the attack set: rays without board edges
+	uint64 RelevantMask(int32 Square, const int32 (&Directions)[4][2])
+	{
+		uint64 Mask = 0;
+
+		const int32 Rank = Square / 8;
+		const int32 File = Square % 8;
+
+		for (auto&& Direction : Directions)
+		{
+			int32 R = Rank + Direction[0];
+			int32 F = File + Direction[1];
+
+			//Stop one tile before the edge in the direction of movement
+			while (
+				(Direction[0] == 0 || (R > 0 && R < 7)) &&
+				(Direction[1] == 0 || (F > 0 && F < 7))
+			)
+			{
+				Mask |= FChessBitboards::SquareBit(R * 8 + F);
+
+				R += Direction[0];
+				F += Direction[1];
+			}
+		}
+
+		return Mask;
+	}
+
+	//Software fallback of PEXT, used only to fill the tables
+	uint64 SoftwarePext(uint64 Value, uint64 Mask)
+	{
+		uint64 Result = 0;
+
+		for (uint64 Bit = 1; Mask; Bit <<= 1)
+		{
+			if (Value & Mask & (~Mask + 1))
+			{
+				Result |= Bit;
+			}
+
+			Mask &= Mask - 1;
+		}
+
+		return Result;
+	}
+
+	CHESS_TARGET_BMI2 FORCEINLINE uint64 HardwarePext(uint64 Value, uint64 Mask)
+	{
+#if PLATFORM_CPU_X86_FAMILY
+		return _pext_u64(Value, Mask);
+#else
+		return SoftwarePext(Value, Mask);
+#endif
+	}
+
+	TAutoConsoleVariable<int32> CVarChessSliderBackend(
+		TEXT("chess.SliderBackend"),
+		-1,
+		TEXT("Sliding pieces attacks backend.\n")
+		TEXT("-1: fastest supported (default)\n")
+		TEXT(" 0: classical ray walk\n")
+		TEXT(" 1: magic bitboards\n")
+		TEXT(" 2: BMI2 PEXT bitboards"),
+		ECVF_Default
+	);
+}
+
+EChessSliderBackend FChessBitboards::SliderBackend = EChessSliderBackend::Classical;
+FChessBitboards::FMagic FChessBitboards::RookMagics[64];
+FChessBitboards::FMagic FChessBitboards::BishopMagics[64];
+
+constexpr uint64 FChessBitboards::FileA;
+constexpr uint64 FChessBitboards::FileH;
+constexpr uint64 FChessBitboards::Rank1;
+constexpr uint64 FChessBitboards::Rank2;
+constexpr uint64 FChessBitboards::Rank3;
+constexpr uint64 FChessBitboards::Rank6;
+constexpr uint64 FChessBitboards::Rank7;
+constexpr uint64 FChessBitboards::Rank8;
+
+uint64 FChessBitboards::KnightAttacks[64];
+uint64 FChessBitboards::KingAttacks[64];
+uint64 FChessBitboards::PawnAttacks[2][64];
+
+uint64 FChessBitboards::Between[64][64];
+uint64 FChessBitboards::Line[64][64];
+
+//Fills attack tables on module load, before any position is created
+struct FChessBitboardsInitializer
+{
+	FChessBitboardsInitializer()
+	{
+		InitMagics(FChessBitboards::RookMagics, RookMagicNumbers, RookDirections, RookTable, RookPextTable);
+		InitMagics(FChessBitboards::BishopMagics, BishopMagicNumbers, BishopDirections, BishopTable, BishopPextTable);
+		InitLeapers();
+		InitLines();
+
+		FChessBitboards::SetSliderBackend(FChessBitboards::GetDefaultSliderBackend());
+
+		CVarChessSliderBackend->SetOnChangedCallback(FConsoleVariableDelegate::CreateLambda([](IConsoleVariable* Variable)
+		{
+			const int32 Value = Variable->GetInt();
+
+			FChessBitboards::SetSliderBackend(
+				FMath::IsWithinInclusive(Value, 0, 2)
+					? static_cast<EChessSliderBackend>(Value)
+					: FChessBitboards::GetDefaultSliderBackend()
+			);
+		}));
+	}
+
+	static void InitLeapers()
+	{
+		const int32 KnightOffsets[8][2] = { { 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 }, { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 } };
+		const int32 KingOffsets[8][2] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+
+		for (int32 Square = 0; Square < 64; ++Square)
+		{
+			FChessBitboards::KnightAttacks[Square] = LeaperAttacks(Square, KnightOffsets);
+			FChessBitboards::KingAttacks[Square] = LeaperAttacks(Square, KingOffsets);
+
+			//White pawns capture towards the eighth rank, black ones towards the first
+			const int32 WhitePawnOffsets[2][2] = { { 1, -1 }, { 1, 1 } };
+			const int32 BlackPawnOffsets[2][2] = { { -1, -1 }, { -1, 1 } };
+
+			FChessBitboards::PawnAttacks[0][Square] = LeaperAttacks(Square, WhitePawnOffsets);
+			FChessBitboards::PawnAttacks[1][Square] = LeaperAttacks(Square, BlackPawnOffsets);
+		}
+	}
+
+	static void InitLines()
+	{
+		for (int32 From = 0; From < 64; ++From)
+		{
+			for (int32 To = 0; To < 64; ++To)
+			{
+				const uint64 FromBit = FChessBitboards::SquareBit(From);
+				const uint64 ToBit = FChessBitboards::SquareBit(To);
+
+				FChessBitboards::Between[From][To] = 0;
+				FChessBitboards::Line[From][To] = 0;
+
+				for (auto* Directions : { &RookDirections, &BishopDirections })
+				{
+					if (From != To && (SlidingAttacks(From, 0, *Directions) & ToBit))
+					{
+						//Rays from both ends meet only on the tiles in between
+						FChessBitboards::Between[From][To] = SlidingAttacks(From, ToBit, *Directions) & SlidingAttacks(To, FromBit, *Directions);
+						FChessBitboards::Line[From][To] = (SlidingAttacks(From, 0, *Directions) & SlidingAttacks(To, 0, *Directions)) | FromBit | ToBit;
+					}
+				}
+			}
+		}
+	}
+
+	//Offsets are {rank, file} pairs, tiles outside of the board are skipped
+	template <int32 Num>
+	static uint64 LeaperAttacks(int32 Square, const int32 (&Offsets)[Num][2])
+	{
+		uint64 Attacks = 0;
+
+		for (auto&& Offset : Offsets)
+		{
+			const int32 R = Square / 8 + Offset[0];
+			const int32 F = Square % 8 + Offset[1];
+
+			if (R >= 0 && R < 8 && F >= 0 && F < 8)
+			{
+				Attacks |= FChessBitboards::SquareBit(R * 8 + F);
+			}
+		}
+
+		return Attacks;
+	}
+
+	static void InitMagics(
+		FChessBitboards::FMagic (&Magics)[64],
+		const uint64 (&Numbers)[64],
+		const int32 (&Directions)[4][2],
+		uint64* Table,
+		uint64* PextTable
+	)
+	{
+		int32 Offset = 0;
+
+		for (int32 Square = 0; Square < 64; ++Square)
+		{
+			FChessBitboards::FMagic& Magic = Magics[Square];
+
+			Magic.Mask = RelevantMask(Square, Directions);
+			Magic.Magic = Numbers[Square];
+			Magic.Shift = 64 - FChessBitboards::PopCount(Magic.Mask);
+			Magic.Attacks = Table + Offset;
+			Magic.PextAttacks = PextTable + Offset;
+
+			//Enumerate all subsets of the mask (Carry-Rippler trick)
+			uint64 Subset = 0;
+			do
+			{
+				const uint64 Attacks = SlidingAttacks(Square, Subset, Directions);
+
+				Magic.Attacks[(Subset * Magic.Magic) >> Magic.Shift] = Attacks;
+				Magic.PextAttacks[SoftwarePext(Subset, Magic.Mask)] = Attacks;
+
+				Subset = (Subset - Magic.Mask) & Magic.Mask;
+			}
+			while (Subset);
+
+			Offset += 1 << (64 - Magic.Shift);
+		}
+	}
+};
+
+static FChessBitboardsInitializer GChessBitboardsInitializer;
+
+CHESS_TARGET_BMI2 uint64 FChessBitboards::GetRookAttacksPext(int32 Square, uint64 Occupancy)
+{
+	const FMagic& Magic = RookMagics[Square];
+	return Magic.PextAttacks[HardwarePext(Occupancy, Magic.Mask)];
+}
+
+CHESS_TARGET_BMI2 uint64 FChessBitboards::GetBishopAttacksPext(int32 Square, uint64 Occupancy)
+{
+	const FMagic& Magic = BishopMagics[Square];
+	return Magic.PextAttacks[HardwarePext(Occupancy, Magic.Mask)];
+}
+
+uint64 FChessBitboards::GetRookAttacksClassical(int32 Square, uint64 Occupancy)
+{
+	return SlidingAttacks(Square, Occupancy, RookDirections);
+}
+
+uint64 FChessBitboards::GetBishopAttacksClassical(int32 Square, uint64 Occupancy)
+{
+	return SlidingAttacks(Square, Occupancy, BishopDirections);
+}
+
+bool FChessBitboards::SetSliderBackend(EChessSliderBackend Backend)
+{
+	if (Backend == EChessSliderBackend::Pext && !FChessCpuFeatures::HasBMI2())
+	{
+		SliderBackend = EChessSliderBackend::Magic;
+		return false;
+	}
+
+	SliderBackend = Backend;
+	return true;
+}
+
+EChessSliderBackend FChessBitboards::GetDefaultSliderBackend()
+{
+	return FChessCpuFeatures::HasFastPext() ? EChessSliderBackend::Pext : EChessSliderBackend::Magic;
+}
+
+const TCHAR* FChessBitboards::GetSliderBackendName(EChessSliderBackend Backend)
+{
+	switch (Backend)
+	{
+	case EChessSliderBackend::Classical:
+		return TEXT("Classical");
+
+	case EChessSliderBackend::Magic:
+		return TEXT("Magic");
+
+	case EChessSliderBackend::Pext:
+		return TEXT("PEXT");
+
+	default:
+		return TEXT("Unknown");
+	}
+}
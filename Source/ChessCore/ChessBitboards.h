@@ -0,0 +1,219 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+//Backend used to compute sliding pieces attacks
+enum class EChessSliderBackend : uint8
+{
+	//Walk rays square by square
+	Classical,
+
+	//Multiply-shift hashing of the relevant occupancy into precomputed tables
+	Magic,
+
+	//BMI2 parallel bit extract of the relevant occupancy, same tables layout as magics
+	Pext
+};
+
+/*
+ * Bitboard helpers and attack tables
+ * Squares are 0..63, A1 = 0, B1 = 1, ..., H8 = 63
+ */
+class CHESSCORE_API FChessBitboards
+{
+public:
+
+	//Attacks of the rook on Square, sliding until the first occupied tile (inclusive)
+	static FORCEINLINE uint64 GetRookAttacks(int32 Square, uint64 Occupancy)
+	{
+		switch (SliderBackend)
+		{
+		case EChessSliderBackend::Magic:
+			return GetRookAttacksMagic(Square, Occupancy);
+
+		case EChessSliderBackend::Pext:
+			return GetRookAttacksPext(Square, Occupancy);
+
+		default:
+			return GetRookAttacksClassical(Square, Occupancy);
+		}
+	}
+
+	//Attacks of the bishop on Square, sliding until the first occupied tile (inclusive)
+	static FORCEINLINE uint64 GetBishopAttacks(int32 Square, uint64 Occupancy)
+	{
+		switch (SliderBackend)
+		{
+		case EChessSliderBackend::Magic:
+			return GetBishopAttacksMagic(Square, Occupancy);
+
+		case EChessSliderBackend::Pext:
+			return GetBishopAttacksPext(Square, Occupancy);
+
+		default:
+			return GetBishopAttacksClassical(Square, Occupancy);
+		}
+	}
+
+	static FORCEINLINE uint64 GetQueenAttacks(int32 Square, uint64 Occupancy)
+	{
+		return GetRookAttacks(Square, Occupancy) | GetBishopAttacks(Square, Occupancy);
+	}
+
+	//Leaping pieces attacks, don't depend on occupancy
+	//
+	static FORCEINLINE uint64 GetKnightAttacks(int32 Square)
+	{
+		return KnightAttacks[Square];
+	}
+
+	static FORCEINLINE uint64 GetKingAttacks(int32 Square)
+	{
+		return KingAttacks[Square];
+	}
+
+	//Tiles attacked by the pawn of given color code (0 - white, 1 - black)
+	static FORCEINLINE uint64 GetPawnAttacks(int32 ColorCode, int32 Square)
+	{
+		return PawnAttacks[ColorCode][Square];
+	}
+
+	//Tiles strictly between two squares on the same rank, file or diagonal, zero if not aligned
+	static FORCEINLINE uint64 GetBetween(int32 From, int32 To)
+	{
+		return Between[From][To];
+	}
+
+	//Whole line from edge to edge going through both squares, zero if not aligned
+	static FORCEINLINE uint64 GetLine(int32 From, int32 To)
+	{
+		return Line[From][To];
+	}
+
+	//Backend specific lookups
+	//
+	static FORCEINLINE uint64 GetRookAttacksMagic(int32 Square, uint64 Occupancy)
+	{
+		const FMagic& Magic = RookMagics[Square];
+		return Magic.Attacks[((Occupancy & Magic.Mask) * Magic.Magic) >> Magic.Shift];
+	}
+
+	static FORCEINLINE uint64 GetBishopAttacksMagic(int32 Square, uint64 Occupancy)
+	{
+		const FMagic& Magic = BishopMagics[Square];
+		return Magic.Attacks[((Occupancy & Magic.Mask) * Magic.Magic) >> Magic.Shift];
+	}
+
+	static uint64 GetRookAttacksPext(int32 Square, uint64 Occupancy);
+	static uint64 GetBishopAttacksPext(int32 Square, uint64 Occupancy);
+
+	static uint64 GetRookAttacksClassical(int32 Square, uint64 Occupancy);
+	static uint64 GetBishopAttacksClassical(int32 Square, uint64 Occupancy);
+
+	//Active backend, shared by all positions
+	static EChessSliderBackend GetSliderBackend() { return SliderBackend; }
+
+	/**Select sliding attacks backend
+	 * @return False if backend isn't supported by this CPU, magics are used instead
+	 */
+	static bool SetSliderBackend(EChessSliderBackend Backend);
+
+	//Fastest backend supported by this CPU
+	static EChessSliderBackend GetDefaultSliderBackend();
+
+	//Display name of the backend
+	static const TCHAR* GetSliderBackendName(EChessSliderBackend Backend);
+
+	//Bit helpers
+	//
+	//Index of the least significant set bit, Bitboard must not be zero
+	static FORCEINLINE int32 GetLsb(uint64 Bitboard)
+	{
+#if defined(_MSC_VER)
+		unsigned long Index;
+		_BitScanForward64(&Index, Bitboard);
+		return static_cast<int32>(Index);
+#else
+		return __builtin_ctzll(Bitboard);
+#endif
+	}
+
+	//Index of the most significant set bit, Bitboard must not be zero
+	static FORCEINLINE int32 GetMsb(uint64 Bitboard)
+	{
+#if defined(_MSC_VER)
+		unsigned long Index;
+		_BitScanReverse64(&Index, Bitboard);
+		return static_cast<int32>(Index);
+#else
+		return 63 - __builtin_clzll(Bitboard);
+#endif
+	}
+
+	//Count of set bits
+	static FORCEINLINE int32 PopCount(uint64 Bitboard)
+	{
+#if defined(_MSC_VER)
+		return static_cast<int32>(__popcnt64(Bitboard));
+#else
+		return __builtin_popcountll(Bitboard);
+#endif
+	}
+
+	//Returns index of the least significant set bit and clears it
+	static FORCEINLINE int32 PopLsb(uint64& Bitboard)
+	{
+		const int32 Index = GetLsb(Bitboard);
+		Bitboard &= Bitboard - 1;
+		return Index;
+	}
+
+	static FORCEINLINE uint64 SquareBit(int32 Square)
+	{
+		return uint64(1) << Square;
+	}
+
+	//Board masks
+	//
+	static constexpr uint64 FileA = 0x0101010101010101ull;
+	static constexpr uint64 FileH = 0x8080808080808080ull;
+
+	static constexpr uint64 Rank1 = 0x00000000000000FFull;
+	static constexpr uint64 Rank2 = 0x000000000000FF00ull;
+	static constexpr uint64 Rank3 = 0x0000000000FF0000ull;
+	static constexpr uint64 Rank6 = 0x0000FF0000000000ull;
+	static constexpr uint64 Rank7 = 0x00FF000000000000ull;
+	static constexpr uint64 Rank8 = 0xFF00000000000000ull;
+
+private:
+
+	struct FMagic
+	{
+		//Relevant occupancy, the ray without its last tile
+		uint64 Mask;
+		uint64 Magic;
+		uint64* Attacks;
+		uint64* PextAttacks;
+		int32 Shift;
+	};
+
+	static EChessSliderBackend SliderBackend;
+
+	static FMagic RookMagics[64];
+	static FMagic BishopMagics[64];
+
+	static uint64 KnightAttacks[64];
+	static uint64 KingAttacks[64];
+	static uint64 PawnAttacks[2][64];
+
+	static uint64 Between[64][64];
+	static uint64 Line[64][64];
+
+	friend struct FChessBitboardsInitializer;
+};
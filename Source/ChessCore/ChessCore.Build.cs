@@ -0,0 +1,17 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+
+public class ChessCore : ModuleRules
+{
+	public ChessCore(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		//Flat module layout, expose module root to dependent modules
+		PublicIncludePaths.Add(ModuleDirectory);
+
+		//Only Core and reflection, no Engine, so the chess rules can be used by programs and worker threads
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject" });
+	}
+}
@@ -0,0 +1,8 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChessCore.h"
+#include "Modules/ModuleManager.h"
+
+DEFINE_LOG_CATEGORY(LogChessCore);
+
+IMPLEMENT_MODULE(FDefaultModuleImpl, ChessCore);
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChessCpuFeatures.h"
+
+#if PLATFORM_CPU_X86_FAMILY
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#endif
+
+namespace
+{
+	struct FCpuInfo
+	{
+		bool bBMI2 = false;
+		bool bFastPext = false;
+		bool bSSE41 = false;
+		bool bAVX2 = false;
+
+		FCpuInfo()
+		{
+#if PLATFORM_CPU_X86_FAMILY
+			uint32 Regs[4] = { 0 };
+
+			//Vendor string and max leaf
+			Query(0, 0, Regs);
+			const uint32 MaxLeaf = Regs[0];
+			const bool bAMD = Regs[1] == 0x68747541; //"Auth"enticAMD
+
+			//Features, ECX bit 19 is SSE4.1, bit 27 is OSXSAVE, bit 28 is AVX
+			Query(1, 0, Regs);
+			bSSE41 = (Regs[2] & (1u << 19)) != 0;
+
+			//AVX registers are usable only if the OS saves them on context switch (XCR0 bits 1 and 2)
+			const bool bOSAVX = (Regs[2] & (1u << 27)) != 0 && (Regs[2] & (1u << 28)) != 0 && (GetXCR0() & 0x6) == 0x6;
+
+			if (MaxLeaf >= 7)
+			{
+				//Structured extended features, EBX bit 8 is BMI2, bit 5 is AVX2
+				Query(7, 0, Regs);
+				bBMI2 = (Regs[1] & (1u << 8)) != 0;
+				bAVX2 = bOSAVX && (Regs[1] & (1u << 5)) != 0;
+			}
+
+			bFastPext = bBMI2;
+
+			if (bBMI2 && bAMD)
+			{
+				//Family 0x19 (Zen 3) is the first AMD family with hardware PEXT
+				Query(1, 0, Regs);
+				const uint32 BaseFamily = (Regs[0] >> 8) & 0xF;
+				const uint32 ExtFamily = (Regs[0] >> 20) & 0xFF;
+				const uint32 Family = BaseFamily == 0xF ? BaseFamily + ExtFamily : BaseFamily;
+
+				bFastPext = Family >= 0x19;
+			}
+#endif
+		}
+
+#if PLATFORM_CPU_X86_FAMILY
+		static void Query(uint32 Leaf, uint32 SubLeaf, uint32 (&OutRegs)[4])
+		{
+#if defined(_MSC_VER)
+			int32 Info[4];
+			__cpuidex(Info, Leaf, SubLeaf);
+			for (int32 i = 0; i < 4; ++i)
+			{
+				OutRegs[i] = static_cast<uint32>(Info[i]);
+			}
+#else
+			__cpuid_count(Leaf, SubLeaf, OutRegs[0], OutRegs[1], OutRegs[2], OutRegs[3]);
+#endif
+		}
+
+		//Must be called only when OSXSAVE is set
+		static uint64 GetXCR0()
+		{
+#if defined(_MSC_VER)
+			return _xgetbv(0);
+#else
+			uint32 Low, High;
+			__asm__ volatile("xgetbv" : "=a"(Low), "=d"(High) : "c"(0));
+			return (uint64(High) << 32) | Low;
+#endif
+		}
+#endif
+	};
+
+	const FCpuInfo& GetCpuInfo()
+	{
+		static const FCpuInfo Info;
+		return Info;
+	}
+}
+
+bool FChessCpuFeatures::HasBMI2()
+{
+	return GetCpuInfo().bBMI2;
+}
+
+bool FChessCpuFeatures::HasFastPext()
+{
+	return GetCpuInfo().bFastPext;
+}
+
+bool FChessCpuFeatures::HasSSE41()
+{
+	return GetCpuInfo().bSSE41;
+}
+
+bool FChessCpuFeatures::HasAVX2()
+{
+	return GetCpuInfo().bAVX2;
+}
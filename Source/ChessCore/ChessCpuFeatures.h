@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+ * Runtime detection of instruction set extensions used by the optimized code paths
+ * Queried once, results are cached
+ */
+class CHESSCORE_API FChessCpuFeatures
+{
+public:
+
+	//BMI2 instructions (PEXT, PDEP) are available
+	static bool HasBMI2();
+
+	//PEXT is implemented in hardware (pre-Zen 3 AMD CPUs microcode it and it is slower than magics)
+	static bool HasFastPext();
+
+	//SSE4.1 (and SSSE3 it includes) instructions are available
+	static bool HasSSE41();
+
+	//AVX2 instructions are available and the OS saves the YMM registers
+	static bool HasAVX2();
+};
+
+//Marks function to be compiled with BMI2 enabled, so it can be selected at runtime
+#if defined(__clang__) || defined(__GNUC__)
+	#define CHESS_TARGET_BMI2 __attribute__((target("bmi2")))
+	#define CHESS_TARGET_SSE41 __attribute__((target("sse4.1")))
+	#define CHESS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define CHESS_TARGET_BMI2
+	#define CHESS_TARGET_SSE41
+	#define CHESS_TARGET_AVX2
+#endif
@@ -71,7 +71,7 @@ enum class EPieceColor : uint8
 };
 
 /*Basic wrapper over ETileState enum*/
-class UNREALCHESS_API FChessPiece
+class CHESSCORE_API FChessPiece
 {
 	//Fast and lightweight chess piece data structure
 
@@ -0,0 +1,207 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChessEvaluation.h"
+#include "ChessBitboards.h"
+#include "ChessPawnTable.h"
+#include "ChessPieceSquareTables.h"
+#include "ChessPosition.h"
+
+namespace
+{
+	//Pawn structure weights, middlegame and endgame
+	//
+	const int32 DoubledMidgame = 10;
+	const int32 DoubledEndgame = 20;
+	const int32 IsolatedMidgame = 10;
+	const int32 IsolatedEndgame = 15;
+	const int32 BackwardMidgame = 8;
+	const int32 BackwardEndgame = 10;
+
+	//Passed pawn bonus by rank relative to the pawn color
+	//
+	const int32 PassedMidgame[8] = { 0, 5, 10, 20, 35, 60, 100, 0 };
+	const int32 PassedEndgame[8] = { 0, 10, 20, 40, 70, 120, 200, 0 };
+
+	//Shelter penalty by distance from the king to the nearest own pawn in front of it on the file,
+	//index 0 is used when there is no such pawn
+	const int32 ShelterPenalty[8] = { 30, 0, 10, 20, 25, 25, 25, 25 };
+
+	//Fill bitboard towards rank 8 or rank 1, set bits included
+	//
+	FORCEINLINE uint64 NorthFill(uint64 Bitboard)
+	{
+		Bitboard |= Bitboard << 8;
+		Bitboard |= Bitboard << 16;
+		Bitboard |= Bitboard << 32;
+		return Bitboard;
+	}
+
+	FORCEINLINE uint64 SouthFill(uint64 Bitboard)
+	{
+		Bitboard |= Bitboard >> 8;
+		Bitboard |= Bitboard >> 16;
+		Bitboard |= Bitboard >> 32;
+		return Bitboard;
+	}
+
+	//Shift to the neighbour file, bits don't wrap around the board edge
+	//
+	FORCEINLINE uint64 ShiftEast(uint64 Bitboard) { return (Bitboard << 1) & ~FChessBitboards::FileA; }
+	FORCEINLINE uint64 ShiftWest(uint64 Bitboard) { return (Bitboard >> 1) & ~FChessBitboards::FileH; }
+
+	//Pawn helpers by color, white pawns go north
+	//
+	FORCEINLINE uint64 Forward(uint64 Bitboard, int32 ColorCode)
+	{
+		return ColorCode == 0 ? Bitboard << 8 : Bitboard >> 8;
+	}
+
+	//Squares in front of the pawns, excluding the pawn squares
+	FORCEINLINE uint64 FrontSpan(uint64 Pawns, int32 ColorCode)
+	{
+		return ColorCode == 0 ? NorthFill(Pawns) << 8 : SouthFill(Pawns) >> 8;
+	}
+
+	FORCEINLINE uint64 PawnAttacks(uint64 Pawns, int32 ColorCode)
+	{
+		const uint64 Ahead = Forward(Pawns, ColorCode);
+		return ShiftEast(Ahead) | ShiftWest(Ahead);
+	}
+
+	FORCEINLINE int32 RelativeRank(int32 Square, int32 ColorCode)
+	{
+		return ColorCode == 0 ? Square / 8 : 7 - Square / 8;
+	}
+
+	//Pawn structure of one side, positive is good for that side
+	void EvaluateSidePawns(uint64 Own, uint64 Enemy, int32 ColorCode, int32& OutMidgame, int32& OutEndgame)
+	{
+		const int32 EnemyCode = ColorCode ^ 1;
+
+		//Every pawn behind another pawn of its file is doubled
+		const uint64 Doubled = Own & FrontSpan(Own, EnemyCode);
+
+		const uint64 OwnFiles = NorthFill(SouthFill(Own));
+		const uint64 Isolated = Own & ~(ShiftEast(OwnFiles) | ShiftWest(OwnFiles));
+
+		//Not blocked or attacked on the way by enemy pawns, and the front pawn of its file
+		const uint64 EnemySpan = FrontSpan(Enemy, EnemyCode);
+		const uint64 Passed = Own & ~(EnemySpan | ShiftEast(EnemySpan) | ShiftWest(EnemySpan)) & ~Doubled;
+
+		//Stop square is attacked by an enemy pawn and no neighbour pawn can come to defend it
+		const uint64 Support = ColorCode == 0
+			? NorthFill(PawnAttacks(Own, ColorCode))
+			: SouthFill(PawnAttacks(Own, ColorCode));
+		const uint64 BadStops = Forward(Own, ColorCode) & PawnAttacks(Enemy, EnemyCode) & ~Support;
+		const uint64 Backward = Forward(BadStops, EnemyCode) & ~Isolated;
+
+		const int32 DoubledCount = FChessBitboards::PopCount(Doubled);
+		const int32 IsolatedCount = FChessBitboards::PopCount(Isolated);
+		const int32 BackwardCount = FChessBitboards::PopCount(Backward);
+
+		OutMidgame -= DoubledCount * DoubledMidgame + IsolatedCount * IsolatedMidgame + BackwardCount * BackwardMidgame;
+		OutEndgame -= DoubledCount * DoubledEndgame + IsolatedCount * IsolatedEndgame + BackwardCount * BackwardEndgame;
+
+		uint64 PassedPawns = Passed;
+		while (PassedPawns)
+		{
+			const int32 Rank = RelativeRank(FChessBitboards::PopLsb(PassedPawns), ColorCode);
+
+			OutMidgame += PassedMidgame[Rank];
+			OutEndgame += PassedEndgame[Rank];
+		}
+	}
+
+	//Shelter of one side, zero or negative
+	int32 EvaluateSideShelter(uint64 King, uint64 Own, int32 ColorCode)
+	{
+		if (King == 0)
+		{
+			return 0;
+		}
+
+		const int32 KingSquare = FChessBitboards::GetLsb(King);
+		const int32 KingFile = KingSquare % 8;
+		const int32 KingRank = RelativeRank(KingSquare, ColorCode);
+
+		//Pawns in front of the king on its file and the adjacent ones
+		const uint64 Front = Own & FrontSpan(King | ShiftEast(King) | ShiftWest(King), ColorCode);
+
+		int32 Penalty = 0;
+
+		for (int32 File = FMath::Max(KingFile - 1, 0); File <= FMath::Min(KingFile + 1, 7); ++File)
+		{
+			const uint64 Shelter = Front & (FChessBitboards::FileA << File);
+
+			int32 Distance = 0;
+			if (Shelter)
+			{
+				//Nearest pawn is the lowest one for white and the highest one for black
+				const int32 Square = ColorCode == 0 ? FChessBitboards::GetLsb(Shelter) : FChessBitboards::GetMsb(Shelter);
+				Distance = RelativeRank(Square, ColorCode) - KingRank;
+			}
+
+			Penalty += ShelterPenalty[Distance];
+		}
+
+		return -Penalty;
+	}
+}
+
+int32 FChessEvaluation::Evaluate(const FChessPosition& Position, FChessPawnTable* PawnTable)
+{
+	if (const FChessNetwork* Network = Position.GetNetwork())
+	{
+		return Network->Evaluate(Position.GetAccumulator(), Position.GetSide());
+	}
+
+	//Piece-square scores are kept by the position, only the blend is computed here
+	int32 Midgame = Position.GetMidgameScore(EPieceColor::White) - Position.GetMidgameScore(EPieceColor::Black);
+	int32 Endgame = Position.GetEndgameScore(EPieceColor::White) - Position.GetEndgameScore(EPieceColor::Black);
+
+	if (PawnTable)
+	{
+		const FChessPawnEntry& Entry = PawnTable->Probe(Position);
+
+		Midgame += Entry.Midgame;
+		Endgame += Entry.Endgame;
+	}
+	else
+	{
+		int32 PawnsMidgame = 0;
+		int32 PawnsEndgame = 0;
+		EvaluatePawns(Position, PawnsMidgame, PawnsEndgame);
+
+		Midgame += PawnsMidgame;
+		Endgame += PawnsEndgame;
+	}
+
+	Midgame += EvaluateKingShelter(Position);
+
+	const int32 Score = FChessPieceSquareTables::Taper(Midgame, Endgame, Position.GetPhase());
+
+	return Position.GetSide() == EPieceColor::White ? Score : -Score;
+}
+
+void FChessEvaluation::EvaluatePawns(const FChessPosition& Position, int32& OutMidgame, int32& OutEndgame)
+{
+	const uint64 WhitePawns = Position.GetPieceBitboard(GWhitePawn);
+	const uint64 BlackPawns = Position.GetPieceBitboard(GBlackPawn);
+
+	int32 WhiteMidgame = 0;
+	int32 WhiteEndgame = 0;
+	EvaluateSidePawns(WhitePawns, BlackPawns, 0, WhiteMidgame, WhiteEndgame);
+
+	int32 BlackMidgame = 0;
+	int32 BlackEndgame = 0;
+	EvaluateSidePawns(BlackPawns, WhitePawns, 1, BlackMidgame, BlackEndgame);
+
+	OutMidgame = WhiteMidgame - BlackMidgame;
+	OutEndgame = WhiteEndgame - BlackEndgame;
+}
+
+int32 FChessEvaluation::EvaluateKingShelter(const FChessPosition& Position)
+{
+	return EvaluateSideShelter(Position.GetPieceBitboard(GWhiteKing), Position.GetPieceBitboard(GWhitePawn), 0)
+		- EvaluateSideShelter(Position.GetPieceBitboard(GBlackKing), Position.GetPieceBitboard(GBlackPawn), 1);
+}
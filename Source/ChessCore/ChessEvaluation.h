@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FChessPawnTable;
+class FChessPosition;
+
+/*
+ * Static evaluation of the position used by the search
+ * Tapered piece-square evaluation: middlegame and endgame scores are blended by the game phase
+ * Pawn structure and king shelter terms are added on top
+ * Positions with a network set (FChessPosition::SetNetwork) are evaluated by the network instead
+ * Scores are in centipawns from the moving side point of view
+ */
+class CHESSCORE_API FChessEvaluation
+{
+public:
+
+	/**Score of the position for the moving side
+	 * @param Position Position to evaluate
+	 * @param PawnTable Cache of pawn structure scores, may be null to evaluate pawns every time
+	 */
+	static int32 Evaluate(const FChessPosition& Position, FChessPawnTable* PawnTable = nullptr);
+
+	/**Pawn structure terms: passed, isolated, doubled and backward pawns
+	 * Depend on pawns only, so they can be cached by the pawn hash key
+	 * @param OutMidgame Middlegame score, white minus black
+	 * @param OutEndgame Endgame score, white minus black
+	 */
+	static void EvaluatePawns(const FChessPosition& Position, int32& OutMidgame, int32& OutEndgame);
+
+	/**Middlegame king shelter: own pawns in front of the king on its file and the adjacent ones
+	 * @return Penalty for missing or advanced shelter pawns, white minus black
+	 */
+	static int32 EvaluateKingShelter(const FChessPosition& Position);
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "ChessMove.h"
+
+namespace
+{
+	FORCEINLINE int32 SquareToTileIndex(int32 Square)
+	{
+		return 21 + (Square / 8) * 10 + Square % 8;
+	}
+}
+
+int32 FChessMove::GetFromTileIndex() const
+{
+	return SquareToTileIndex(GetFromSquare());
+}
+
+FTileCoord FChessMove::GetFrom() const
+{
+	return {GetFromSquare() % 8, GetFromSquare() / 8};
+}
+
+int32 FChessMove::GetToTileIndex() const
+{
+	return SquareToTileIndex(GetToSquare());
+}
+
+FTileCoord FChessMove::GetTo() const
+{
+	return {GetToSquare() % 8, GetToSquare() / 8};
+}
+
+const FChessPiece& FChessMove::GetPromotedPiece(EPieceColor Color) const
+{
+	if (!IsPromotion())
+	{
+		return GEmptyChessPiece;
+	}
+
+	const bool bWhite = Color == EPieceColor::White;
+
+	switch (GetFlags() & 0x3)
+	{
+	case PROMOTION_Knight:
+		return bWhite ? GWhiteKnight : GBlackKnight;
+	case PROMOTION_Bishop:
+		return bWhite ? GWhiteBishop : GBlackBishop;
+	case PROMOTION_Rook:
+		return bWhite ? GWhiteRook : GBlackRook;
+	default:
+		return bWhite ? GWhiteQueen : GBlackQueen;
+	}
+}
+
+FString FChessMove::ToString() const
+{
+	FString Result = GetFrom().ToString() + GetTo().ToString();
+
+	if (IsPromotion())
+	{
+		switch (GetFlags() & 0x3)
+		{
+		case PROMOTION_Queen:
+			Result.AppendChar(TEXT('q'));
+			break;
+		case PROMOTION_Rook:
+			Result.AppendChar(TEXT('r'));
+			break;
+		case PROMOTION_Bishop:
+			Result.AppendChar(TEXT('b'));
+			break;
+		case PROMOTION_Knight:
+			Result.AppendChar(TEXT('n'));
+			break;
+		default:
+			break;
+		}
+	}
+
+	return Result;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TileCoordinate.h"
+
+#include "ChessMove.generated.h"
+
+class FChessPiece;
+
+USTRUCT(BlueprintType)
+struct CHESSCORE_API FChessMove
+{
+	GENERATED_BODY()
+
+private:
+
+	uint16 Move = 0;
+
+public:
+
+	//Move kinds, stored in the upper 4 bits
+	//Bit 2 marks captures, bit 3 marks promotions, low 2 bits of a promotion are the promoted piece
+	static const int32 FLAG_Quiet = 0x0;
+	static const int32 FLAG_PawnStartMove = 0x1;
+	static const int32 FLAG_CastlingMove = 0x2;
+	static const int32 FLAG_Capture = 0x4;
+	static const int32 FLAG_EnPassantMove = 0x5;
+	static const int32 FLAG_Promotion = 0x8;
+
+	//Promoted piece, added to FLAG_Promotion
+	static const int32 PROMOTION_Knight = 0x0;
+	static const int32 PROMOTION_Bishop = 0x1;
+	static const int32 PROMOTION_Rook = 0x2;
+	static const int32 PROMOTION_Queen = 0x3;
+
+	FChessMove() = default;
+
+	/**Make move between two squares
+	 * @param From 0..63 square index (A1 = 0, H8 = 63)
+	 * @param To 0..63 square index
+	 * @param Flags One of the FLAG_ values
+	 */
+	FChessMove(int32 From, int32 To, int32 Flags = FLAG_Quiet) :
+		Move(static_cast<uint16>(From | (To << 6) | (Flags << 12)))
+	{}
+
+	//0..63 squares
+	int32 GetFromSquare()			const { return Move & 0x3F; }
+	int32 GetToSquare()				const { return (Move >> 6) & 0x3F; }
+
+	//120-tile indices and coords, used by the game side
+	int32 GetFromTileIndex() const;
+	FTileCoord GetFrom() const;
+
+	int32 GetToTileIndex() const;
+	FTileCoord GetTo() const;
+
+	int32 GetFlags()				const { return Move >> 12; }
+
+	bool IsCapture()				const { return Move & (FLAG_Capture << 12); }
+	bool IsPromotion()				const { return Move & (FLAG_Promotion << 12); }
+	bool IsEnPassantMove()			const { return GetFlags() == FLAG_EnPassantMove; }
+	bool IsPawnStartMove()			const { return GetFlags() == FLAG_PawnStartMove; }
+	bool IsCastlingMove()			const { return GetFlags() == FLAG_CastlingMove; }
+
+	/**Promoted piece of given color
+	 * @return Piece the pawn turns into, or empty piece if this is not a promotion
+	 */
+	const FChessPiece& GetPromotedPiece(EPieceColor Color) const;
+
+	bool IsValid()					const { return Move != 0; }
+	uint16 Raw()					const { return Move; }
+
+	//Move from the value returned by Raw, used by the hash tables
+	static FChessMove FromRaw(uint16 Raw)
+	{
+		FChessMove Result;
+		Result.Move = Raw;
+		return Result;
+	}
+
+	bool operator==(const FChessMove& Other) const { return Move == Other.Move; }
+	bool operator!=(const FChessMove& Other) const { return Move != Other.Move; }
+
+	//Move in coordinate notation ("e2e4", "e7e8q")
+	FString ToString() const;
+};
+
+/* Game Move Encoding */
+//Use 16 bits
+/*
+0000 0000 0011 1111 -> From square		0x3F
+0000 1111 1100 0000 -> To square		>> 6, 0x3F
+1111 0000 0000 0000 -> Flags			>> 12
+
+Flags
+0000 -> Quiet
+0001 -> Pawn start
+0010 -> Castling (side is taken from the To square)
+0100 -> Capture
+0101 -> En passant capture
+10pp -> Promotion to pp (knight, bishop, rook, queen)
+11pp -> Promotion with capture
+ */
@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChessMove.h"
+
+/*
+ * Fixed capacity list of moves with inline storage
+ * Lives on the stack (one per search ply), never allocates
+ * Storage is left uninitialized, only the first Num() moves are valid
+ *
+ * Every move has an ordering score, written by the generator (MVV-LVA for captures) or by the search
+ * Losing captures are scored below all other moves, so they are picked last
+ */
+class FChessMoveList
+{
+public:
+
+	//No legal position has more than 218 moves, rounded up
+	static constexpr int32 MaxMoves = 256;
+
+	//Captures losing material by SEE are scored LosingCaptureScore + SEE, below quiet moves of any history
+	static constexpr int32 LosingCaptureScore = -(1 << 20);
+
+	FORCEINLINE void Add(const FChessMove& Move, int32 Score = 0)
+	{
+		checkSlow(Count < MaxMoves);
+		Scores[Count] = Score;
+		new (&Moves[Count++]) FChessMove(Move);
+	}
+
+	FORCEINLINE void Reset()
+	{
+		Count = 0;
+	}
+
+	FORCEINLINE int32 Num() const
+	{
+		return Count;
+	}
+
+	FORCEINLINE bool IsValidIndex(int32 Index) const
+	{
+		return Index >= 0 && Index < Count;
+	}
+
+	FORCEINLINE FChessMove& operator[](int32 Index)
+	{
+		checkSlow(IsValidIndex(Index));
+		return GetData()[Index];
+	}
+
+	FORCEINLINE const FChessMove& operator[](int32 Index) const
+	{
+		checkSlow(IsValidIndex(Index));
+		return GetData()[Index];
+	}
+
+	FORCEINLINE int32 GetScore(int32 Index) const
+	{
+		checkSlow(IsValidIndex(Index));
+		return Scores[Index];
+	}
+
+	FORCEINLINE void SetScore(int32 Index, int32 Score)
+	{
+		checkSlow(IsValidIndex(Index));
+		Scores[Index] = Score;
+	}
+
+	//Was the move at Index flagged as losing material (see FChessPosition::SEE)
+	FORCEINLINE bool IsLosingCapture(int32 Index) const
+	{
+		return GetScore(Index) < LosingCaptureScore;
+	}
+
+	/**Move the best scored of the moves starting at Index to Index (one selection sort step)
+	 * Search usually cuts off after a few moves, so sorting the whole list is wasted work
+	 * @return Move at Index after the swap
+	 */
+	FORCEINLINE const FChessMove& PickNextMove(int32 Index)
+	{
+		checkSlow(IsValidIndex(Index));
+
+		int32 Best = Index;
+		for (int32 i = Index + 1; i < Count; ++i)
+		{
+			if (Scores[i] > Scores[Best])
+			{
+				Best = i;
+			}
+		}
+
+		if (Best != Index)
+		{
+			FChessMove* Data = GetData();
+
+			Swap(Data[Index], Data[Best]);
+			Swap(Scores[Index], Scores[Best]);
+		}
+
+		return GetData()[Index];
+	}
+
+	FORCEINLINE FChessMove* GetData() { return Moves[0].GetTypedPtr(); }
+	FORCEINLINE const FChessMove* GetData() const { return Moves[0].GetTypedPtr(); }
+
+	//Iterators for ranged for
+	//
+	FORCEINLINE FChessMove* begin() { return GetData(); }
+	FORCEINLINE FChessMove* end() { return GetData() + Count; }
+	FORCEINLINE const FChessMove* begin() const { return GetData(); }
+	FORCEINLINE const FChessMove* end() const { return GetData() + Count; }
+
+private:
+
+	//FChessMove is trivially copyable, so nothing has to be destroyed
+	TTypeCompatibleBytes<FChessMove> Moves[MaxMoves];
+	int32 Scores[MaxMoves];
+	int32 Count = 0;
+};
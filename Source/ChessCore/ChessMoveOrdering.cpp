@@ -0,0 +1,180 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChessMoveOrdering.h"
+#include "ChessMoveList.h"
+#include "ChessPosition.h"
+
+constexpr int32 FChessMoveOrdering::MaxPly;
+constexpr int32 FChessMoveOrdering::MaxKillers;
+constexpr int32 FChessMoveOrdering::MaxHistory;
+constexpr int32 FChessMoveOrdering::CaptureScore;
+constexpr int32 FChessMoveOrdering::KillerScore;
+constexpr int32 FChessMoveOrdering::CounterMoveScore;
+
+FChessMoveOrdering::FChessMoveOrdering()
+{
+	Clear();
+}
+
+void FChessMoveOrdering::Clear()
+{
+	FMemory::Memzero(History);
+
+	for (auto&& PlyKillers : Killers)
+	{
+		for (FChessMove& Killer : PlyKillers)
+		{
+			Killer = FChessMove();
+		}
+	}
+
+	for (auto&& PieceCounters : CounterMoves)
+	{
+		for (FChessMove& Counter : PieceCounters)
+		{
+			Counter = FChessMove();
+		}
+	}
+}
+
+void FChessMoveOrdering::NewSearch()
+{
+	//Killers depend on the root, plies of the new search are other positions
+	for (auto&& PlyKillers : Killers)
+	{
+		for (FChessMove& Killer : PlyKillers)
+		{
+			Killer = FChessMove();
+		}
+	}
+
+	for (auto&& SideHistory : History)
+	{
+		for (auto&& FromHistory : SideHistory)
+		{
+			for (int16& Entry : FromHistory)
+			{
+				Entry /= 2;
+			}
+		}
+	}
+}
+
+const FChessMove* FChessMoveOrdering::GetKillers(int32 Ply) const
+{
+	checkSlow(Ply >= 0 && Ply <= MaxPly);
+	return Killers[Ply];
+}
+
+FChessMove FChessMoveOrdering::GetCounterMove(const FChessPosition& Position) const
+{
+	const FChessMove LastMove = Position.GetLastMove();
+
+	if (!LastMove.IsValid())
+	{
+		return FChessMove();
+	}
+
+	const int32 To = LastMove.GetToSquare();
+	return CounterMoves[Position.GetPieceAt(To).GetCode()][To];
+}
+
+int32 FChessMoveOrdering::GetHistory(const FChessPosition& Position, const FChessMove& Move) const
+{
+	return History[(int32)Position.GetSide()][Move.GetFromSquare()][Move.GetToSquare()];
+}
+
+void FChessMoveOrdering::ScoreQuiets(const FChessPosition& Position, FChessMoveList& Moves) const
+{
+	const FChessMove CounterMove = GetCounterMove(Position);
+	const auto& SideHistory = History[(int32)Position.GetSide()];
+
+	for (int32 i = 0; i < Moves.Num(); ++i)
+	{
+		const FChessMove& Move = Moves[i];
+
+		Moves.SetScore(i, Move == CounterMove
+			? CounterMoveScore
+			: SideHistory[Move.GetFromSquare()][Move.GetToSquare()]);
+	}
+}
+
+void FChessMoveOrdering::ScoreMoves(const FChessPosition& Position, FChessMoveList& Moves, int32 Ply) const
+{
+	const FChessMove* PlyKillers = GetKillers(Ply);
+	const FChessMove CounterMove = GetCounterMove(Position);
+	const auto& SideHistory = History[(int32)Position.GetSide()];
+
+	for (int32 i = 0; i < Moves.Num(); ++i)
+	{
+		const FChessMove& Move = Moves[i];
+
+		//Losing captures flagged by GenerateAllMoves stay after quiet moves
+		if (Moves.IsLosingCapture(i))
+		{
+			continue;
+		}
+
+		//Generator already scored captures and promotions by MVV-LVA
+		if (Move.IsCapture() || Move.IsPromotion())
+		{
+			Moves.SetScore(i, CaptureScore + Moves.GetScore(i));
+		}
+		else if (Move == PlyKillers[0])
+		{
+			Moves.SetScore(i, KillerScore + 1);
+		}
+		else if (Move == PlyKillers[1])
+		{
+			Moves.SetScore(i, KillerScore);
+		}
+		else if (Move == CounterMove)
+		{
+			Moves.SetScore(i, CounterMoveScore);
+		}
+		else
+		{
+			Moves.SetScore(i, SideHistory[Move.GetFromSquare()][Move.GetToSquare()]);
+		}
+	}
+}
+
+void FChessMoveOrdering::UpdateCutoff(const FChessPosition& Position,
+                                      const FChessMove& Move,
+                                      int32 Ply,
+                                      int32 Depth,
+                                      const FChessMove* TriedQuiets,
+                                      int32 TriedCount)
+{
+	checkSlow(!Move.IsCapture() && !Move.IsPromotion());
+
+	//Newest killer goes first, the same move isn't stored twice
+	if (Ply <= MaxPly && !(Killers[Ply][0] == Move))
+	{
+		Killers[Ply][1] = Killers[Ply][0];
+		Killers[Ply][0] = Move;
+	}
+
+	const FChessMove LastMove = Position.GetLastMove();
+	if (LastMove.IsValid())
+	{
+		const int32 To = LastMove.GetToSquare();
+		CounterMoves[Position.GetPieceAt(To).GetCode()][To] = Move;
+	}
+
+	//Small depths are close to the leaves, their cutoffs say little
+	const int32 Bonus = FMath::Min(16 * Depth * Depth, MaxHistory / 8);
+	auto& SideHistory = History[(int32)Position.GetSide()];
+
+	UpdateHistory(SideHistory[Move.GetFromSquare()][Move.GetToSquare()], Bonus);
+
+	for (int32 i = 0; i < TriedCount; ++i)
+	{
+		UpdateHistory(SideHistory[TriedQuiets[i].GetFromSquare()][TriedQuiets[i].GetToSquare()], -Bonus);
+	}
+}
+
+void FChessMoveOrdering::UpdateHistory(int16& Entry, int32 Bonus)
+{
+	Entry += Bonus - Entry * FMath::Abs(Bonus) / MaxHistory;
+}
@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChessMove.h"
+
+class FChessMoveList;
+class FChessPosition;
+
+/*
+ * Quiet move ordering heuristics learned during the search, one instance per search thread
+ *   Killers: two quiet moves per ply which caused a cutoff in a sibling node
+ *   History: butterfly table [side][from][to], moves which cut off often and deep score higher
+ *   Countermoves: quiet move which refuted the previous move, keyed by its piece and destination
+ *
+ * Any cutoff-driven loop can use it: ScoreMoves before picking moves, UpdateCutoff after a quiet cutoff
+ */
+class CHESSCORE_API FChessMoveOrdering
+{
+public:
+
+	static constexpr int32 MaxPly = 128;
+	static constexpr int32 MaxKillers = 2;
+
+	//History scores are kept in [-MaxHistory, MaxHistory]
+	static constexpr int32 MaxHistory = 16384;
+
+	//Ordering scores of ScoreMoves, captures go first, then killers, the countermove and other quiet moves by history
+	//
+	static constexpr int32 CaptureScore = 1 << 24;
+	static constexpr int32 KillerScore = 1 << 22;
+	static constexpr int32 CounterMoveScore = 1 << 21;
+
+	FChessMoveOrdering();
+
+	//Forget everything, for a new game
+	void Clear();
+
+	//Prepare for a new search: killers are cleared, history is halved so old statistics fade out
+	void NewSearch();
+
+	/**Killer moves of the ply, invalid moves if not set
+	 * @return Array of MaxKillers moves
+	 */
+	const FChessMove* GetKillers(int32 Ply) const;
+
+	/**Quiet move which refuted the last move of the position before
+	 * @return Invalid move if not known
+	 */
+	FChessMove GetCounterMove(const FChessPosition& Position) const;
+
+	//History score of the quiet move of the moving side
+	int32 GetHistory(const FChessPosition& Position, const FChessMove& Move) const;
+
+	/**Score quiet moves by countermove and history, killers are not scored
+	 * @param Position Position the moves were generated in
+	 * @param Moves Quiet moves to score
+	 */
+	void ScoreQuiets(const FChessPosition& Position, FChessMoveList& Moves) const;
+
+	/**Score any generated moves: captures by MVV-LVA, then killers, countermove and history
+	 * @param Position Position the moves were generated in
+	 * @param Moves Moves to score, for FChessMoveList::PickNextMove
+	 * @param Ply Distance from the root, selects killers
+	 */
+	void ScoreMoves(const FChessPosition& Position, FChessMoveList& Moves, int32 Ply) const;
+
+	/**Learn from a quiet move which caused a beta cutoff
+	 * @param Position Position the move was made in
+	 * @param Move Move which cut off
+	 * @param Ply Distance from the root
+	 * @param Depth Remaining depth, deeper cutoffs get bigger bonus
+	 * @param TriedQuiets Quiet moves searched before it without a cutoff, they get a penalty
+	 * @param TriedCount Count of TriedQuiets
+	 */
+	void UpdateCutoff(const FChessPosition& Position,
+	                  const FChessMove& Move,
+	                  int32 Ply,
+	                  int32 Depth,
+	                  const FChessMove* TriedQuiets,
+	                  int32 TriedCount);
+
+private:
+
+	//Move the score towards the limit, the closer it already is, the smaller the step
+	static void UpdateHistory(int16& Entry, int32 Bonus);
+
+	FChessMove Killers[MaxPly + 1][MaxKillers];
+
+	//[side][from][to]
+	int16 History[2][64][64];
+
+	//[piece code][to square] of the previous move
+	FChessMove CounterMoves[13][64];
+};
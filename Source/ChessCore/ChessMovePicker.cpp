@@ -0,0 +1,193 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChessMovePicker.h"
+#include "ChessMoveOrdering.h"
+#include "ChessPosition.h"
+
+constexpr int32 FChessMovePicker::MaxRefutations;
+
+void FChessMovePickerStats::Reset()
+{
+	for (uint64& Count : Reached)
+	{
+		Count = 0;
+	}
+}
+
+FChessMovePicker::FChessMovePicker(const FChessPosition& InPosition,
+                                   const FChessMove& InHashMove,
+                                   const FChessMoveOrdering* InOrdering,
+                                   int32 InPly,
+                                   FChessMovePickerStats* InStats) :
+	Position(InPosition),
+	Ordering(InOrdering),
+	Stats(InStats),
+	Ply(InPly)
+{
+	//Checked against the board without generating moves, so a hash move cutoff costs no generation at all
+	if (InHashMove.IsValid() && Position.IsLegalMove(InHashMove))
+	{
+		HashMove = InHashMove;
+	}
+
+	SetStage(EChessPickStage::HashMove);
+}
+
+FChessMove FChessMovePicker::Next()
+{
+	while (true)
+	{
+		switch (Stage)
+		{
+		case EChessPickStage::HashMove:
+			SetStage(EChessPickStage::Captures);
+
+			//Captures are generated on the next call, hash move cutoffs don't need them
+			if (HashMove.IsValid())
+			{
+				return HashMove;
+			}
+			break;
+
+		case EChessPickStage::Captures:
+			if (!bGenerated)
+			{
+				Position.GenerateMoves(Moves, EChessMoveGen::Captures);
+				bGenerated = true;
+			}
+
+			while (Index < Moves.Num())
+			{
+				const FChessMove Move = Moves.PickNextMove(Index++);
+
+				if (Move == HashMove)
+				{
+					continue;
+				}
+
+				//SEE is computed only for captures reached, cutoffs usually come before the losing ones
+				if (Move.IsCapture() && Position.SEE(Move) < 0)
+				{
+					BadCaptures[NumBadCaptures++] = Move;
+					continue;
+				}
+
+				return Move;
+			}
+
+			SetStage(EChessPickStage::Killers);
+			break;
+
+		case EChessPickStage::Killers:
+			//Refutations are checked only by nodes which get this far, captures cut off most nodes before
+			if (!bGenerated)
+			{
+				AddRefutations();
+				bGenerated = true;
+			}
+
+			if (Index < NumRefutations)
+			{
+				return Refutations[Index++];
+			}
+
+			SetStage(EChessPickStage::Quiets);
+			break;
+
+		case EChessPickStage::Quiets:
+			if (!bGenerated)
+			{
+				Position.GenerateMoves(Moves, EChessMoveGen::Quiets);
+				bGenerated = true;
+
+				if (Ordering)
+				{
+					Ordering->ScoreQuiets(Position, Moves);
+				}
+			}
+
+			while (Index < Moves.Num())
+			{
+				const FChessMove Move = Moves.PickNextMove(Index++);
+
+				if (!IsPicked(Move))
+				{
+					return Move;
+				}
+			}
+
+			SetStage(EChessPickStage::BadCaptures);
+			break;
+
+		case EChessPickStage::BadCaptures:
+			if (Index < NumBadCaptures)
+			{
+				return BadCaptures[Index++];
+			}
+
+			SetStage(EChessPickStage::Done);
+			break;
+
+		default:
+			return FChessMove();
+		}
+	}
+}
+
+void FChessMovePicker::SetStage(EChessPickStage NewStage)
+{
+	Stage = NewStage;
+	Index = 0;
+	bGenerated = false;
+
+	if (Stats)
+	{
+		++Stats->Reached[static_cast<int32>(NewStage)];
+	}
+}
+
+void FChessMovePicker::AddRefutations()
+{
+	if (Ordering)
+	{
+		const FChessMove* Killers = Ordering->GetKillers(Ply);
+
+		for (int32 i = 0; i < FChessMoveOrdering::MaxKillers; ++i)
+		{
+			AddRefutation(Killers[i]);
+		}
+
+		AddRefutation(Ordering->GetCounterMove(Position));
+	}
+}
+
+void FChessMovePicker::AddRefutation(const FChessMove& Move)
+{
+	//Refutations come from other nodes, so they must be checked for this position
+	if (Move.IsValid()
+		&& !Move.IsCapture()
+		&& !Move.IsPromotion()
+		&& !IsPicked(Move)
+		&& Position.IsLegalMove(Move))
+	{
+		Refutations[NumRefutations++] = Move;
+	}
+}
+
+bool FChessMovePicker::IsPicked(const FChessMove& Move) const
+{
+	if (Move == HashMove)
+	{
+		return true;
+	}
+
+	for (int32 i = 0; i < NumRefutations; ++i)
+	{
+		if (Move == Refutations[i])
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChessMove.h"
+#include "ChessMoveList.h"
+
+class FChessMoveOrdering;
+class FChessPosition;
+
+//Stages of FChessMovePicker, in the order moves are yielded
+enum class EChessPickStage : uint8
+{
+	HashMove,
+	Captures,
+
+	//Killers and the countermove
+	Killers,
+	Quiets,
+
+	//Captures losing material by SEE, deferred from the captures stage
+	BadCaptures,
+	Done,
+
+	Count
+};
+
+//How many times each stage was entered, shared by all pickers of one search
+struct CHESSCORE_API FChessMovePickerStats
+{
+	uint64 Reached[static_cast<int32>(EChessPickStage::Count)] = {};
+
+	void Reset();
+
+	uint64 GetReached(EChessPickStage Stage) const { return Reached[static_cast<int32>(Stage)]; }
+
+	//Count of pickers, every picker enters the first stage
+	uint64 GetPicks() const { return GetReached(EChessPickStage::HashMove); }
+};
+
+/*
+ * Staged move generator
+ * Yields the preferred (hash) move first, then generates captures and promotions ordered by MVV-LVA,
+ * then the killer moves and the countermove, and only then generates quiet moves ordered by history
+ * Captures losing material by SEE are deferred until after quiet moves
+ * Search usually cuts off before the last stage, so most nodes never generate quiet moves
+ *
+ * Every move is yielded once and all of them are legal
+ * The position must not change between calls to Next, except for moves made and taken back
+ */
+class CHESSCORE_API FChessMovePicker
+{
+public:
+
+	//Two killers and the countermove
+	static constexpr int32 MaxRefutations = 3;
+
+	/**Make picker
+	 * @param InPosition Position to pick moves of
+	 * @param InHashMove Move to yield first, skipped if invalid or illegal
+	 * @param InOrdering Killers, countermove and history of the search, may be null to yield quiet moves unordered
+	 * @param InPly Distance from the root, selects killers
+	 * @param InStats Counters to update, may be null
+	 */
+	FChessMovePicker(const FChessPosition& InPosition,
+	                 const FChessMove& InHashMove,
+	                 const FChessMoveOrdering* InOrdering = nullptr,
+	                 int32 InPly = 0,
+	                 FChessMovePickerStats* InStats = nullptr);
+
+	/**Next move to search
+	 * @return Invalid move when all moves are yielded
+	 */
+	FChessMove Next();
+
+	EChessPickStage GetStage() const { return Stage; }
+
+private:
+
+	//Enter the stage and count it
+	void SetStage(EChessPickStage NewStage);
+
+	//Add the killers and the countermove, on entering the killers stage
+	void AddRefutations();
+
+	//Add refutation, if it's a quiet legal move not added yet
+	void AddRefutation(const FChessMove& Move);
+
+	//Is move already yielded by the hash move or killer stage
+	bool IsPicked(const FChessMove& Move) const;
+
+	const FChessPosition& Position;
+	const FChessMoveOrdering* Ordering;
+	FChessMovePickerStats* Stats;
+
+	//Distance from the root, selects killers
+	int32 Ply;
+
+	FChessMove HashMove;
+	FChessMove Refutations[MaxRefutations];
+	int32 NumRefutations = 0;
+
+	EChessPickStage Stage = EChessPickStage::HashMove;
+
+	//Moves of the current generated stage
+	FChessMoveList Moves;
+	int32 Index = 0;
+	bool bGenerated = false;
+
+	//Losing captures in MVV-LVA order, quiet moves reuse the list of captures
+	FChessMove BadCaptures[FChessMoveList::MaxMoves];
+	int32 NumBadCaptures = 0;
+};
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChessMove.h"
+
+/**
+ * Undo information of the made move, 16 bytes
+ */
+struct CHESSCORE_API FChessMoveRecord
+{
+	//
+	FChessMove Move;
+
+	//Piece taken by the move, the move itself doesn't store it
+	FChessPiece Captured;
+
+	//
+	uint8 CastlePermission;
+
+	//0..63 square, or INDEX_NONE
+	int8 EnPassantTile;
+
+	//
+	uint16 FiftyMove;
+
+	//
+	uint64 PosHashKey;
+};
@@ -0,0 +1,475 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChessNetwork.h"
+#include "ChessCpuFeatures.h"
+#include "ChessPieceSquareTables.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if PLATFORM_CPU_X86_FAMILY
+	#include <immintrin.h>
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC(LogChessNetwork, Log, All);
+
+namespace
+{
+	constexpr int32 HiddenSize = FChessNetwork::HiddenSize;
+	constexpr int32 ActivationMax = FChessNetwork::ActivationMax;
+
+	//Bootstrap network: neurons per perspective on the thermometer and the offset keeping sums positive
+	//96 neurons pass up to 12192 centipawns per side, enough for any number of promoted queens
+	//
+	constexpr int32 ThermometerNeurons = 96;
+	constexpr int32 ThermometerOffset = 200;
+
+	TAutoConsoleVariable<int32> CVarChessUseNetwork(
+		TEXT("chess.UseNetwork"),
+		0,
+		TEXT("Evaluate game positions with the network of Content/Network/Chess.nnue instead of piece-square tables.\n")
+		TEXT("Read when the game state is created."),
+		ECVF_Default
+	);
+
+	static_assert(HiddenSize % 32 == 0, "SIMD paths process 32 neurons at once");
+	static_assert(ThermometerNeurons <= HiddenSize, "Thermometer doesn't fit into the hidden layer");
+
+	//Accumulator rows, Out += Add - Sub, either row may be null
+	//
+	void UpdateRowsScalar(int16* Out, const int16* Add, const int16* Sub)
+	{
+		for (int32 i = 0; i < HiddenSize; ++i)
+		{
+			Out[i] += (Add ? Add[i] : 0) - (Sub ? Sub[i] : 0);
+		}
+	}
+
+	//Clipped ReLU of both halves times output weights
+	int32 DotScalar(const int16* Us, const int16* Them, const int8* Weights)
+	{
+		int32 Sum = 0;
+
+		for (int32 i = 0; i < HiddenSize; ++i)
+		{
+			Sum += FMath::Clamp<int32>(Us[i], 0, ActivationMax) * Weights[i];
+			Sum += FMath::Clamp<int32>(Them[i], 0, ActivationMax) * Weights[HiddenSize + i];
+		}
+
+		return Sum;
+	}
+
+#if PLATFORM_CPU_X86_FAMILY
+	CHESS_TARGET_SSE41 void UpdateRowsSSE41(int16* Out, const int16* Add, const int16* Sub)
+	{
+		for (int32 i = 0; i < HiddenSize; i += 8)
+		{
+			__m128i Value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Out + i));
+
+			if (Add)
+			{
+				Value = _mm_add_epi16(Value, _mm_loadu_si128(reinterpret_cast<const __m128i*>(Add + i)));
+			}
+
+			if (Sub)
+			{
+				Value = _mm_sub_epi16(Value, _mm_loadu_si128(reinterpret_cast<const __m128i*>(Sub + i)));
+			}
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Out + i), Value);
+		}
+	}
+
+	//16 activations of one half packed to uint8, times 16 int8 weights, summed into 4 int32 lanes
+	CHESS_TARGET_SSE41 FORCEINLINE __m128i DotHalfSSE41(const int16* Values, const int8* Weights, __m128i Sum)
+	{
+		const __m128i Zero = _mm_setzero_si128();
+		const __m128i Max = _mm_set1_epi16(ActivationMax);
+		const __m128i Ones = _mm_set1_epi16(1);
+
+		for (int32 i = 0; i < HiddenSize; i += 16)
+		{
+			const __m128i Low = _mm_min_epi16(_mm_max_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Values + i)), Zero), Max);
+			const __m128i High = _mm_min_epi16(_mm_max_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Values + i + 8)), Zero), Max);
+			const __m128i Activations = _mm_packus_epi16(Low, High);
+
+			//uint8 x int8 pairs into int16, then int16 pairs into int32
+			const __m128i Products = _mm_maddubs_epi16(Activations, _mm_loadu_si128(reinterpret_cast<const __m128i*>(Weights + i)));
+			Sum = _mm_add_epi32(Sum, _mm_madd_epi16(Products, Ones));
+		}
+
+		return Sum;
+	}
+
+	CHESS_TARGET_SSE41 int32 DotSSE41(const int16* Us, const int16* Them, const int8* Weights)
+	{
+		__m128i Sum = _mm_setzero_si128();
+		Sum = DotHalfSSE41(Us, Weights, Sum);
+		Sum = DotHalfSSE41(Them, Weights + HiddenSize, Sum);
+
+		Sum = _mm_add_epi32(Sum, _mm_shuffle_epi32(Sum, _MM_SHUFFLE(1, 0, 3, 2)));
+		Sum = _mm_add_epi32(Sum, _mm_shuffle_epi32(Sum, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtsi128_si32(Sum);
+	}
+
+	CHESS_TARGET_AVX2 void UpdateRowsAVX2(int16* Out, const int16* Add, const int16* Sub)
+	{
+		for (int32 i = 0; i < HiddenSize; i += 16)
+		{
+			__m256i Value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Out + i));
+
+			if (Add)
+			{
+				Value = _mm256_add_epi16(Value, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Add + i)));
+			}
+
+			if (Sub)
+			{
+				Value = _mm256_sub_epi16(Value, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Sub + i)));
+			}
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(Out + i), Value);
+		}
+	}
+
+	CHESS_TARGET_AVX2 FORCEINLINE __m256i DotHalfAVX2(const int16* Values, const int8* Weights, __m256i Sum)
+	{
+		const __m256i Zero = _mm256_setzero_si256();
+		const __m256i Max = _mm256_set1_epi16(ActivationMax);
+		const __m256i Ones = _mm256_set1_epi16(1);
+
+		for (int32 i = 0; i < HiddenSize; i += 32)
+		{
+			const __m256i Low = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(Values + i)), Zero), Max);
+			const __m256i High = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(Values + i + 16)), Zero), Max);
+
+			//Pack works within 128-bit lanes, restore the neuron order to match the weights
+			const __m256i Activations = _mm256_permute4x64_epi64(_mm256_packus_epi16(Low, High), _MM_SHUFFLE(3, 1, 2, 0));
+
+			const __m256i Products = _mm256_maddubs_epi16(Activations, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Weights + i)));
+			Sum = _mm256_add_epi32(Sum, _mm256_madd_epi16(Products, Ones));
+		}
+
+		return Sum;
+	}
+
+	CHESS_TARGET_AVX2 int32 DotAVX2(const int16* Us, const int16* Them, const int8* Weights)
+	{
+		__m256i Sum = _mm256_setzero_si256();
+		Sum = DotHalfAVX2(Us, Weights, Sum);
+		Sum = DotHalfAVX2(Them, Weights + HiddenSize, Sum);
+
+		__m128i Half = _mm_add_epi32(_mm256_castsi256_si128(Sum), _mm256_extracti128_si256(Sum, 1));
+		Half = _mm_add_epi32(Half, _mm_shuffle_epi32(Half, _MM_SHUFFLE(1, 0, 3, 2)));
+		Half = _mm_add_epi32(Half, _mm_shuffle_epi32(Half, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtsi128_si32(Half);
+	}
+#endif
+
+	FORCEINLINE void UpdateRows(int16* Out, const int16* Add, const int16* Sub)
+	{
+#if PLATFORM_CPU_X86_FAMILY
+		switch (FChessNetwork::GetSimd())
+		{
+		case EChessNetworkSimd::AVX2:
+			UpdateRowsAVX2(Out, Add, Sub);
+			return;
+
+		case EChessNetworkSimd::SSE41:
+			UpdateRowsSSE41(Out, Add, Sub);
+			return;
+
+		default:
+			break;
+		}
+#endif
+		UpdateRowsScalar(Out, Add, Sub);
+	}
+
+	//Read a value at the offset and advance it, false if the data ends
+	template <typename T>
+	bool ReadValues(const TArray<uint8>& Data, int64& Offset, T* OutValues, int32 Count)
+	{
+		const int64 Size = int64(sizeof(T)) * Count;
+
+		if (Offset + Size > Data.Num())
+		{
+			return false;
+		}
+
+		FMemory::Memcpy(OutValues, Data.GetData() + Offset, Size);
+		Offset += Size;
+		return true;
+	}
+
+	template <typename T>
+	void WriteValues(TArray<uint8>& Data, const T* Values, int32 Count)
+	{
+		const int32 Size = static_cast<int32>(sizeof(T)) * Count;
+		const int32 Offset = Data.Num();
+
+		Data.AddUninitialized(Size);
+		FMemory::Memcpy(Data.GetData() + Offset, Values, Size);
+	}
+}
+
+constexpr int32 FChessAccumulator::HiddenSize;
+constexpr int32 FChessNetwork::InputSize;
+constexpr int32 FChessNetwork::HiddenSize;
+constexpr int32 FChessNetwork::ActivationMax;
+constexpr uint32 FChessNetwork::Magic;
+constexpr uint32 FChessNetwork::Version;
+
+EChessNetworkSimd FChessNetwork::Simd = FChessNetwork::GetDefaultSimd();
+
+FChessNetwork::FChessNetwork()
+{
+	FeatureWeights.SetNumZeroed(InputSize * HiddenSize);
+	FeatureBiases.SetNumZeroed(HiddenSize);
+	OutputWeights.SetNumZeroed(2 * HiddenSize);
+}
+
+bool FChessNetwork::Load(const FString& Path)
+{
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *Path))
+	{
+		UE_LOG(LogChessNetwork, Warning, TEXT("Can't read network file %s"), *Path);
+		return false;
+	}
+
+	int64 Offset = 0;
+	uint32 Header[4] = { 0 };
+	int32 FileOutputScale = 0;
+
+	if (!ReadValues(Data, Offset, Header, 4) || !ReadValues(Data, Offset, &FileOutputScale, 1))
+	{
+		UE_LOG(LogChessNetwork, Warning, TEXT("Network file %s is truncated"), *Path);
+		return false;
+	}
+
+	if (Header[0] != Magic || Header[1] != Version || Header[2] != InputSize || Header[3] != HiddenSize || FileOutputScale <= 0)
+	{
+		UE_LOG(LogChessNetwork, Warning, TEXT("Network file %s has unsupported layout"), *Path);
+		return false;
+	}
+
+	TArray<int16> NewFeatureWeights;
+	TArray<int16> NewFeatureBiases;
+	TArray<int8> NewOutputWeights;
+	int32 NewOutputBias = 0;
+
+	NewFeatureWeights.SetNumUninitialized(InputSize * HiddenSize);
+	NewFeatureBiases.SetNumUninitialized(HiddenSize);
+	NewOutputWeights.SetNumUninitialized(2 * HiddenSize);
+
+	if (!ReadValues(Data, Offset, NewFeatureWeights.GetData(), NewFeatureWeights.Num())
+		|| !ReadValues(Data, Offset, NewFeatureBiases.GetData(), NewFeatureBiases.Num())
+		|| !ReadValues(Data, Offset, NewOutputWeights.GetData(), NewOutputWeights.Num())
+		|| !ReadValues(Data, Offset, &NewOutputBias, 1))
+	{
+		UE_LOG(LogChessNetwork, Warning, TEXT("Network file %s is truncated"), *Path);
+		return false;
+	}
+
+	FeatureWeights = MoveTemp(NewFeatureWeights);
+	FeatureBiases = MoveTemp(NewFeatureBiases);
+	OutputWeights = MoveTemp(NewOutputWeights);
+	OutputBias = NewOutputBias;
+	OutputScale = FileOutputScale;
+
+	return true;
+}
+
+bool FChessNetwork::Save(const FString& Path) const
+{
+	TArray<uint8> Data;
+
+	const uint32 Header[4] = { Magic, Version, InputSize, HiddenSize };
+	WriteValues(Data, Header, 4);
+	WriteValues(Data, &OutputScale, 1);
+	WriteValues(Data, FeatureWeights.GetData(), FeatureWeights.Num());
+	WriteValues(Data, FeatureBiases.GetData(), FeatureBiases.Num());
+	WriteValues(Data, OutputWeights.GetData(), OutputWeights.Num());
+	WriteValues(Data, &OutputBias, 1);
+
+	return FFileHelper::SaveArrayToFile(Data, *Path);
+}
+
+void FChessNetwork::InitFromPieceSquareTables()
+{
+	FMemory::Memzero(FeatureWeights.GetData(), FeatureWeights.Num() * sizeof(int16));
+	FMemory::Memzero(FeatureBiases.GetData(), FeatureBiases.Num() * sizeof(int16));
+	FMemory::Memzero(OutputWeights.GetData(), OutputWeights.Num() * sizeof(int8));
+
+	//Own pieces only, seen from white, so tables of white pieces are used for both perspectives
+	for (int32 Code = 1; Code <= 6; ++Code)
+	{
+		for (int32 Square = 0; Square < 64; ++Square)
+		{
+			const int32 Value = (FChessPieceSquareTables::GetMidgame(Code, Square) + FChessPieceSquareTables::GetEndgame(Code, Square)) / 2;
+			int16* Row = &FeatureWeights[GetFeatureIndex(0, Code, Square) * HiddenSize];
+
+			for (int32 Neuron = 0; Neuron < ThermometerNeurons; ++Neuron)
+			{
+				Row[Neuron] = static_cast<int16>(Value);
+			}
+		}
+	}
+
+	//Neuron K passes the part of the sum between K and K + 1 activation ranges, all of them add up to the sum
+	for (int32 Neuron = 0; Neuron < ThermometerNeurons; ++Neuron)
+	{
+		FeatureBiases[Neuron] = static_cast<int16>(ThermometerOffset - ActivationMax * Neuron);
+		OutputWeights[Neuron] = 1;
+		OutputWeights[HiddenSize + Neuron] = -1;
+	}
+
+	//Offsets of both sides cancel out
+	OutputBias = 0;
+	OutputScale = 1;
+}
+
+FString FChessNetwork::GetDefaultPath()
+{
+	return FPaths::ProjectContentDir() / TEXT("Network/Chess.nnue");
+}
+
+const FChessNetwork* FChessNetwork::GetDefault()
+{
+	if (CVarChessUseNetwork.GetValueOnAnyThread() == 0)
+	{
+		return nullptr;
+	}
+
+	//Thread safe static initialization, the file is read once
+	static const TUniquePtr<FChessNetwork> Network = []()
+	{
+		TUniquePtr<FChessNetwork> Loaded = MakeUnique<FChessNetwork>();
+
+		if (!Loaded->Load(GetDefaultPath()))
+		{
+			Loaded.Reset();
+		}
+
+		return Loaded;
+	}();
+
+	return Network.Get();
+}
+
+void FChessNetwork::Refresh(FChessAccumulator& Accumulator, const TStaticArray<FChessPiece, 64>& Board) const
+{
+	for (int32 Perspective = 0; Perspective < 2; ++Perspective)
+	{
+		FMemory::Memcpy(Accumulator.Values[Perspective], FeatureBiases.GetData(), HiddenSize * sizeof(int16));
+	}
+
+	for (int32 Square = 0; Square < 64; ++Square)
+	{
+		if (Board[Square] != GEmptyChessPiece)
+		{
+			AddPiece(Accumulator, Board[Square].GetCode(), Square);
+		}
+	}
+}
+
+void FChessNetwork::AddPiece(FChessAccumulator& Accumulator, int32 Code, int32 Square) const
+{
+	UpdateFeature(Accumulator, Code, Square, 1);
+}
+
+void FChessNetwork::RemovePiece(FChessAccumulator& Accumulator, int32 Code, int32 Square) const
+{
+	UpdateFeature(Accumulator, Code, Square, -1);
+}
+
+void FChessNetwork::MovePiece(FChessAccumulator& Accumulator, int32 Code, int32 From, int32 To) const
+{
+	//Remove and add fused, every row is read and written once
+	for (int32 Perspective = 0; Perspective < 2; ++Perspective)
+	{
+		UpdateRows(Accumulator.Values[Perspective],
+			&FeatureWeights[GetFeatureIndex(Perspective, Code, To) * HiddenSize],
+			&FeatureWeights[GetFeatureIndex(Perspective, Code, From) * HiddenSize]
+		);
+	}
+}
+
+void FChessNetwork::UpdateFeature(FChessAccumulator& Accumulator, int32 Code, int32 Square, int32 Sign) const
+{
+	for (int32 Perspective = 0; Perspective < 2; ++Perspective)
+	{
+		const int16* Row = &FeatureWeights[GetFeatureIndex(Perspective, Code, Square) * HiddenSize];
+
+		UpdateRows(Accumulator.Values[Perspective], Sign > 0 ? Row : nullptr, Sign < 0 ? Row : nullptr);
+	}
+}
+
+int32 FChessNetwork::Evaluate(const FChessAccumulator& Accumulator, EPieceColor Side) const
+{
+	const int32 SideCode = static_cast<int32>(Side);
+	const int16* Us = Accumulator.Values[SideCode];
+	const int16* Them = Accumulator.Values[SideCode ^ 1];
+
+	int32 Sum;
+
+	switch (Simd)
+	{
+#if PLATFORM_CPU_X86_FAMILY
+	case EChessNetworkSimd::AVX2:
+		Sum = DotAVX2(Us, Them, OutputWeights.GetData());
+		break;
+
+	case EChessNetworkSimd::SSE41:
+		Sum = DotSSE41(Us, Them, OutputWeights.GetData());
+		break;
+#endif
+
+	default:
+		Sum = DotScalar(Us, Them, OutputWeights.GetData());
+		break;
+	}
+
+	return (OutputBias + Sum) / OutputScale;
+}
+
+void FChessNetwork::SetSimd(EChessNetworkSimd NewSimd)
+{
+	if (NewSimd == EChessNetworkSimd::AVX2 && !FChessCpuFeatures::HasAVX2())
+	{
+		NewSimd = EChessNetworkSimd::SSE41;
+	}
+
+	if (NewSimd == EChessNetworkSimd::SSE41 && !FChessCpuFeatures::HasSSE41())
+	{
+		NewSimd = EChessNetworkSimd::Scalar;
+	}
+
+	Simd = NewSimd;
+}
+
+EChessNetworkSimd FChessNetwork::GetDefaultSimd()
+{
+	if (FChessCpuFeatures::HasAVX2())
+	{
+		return EChessNetworkSimd::AVX2;
+	}
+
+	return FChessCpuFeatures::HasSSE41() ? EChessNetworkSimd::SSE41 : EChessNetworkSimd::Scalar;
+}
+
+const TCHAR* FChessNetwork::GetSimdName(EChessNetworkSimd InSimd)
+{
+	switch (InSimd)
+	{
+	case EChessNetworkSimd::AVX2:
+		return TEXT("AVX2");
+
+	case EChessNetworkSimd::SSE41:
+		return TEXT("SSE4.1");
+
+	default:
+		return TEXT("Scalar");
+	}
+}
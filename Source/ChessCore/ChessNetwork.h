@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChessDefinitions.h"
+
+//Instruction set used by the network inference
+enum class EChessNetworkSimd : uint8
+{
+	Scalar,
+	SSE41,
+	AVX2
+};
+
+/*
+ * First layer outputs of the network for both perspectives, index 0 is white
+ * Updated incrementally when pieces are added, removed or moved (see FChessPosition::SetNetwork)
+ */
+struct CHESSCORE_API FChessAccumulator
+{
+	static constexpr int32 HiddenSize = 256;
+
+	alignas(32) int16 Values[2][HiddenSize];
+};
+
+/*
+ * Efficiently updatable neural network evaluation (NNUE)
+ *   Input: 768 features per perspective, piece (own or enemy, 6 kinds) on a square seen from that perspective
+ *   Hidden: HiddenSize int16 neurons per perspective, kept in the accumulator
+ *   Output: clipped ReLU of both perspectives, side to move first, as uint8, times int8 weights
+ *
+ * Weights are loaded from a binary file, little endian:
+ *   uint32 Magic, uint32 Version, uint32 InputSize, uint32 HiddenSize, int32 OutputScale,
+ *   int16 FeatureWeights[InputSize][HiddenSize], int16 FeatureBiases[HiddenSize],
+ *   int8 OutputWeights[2 * HiddenSize], int32 OutputBias
+ * Evaluation is (OutputBias + dot) / OutputScale centipawns for the moving side
+ *
+ * Read-only after loading, one network is shared by all positions and threads
+ */
+class CHESSCORE_API FChessNetwork
+{
+public:
+
+	static constexpr int32 InputSize = 768;
+	static constexpr int32 HiddenSize = FChessAccumulator::HiddenSize;
+
+	//Clipped ReLU upper bound, activations fit into uint8 and pair products of maddubs into int16
+	static constexpr int32 ActivationMax = 127;
+
+	static constexpr uint32 Magic = 0x554E4E43; //"CNNU"
+	static constexpr uint32 Version = 1;
+
+	FChessNetwork();
+
+	/**Load weights from the file
+	 * @param Path Weights file
+	 * @return True if the file was read and its layout matches
+	 */
+	bool Load(const FString& Path);
+
+	/**Save weights to the file
+	 * @return True if written
+	 */
+	bool Save(const FString& Path) const;
+
+	/**Bootstrap weights which reproduce the piece-square evaluation (the average of its middlegame and endgame tables)
+	 * Every perspective sums the values of its own pieces on a thermometer of clipped neurons, the output subtracts the sums
+	 * Used until a trained network replaces the file
+	 */
+	void InitFromPieceSquareTables();
+
+	//Weights file in the project content, Content/Network/Chess.nnue
+	static FString GetDefaultPath();
+
+	/**Network loaded from the default path on the first call
+	 * @return Null if disabled by chess.UseNetwork, or the file is missing or invalid
+	 */
+	static const FChessNetwork* GetDefault();
+
+	//Incremental accumulator updates, Code is the piece code, Square is 0..63
+	//
+	void Refresh(FChessAccumulator& Accumulator, const TStaticArray<FChessPiece, 64>& Board) const;
+	void AddPiece(FChessAccumulator& Accumulator, int32 Code, int32 Square) const;
+	void RemovePiece(FChessAccumulator& Accumulator, int32 Code, int32 Square) const;
+	void MovePiece(FChessAccumulator& Accumulator, int32 Code, int32 From, int32 To) const;
+
+	/**Evaluate the accumulated position
+	 * @param Side Moving side
+	 * @return Centipawns for the moving side
+	 */
+	int32 Evaluate(const FChessAccumulator& Accumulator, EPieceColor Side) const;
+
+	//Instruction set of all networks, the fastest supported by default, unsupported ones fall back to the next
+	//
+	static EChessNetworkSimd GetSimd() { return Simd; }
+	static void SetSimd(EChessNetworkSimd NewSimd);
+	static EChessNetworkSimd GetDefaultSimd();
+	static const TCHAR* GetSimdName(EChessNetworkSimd InSimd);
+
+	//Index of the feature seen from given perspective (0 white, 1 black)
+	static FORCEINLINE int32 GetFeatureIndex(int32 Perspective, int32 Code, int32 Square)
+	{
+		//Codes 1..6 are white pieces, black perspective sees colors swapped and the board flipped
+		const int32 PieceIndex = (Code - 1) % 6;
+		const bool bOwn = (Code <= 6) == (Perspective == 0);
+
+		return ((bOwn ? 0 : 6) + PieceIndex) * 64 + (Perspective == 0 ? Square : Square ^ 56);
+	}
+
+private:
+
+	//Add (Sign 1) or subtract (Sign -1) weight rows of the features of both perspectives
+	void UpdateFeature(FChessAccumulator& Accumulator, int32 Code, int32 Square, int32 Sign) const;
+
+	TArray<int16> FeatureWeights;
+	TArray<int16> FeatureBiases;
+	TArray<int8> OutputWeights;
+	int32 OutputBias = 0;
+	int32 OutputScale = 1;
+
+	static EChessNetworkSimd Simd;
+};
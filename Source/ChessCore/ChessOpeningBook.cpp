@@ -0,0 +1,265 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChessOpeningBook.h"
+#include "Async/MappedFileHandle.h"
+#include "ChessMoveList.h"
+#include "ChessPosition.h"
+#include "ChessZobrist.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogChessOpeningBook, Log, All);
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarChessUseBook(
+		TEXT("chess.UseBook"),
+		1,
+		TEXT("Play opening moves from Content/Book/Book.bin.\n")
+		TEXT("Read on the first book lookup."),
+		ECVF_Default
+	);
+
+	//Entries are stored big-endian
+	FORCEINLINE uint64 ReadBigEndian(const uint8* Data, int32 Size)
+	{
+		uint64 Value = 0;
+		for (int32 i = 0; i < Size; ++i)
+		{
+			Value = (Value << 8) | Data[i];
+		}
+		return Value;
+	}
+
+	//Field offsets of an entry
+	//
+	const int32 KeyOffset = 0;
+	const int32 MoveOffset = 8;
+	const int32 WeightOffset = 10;
+}
+
+constexpr int32 FChessOpeningBook::EntrySize;
+
+FChessOpeningBook::FChessOpeningBook() = default;
+
+FChessOpeningBook::~FChessOpeningBook()
+{
+	Close();
+}
+
+bool FChessOpeningBook::Open(const FString& Path, const uint64* InKeys)
+{
+	check(InKeys);
+
+	Close();
+
+	int64 Size = 0;
+
+	MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	if (MappedFile.IsValid() && MappedFile->GetFileSize() > 0)
+	{
+		MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	}
+
+	if (MappedRegion.IsValid())
+	{
+		Entries = MappedRegion->GetMappedPtr();
+		Size = MappedRegion->GetMappedSize();
+	}
+	else
+	{
+		MappedFile.Reset();
+
+		if (!FFileHelper::LoadFileToArray(FileData, *Path))
+		{
+			UE_LOG(LogChessOpeningBook, Warning, TEXT("Can't read opening book %s"), *Path);
+			return false;
+		}
+
+		Entries = FileData.GetData();
+		Size = FileData.Num();
+	}
+
+	if (Size == 0 || Size % EntrySize != 0)
+	{
+		UE_LOG(LogChessOpeningBook, Warning, TEXT("Opening book %s isn't a Polyglot book, size %lld"), *Path, Size);
+		Close();
+		return false;
+	}
+
+	EntryCount = Size / EntrySize;
+	Keys = InKeys;
+
+	UE_LOG(LogChessOpeningBook, Display, TEXT("Opening book %s, %lld entries, %s"), *Path, EntryCount, MappedRegion.IsValid() ? TEXT("mapped") : TEXT("loaded"));
+	return true;
+}
+
+void FChessOpeningBook::Close()
+{
+	//Region is unmapped before its file is closed
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	FileData.Empty();
+
+	Entries = nullptr;
+	EntryCount = 0;
+	Keys = nullptr;
+}
+
+void FChessOpeningBook::GetMoves(const FChessPosition& Position, TArray<FChessBookMove>& OutMoves) const
+{
+	OutMoves.Reset();
+
+	if (!IsOpen())
+	{
+		return;
+	}
+
+	const uint64 Key = Position.GetPolyglotKey(Keys);
+
+	for (int64 Index = LowerBound(Key); Index < EntryCount && GetEntryKey(Index) == Key; ++Index)
+	{
+		const uint8* Entry = Entries + Index * EntrySize;
+
+		FChessBookMove BookMove;
+		BookMove.Move = DecodeMove(Position, static_cast<uint16>(ReadBigEndian(Entry + MoveOffset, 2)));
+		BookMove.Weight = static_cast<int32>(ReadBigEndian(Entry + WeightOffset, 2));
+
+		if (BookMove.Move.IsValid())
+		{
+			OutMoves.Add(BookMove);
+		}
+	}
+}
+
+FChessMove FChessOpeningBook::PickMove(const FChessPosition& Position) const
+{
+	TArray<FChessBookMove> Moves;
+	GetMoves(Position, Moves);
+
+	int32 TotalWeight = 0;
+	for (const FChessBookMove& BookMove : Moves)
+	{
+		TotalWeight += BookMove.Weight;
+	}
+
+	if (TotalWeight == 0)
+	{
+		return FChessMove();
+	}
+
+	int32 Pick = FMath::RandRange(0, TotalWeight - 1);
+
+	for (const FChessBookMove& BookMove : Moves)
+	{
+		if (Pick < BookMove.Weight)
+		{
+			return BookMove.Move;
+		}
+
+		Pick -= BookMove.Weight;
+	}
+
+	checkNoEntry();
+	return FChessMove();
+}
+
+FString FChessOpeningBook::GetDefaultPath()
+{
+	return FPaths::ProjectContentDir() / TEXT("Book/Book.bin");
+}
+
+const FChessOpeningBook* FChessOpeningBook::GetDefault()
+{
+	if (CVarChessUseBook.GetValueOnAnyThread() == 0)
+	{
+		return nullptr;
+	}
+
+	//Thread safe static initialization, the file is mapped once
+	static const TUniquePtr<FChessOpeningBook> Book = []()
+	{
+		TUniquePtr<FChessOpeningBook> Opened = MakeUnique<FChessOpeningBook>();
+
+		if (!Opened->Open(GetDefaultPath(), FChessZobrist::GetPolyglotKeys()))
+		{
+			Opened.Reset();
+		}
+
+		return Opened;
+	}();
+
+	return Book.Get();
+}
+
+FChessMove FChessOpeningBook::DecodeMove(const FChessPosition& Position, uint16 BookMove)
+{
+	//Squares are rank * 8 + file, the same as ours
+	const int32 To = BookMove & 0x3F;
+	const int32 From = (BookMove >> 6) & 0x3F;
+	const int32 Promotion = (BookMove >> 12) & 0x7;
+
+	FChessMoveList Moves;
+	Position.GenerateMoves(Moves);
+
+	for (int32 i = 0; i < Moves.Num(); ++i)
+	{
+		const FChessMove& Move = Moves[i];
+
+		if (Move.GetFromSquare() != From)
+		{
+			continue;
+		}
+
+		if (Move.IsCastlingMove())
+		{
+			//King goes to the G or C file, the book names the rook on the H or A file
+			const int32 RookSquare = Move.GetToSquare() % 8 == 6 ? Move.GetToSquare() + 1 : Move.GetToSquare() - 2;
+
+			if (RookSquare == To)
+			{
+				return Move;
+			}
+		}
+		else if (Move.GetToSquare() == To)
+		{
+			const int32 MovePromotion = Move.IsPromotion() ? (Move.GetFlags() & 0x3) + 1 : 0;
+
+			if (MovePromotion == Promotion)
+			{
+				return Move;
+			}
+		}
+	}
+
+	return FChessMove();
+}
+
+int64 FChessOpeningBook::LowerBound(uint64 Key) const
+{
+	int64 Low = 0;
+	int64 High = EntryCount;
+
+	while (Low < High)
+	{
+		const int64 Middle = Low + (High - Low) / 2;
+
+		if (GetEntryKey(Middle) < Key)
+		{
+			Low = Middle + 1;
+		}
+		else
+		{
+			High = Middle;
+		}
+	}
+
+	return Low;
+}
+
+uint64 FChessOpeningBook::GetEntryKey(int64 Index) const
+{
+	return ReadBigEndian(Entries + Index * EntrySize + KeyOffset, 8);
+}
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChessMove.h"
+
+class FChessPosition;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+//Move of the opening book
+struct CHESSCORE_API FChessBookMove
+{
+	FChessMove Move;
+
+	//Relative frequency, moves with zero weight are never picked
+	int32 Weight = 0;
+};
+
+/*
+ * Opening book in the Polyglot .bin format: 16 byte big-endian entries (key, move, weight, learn) sorted by key
+ * Keys are Polyglot hashes (FChessPosition::GetPolyglotKey), not the position hash keys
+ *
+ * The file is memory-mapped read-only, so all games of the process share one copy in the page cache,
+ * a lookup is a binary search over the mapped entries and allocates nothing
+ * Platforms without mapped files read the file into memory instead
+ */
+class CHESSCORE_API FChessOpeningBook
+{
+public:
+
+	//Size of one entry in the file
+	static constexpr int32 EntrySize = 16;
+
+	FChessOpeningBook();
+	~FChessOpeningBook();
+
+	FChessOpeningBook(const FChessOpeningBook&) = delete;
+	FChessOpeningBook& operator=(const FChessOpeningBook&) = delete;
+
+	/**Map the book file, the previous one is closed
+	 * @param Path Polyglot .bin file
+	 * @param InKeys FChessZobrist::PolyglotKeyCount keys, must outlive the book
+	 * @return True if the file is mapped and holds whole entries
+	 */
+	bool Open(const FString& Path, const uint64* InKeys);
+
+	void Close();
+
+	bool IsOpen() const { return Entries != nullptr; }
+
+	int64 GetEntryCount() const { return EntryCount; }
+
+	/**Legal book moves of the position
+	 * @param Position Position to look up
+	 * @param OutMoves Moves in the file order, usually the heaviest first, previous moves are removed
+	 */
+	void GetMoves(const FChessPosition& Position, TArray<FChessBookMove>& OutMoves) const;
+
+	/**Book move picked at random, a move is picked as often as its share of the total weight
+	 * @return Invalid move if the position isn't in the book
+	 */
+	FChessMove PickMove(const FChessPosition& Position) const;
+
+	//Book in the project content, Content/Book/Book.bin
+	static FString GetDefaultPath();
+
+	/**Book mapped from the default path on the first call, shared by all games
+	 * @return Null if disabled by chess.UseBook, or the book is missing
+	 */
+	static const FChessOpeningBook* GetDefault();
+
+private:
+
+	/**Legal move of the position matching the book move
+	 * Promotions are stored as 1..4 for knight..queen, castling as the king capturing its own rook
+	 * @return Invalid move if the book move isn't legal in the position (hash collision)
+	 */
+	static FChessMove DecodeMove(const FChessPosition& Position, uint16 BookMove);
+
+	//Index of the first entry with the key or above it
+	int64 LowerBound(uint64 Key) const;
+
+	uint64 GetEntryKey(int64 Index) const;
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	//File contents when it can't be mapped
+	TArray<uint8> FileData;
+
+	const uint8* Entries = nullptr;
+	int64 EntryCount = 0;
+
+	const uint64* Keys = nullptr;
+};
@@ -0,0 +1,280 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChessParallelSearch.h"
+#include "ChessTranspositionTable.h"
+#include "HAL/Event.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarChessSearchThreads(
+		TEXT("chess.SearchThreads"),
+		1,
+		TEXT("Threads of each game search, helpers are borrowed from the shared pool only while cores are idle.\n")
+		TEXT("Read when a search is made."),
+		ECVF_Default
+	);
+
+	//Stack of the helper threads, the search recursion needs more than the default
+	constexpr uint32 HelperStackSize = 1024 * 1024;
+}
+
+//Thread running one helper search per wake up
+class FChessParallelSearch::FHelperThread : public FRunnable
+{
+public:
+
+	explicit FHelperThread(int32 ThreadIndex) :
+		StartEvent(FPlatformProcess::GetSynchEventFromPool(false)),
+		DoneEvent(FPlatformProcess::GetSynchEventFromPool(true))
+	{
+		DoneEvent->Trigger();
+		Thread = FRunnableThread::Create(this, *FString::Printf(TEXT("ChessSearchHelper%d"), ThreadIndex), HelperStackSize);
+	}
+
+	~FHelperThread()
+	{
+		//Kill calls Stop, which wakes the thread up to exit
+		Thread->Kill(true);
+		delete Thread;
+
+		FPlatformProcess::ReturnSynchEventToPool(StartEvent);
+		FPlatformProcess::ReturnSynchEventToPool(DoneEvent);
+	}
+
+	//Called on the master thread after the search Setup, so Stop can't come before it
+	void Start(FChessSearch& InSearch)
+	{
+		Search = &InSearch;
+
+		DoneEvent->Reset();
+		StartEvent->Trigger();
+	}
+
+	//Stop the search and wait until the thread goes back to sleep
+	uint64 Finish()
+	{
+		Search->Stop();
+		DoneEvent->Wait();
+
+		Search = nullptr;
+		return Nodes;
+	}
+
+	uint32 Run() override
+	{
+		while (true)
+		{
+			StartEvent->Wait();
+
+			if (bExit)
+			{
+				break;
+			}
+
+			Nodes = Search->Run().Nodes;
+			DoneEvent->Trigger();
+		}
+
+		return 0;
+	}
+
+	//Only idle threads are killed, so there is no search to stop
+	void Stop() override
+	{
+		bExit = true;
+		StartEvent->Trigger();
+	}
+
+private:
+
+	//Search of the borrowing FChessParallelSearch, null while idle
+	FChessSearch* Search = nullptr;
+
+	FEvent* StartEvent;
+	FEvent* DoneEvent;
+	FRunnableThread* Thread = nullptr;
+
+	FThreadSafeBool bExit;
+
+	//Nodes visited by the last search
+	uint64 Nodes = 0;
+};
+
+/*
+ * Helper threads of all searches, made when first needed and kept until exit
+ * Busy threads (masters and borrowed helpers) are counted, so helpers are lent only while cores are idle
+ */
+class FChessParallelSearch::FHelperPool
+{
+public:
+
+	static FHelperPool& Get()
+	{
+		//Thread safe static initialization, idle threads are joined before exit, not by static destruction
+		static FHelperPool* const Pool = []()
+		{
+			FHelperPool* NewPool = new FHelperPool();
+			FCoreDelegates::OnPreExit.AddLambda([NewPool]()
+			{
+				NewPool->Shutdown();
+			});
+
+			return NewPool;
+		}();
+
+		return *Pool;
+	}
+
+	/**Count a starting search and lend it helpers
+	 * @param Wanted Most helpers the search can use
+	 * @param OutThreads Borrowed threads, fewer than wanted when the other searches keep the cores busy
+	 */
+	void Acquire(int32 Wanted, TArray<FHelperThread*>& OutThreads)
+	{
+		FScopeLock ScopeLock(&Lock);
+
+		//Master thread is busy whether it gets helpers or not
+		++BusyThreads;
+
+		const int32 Count = bShutdown ? 0 : FMath::Clamp(GetMaxThreadCount() - BusyThreads, 0, Wanted);
+
+		for (int32 i = 0; i < Count; ++i)
+		{
+			//Busy threads are bounded, so at most GetMaxThreadCount - 1 threads are ever made
+			OutThreads.Add(Idle.Num() > 0 ? Idle.Pop(false) : new FHelperThread(++CreatedThreads));
+		}
+
+		BusyThreads += Count;
+	}
+
+	//Take the helpers back when the search ends
+	void Release(TArray<FHelperThread*>& Threads)
+	{
+		FScopeLock ScopeLock(&Lock);
+
+		BusyThreads -= Threads.Num() + 1;
+
+		for (FHelperThread* Thread : Threads)
+		{
+			if (bShutdown)
+			{
+				delete Thread;
+			}
+			else
+			{
+				Idle.Add(Thread);
+			}
+		}
+
+		Threads.Reset();
+	}
+
+private:
+
+	//Join idle threads, helpers still lent are joined when given back
+	void Shutdown()
+	{
+		FScopeLock ScopeLock(&Lock);
+
+		bShutdown = true;
+
+		for (FHelperThread* Thread : Idle)
+		{
+			delete Thread;
+		}
+
+		Idle.Reset();
+	}
+
+	FCriticalSection Lock;
+
+	TArray<FHelperThread*> Idle;
+
+	int32 BusyThreads = 0;
+	int32 CreatedThreads = 0;
+	bool bShutdown = false;
+};
+
+FChessParallelSearch::FChessParallelSearch(FChessTranspositionTable& InTable, int32 ThreadCount) :
+	Table(InTable),
+	Master(MakeUnique<FChessSearch>(InTable, 0))
+{
+	//Only searches are made here, threads are borrowed by each Setup
+	const int32 HelperCount = FMath::Min(ThreadCount, GetMaxThreadCount()) - 1;
+
+	for (int32 i = 1; i <= HelperCount; ++i)
+	{
+		Helpers.Emplace(MakeUnique<FChessSearch>(InTable, i));
+	}
+}
+
+FChessParallelSearch::~FChessParallelSearch()
+{
+	checkf(Threads.Num() == 0, TEXT("Search was set up without running it"));
+}
+
+FChessSearchResult FChessParallelSearch::Search(const FChessPosition& RootPosition, const FChessSearchLimits& Limits)
+{
+	Table.NewSearch();
+
+	Setup(RootPosition, Limits);
+	return Run();
+}
+
+void FChessParallelSearch::Setup(const FChessPosition& RootPosition, const FChessSearchLimits& Limits)
+{
+	Master->Setup(RootPosition, Limits);
+
+	FHelperPool::Get().Acquire(Helpers.Num(), Threads);
+
+	for (int32 i = 0; i < Threads.Num(); ++i)
+	{
+		//Helpers search until the master stops them
+		Helpers[i]->Setup(RootPosition, FChessSearchLimits());
+		Threads[i]->Start(*Helpers[i]);
+	}
+}
+
+FChessSearchResult FChessParallelSearch::Run()
+{
+	FChessSearchResult Result = Master->Run();
+
+	for (FHelperThread* Thread : Threads)
+	{
+		Result.Nodes += Thread->Finish();
+	}
+
+	FHelperPool::Get().Release(Threads);
+
+	return Result;
+}
+
+void FChessParallelSearch::Stop()
+{
+	Master->Stop();
+}
+
+void FChessParallelSearch::SetOptions(const FChessSearchOptions& Options)
+{
+	Master->SetOptions(Options);
+
+	for (auto&& Helper : Helpers)
+	{
+		Helper->SetOptions(Options);
+	}
+}
+
+int32 FChessParallelSearch::GetDefaultThreadCount()
+{
+	return FMath::Clamp(CVarChessSearchThreads.GetValueOnAnyThread(), 1, GetMaxThreadCount());
+}
+
+int32 FChessParallelSearch::GetMaxThreadCount()
+{
+	return FPlatformProcess::SupportsMultithreading() ? FMath::Max(FPlatformMisc::NumberOfCores(), 1) : 1;
+}
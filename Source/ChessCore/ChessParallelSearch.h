@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChessSearch.h"
+
+class FChessTranspositionTable;
+
+/*
+ * Lazy SMP search: the master searches on the calling thread, helpers search the same position
+ * on their own threads with their own position copy and tables, sharing only the transposition table
+ * Helpers are stopped when the master finishes, the master result is reported
+ *
+ * Helper threads belong to one pool shared by all searches of the process, made on the first search and kept sleeping
+ * between searches. A search borrows only idle helpers while fewer searching threads than cores are busy,
+ * so many searches at once don't run more threads than the machine has cores, each one still has its master thread
+ */
+class CHESSCORE_API FChessParallelSearch
+{
+public:
+
+	/**Make search
+	 * @param InTable Transposition table shared by all threads
+	 * @param ThreadCount Most threads including the calling one, fewer are used when the helper pool is busy
+	 */
+	FChessParallelSearch(FChessTranspositionTable& InTable, int32 ThreadCount);
+	~FChessParallelSearch();
+
+	FChessParallelSearch(const FChessParallelSearch&) = delete;
+	FChessParallelSearch& operator=(const FChessParallelSearch&) = delete;
+
+	/**Search best move of the position, blocks until the master search ends
+	 * Starts a new generation of the transposition table
+	 * @param RootPosition Position to search
+	 * @param Limits Limits of the master search, node limit counts master nodes only
+	 * @return Master result, Nodes is the sum over all threads
+	 */
+	FChessSearchResult Search(const FChessPosition& RootPosition, const FChessSearchLimits& Limits);
+
+	//Search split in two steps like FChessSearch, for searches running on a worker thread
+	//Setup copies the position and wakes the helpers up, Run searches on the calling thread and must always follow
+	//Neither starts a new generation of the transposition table
+	//
+	void Setup(const FChessPosition& RootPosition, const FChessSearchLimits& Limits);
+	FChessSearchResult Run();
+
+	//Abort the running search from another thread
+	void Stop();
+
+	//Set pruning options of all threads, must not be called during the search
+	void SetOptions(const FChessSearchOptions& Options);
+
+	int32 GetThreadCount() const { return Helpers.Num() + 1; }
+
+	//Thread count of game searches, chess.SearchThreads (1 by default) up to GetMaxThreadCount
+	static int32 GetDefaultThreadCount();
+
+	//Most threads a search can have, the physical cores, one where threads aren't supported
+	static int32 GetMaxThreadCount();
+
+private:
+
+	class FHelperThread;
+	class FHelperPool;
+
+	FChessTranspositionTable& Table;
+
+	//Search of the calling thread
+	TUniquePtr<FChessSearch> Master;
+
+	//Searches of the helpers, run by the threads borrowed for one search
+	TArray<TUniquePtr<FChessSearch>> Helpers;
+
+	//Borrowed by Setup and given back by Run
+	TArray<FHelperThread*> Threads;
+};
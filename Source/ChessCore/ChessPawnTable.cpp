@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChessPawnTable.h"
+#include "ChessEvaluation.h"
+#include "ChessPosition.h"
+
+FChessPawnTable::FChessPawnTable(int32 SizeKB)
+{
+	const uint64 Count = FMath::Max<uint64>(uint64(SizeKB) * 1024 / sizeof(FChessPawnEntry), 1);
+
+	//Largest power of two, so the index is a mask of the key
+	uint64 PowerOfTwo = 1;
+	while (PowerOfTwo * 2 <= Count)
+	{
+		PowerOfTwo *= 2;
+	}
+
+	Entries.SetNum(static_cast<int32>(PowerOfTwo));
+	Mask = PowerOfTwo - 1;
+}
+
+const FChessPawnEntry& FChessPawnTable::Probe(const FChessPosition& Position)
+{
+	const uint64 Key = Position.GetPawnHashKey();
+	FChessPawnEntry& Entry = Entries[static_cast<int32>(Key & Mask)];
+
+	++Probes;
+
+	if (Entry.Key == Key)
+	{
+		++Hits;
+		return Entry;
+	}
+
+	Entry.Key = Key;
+	FChessEvaluation::EvaluatePawns(Position, Entry.Midgame, Entry.Endgame);
+
+	return Entry;
+}
+
+void FChessPawnTable::Clear()
+{
+	for (FChessPawnEntry& Entry : Entries)
+	{
+		Entry = FChessPawnEntry();
+	}
+
+	ResetStats();
+}
+
+void FChessPawnTable::ResetStats()
+{
+	Probes = 0;
+	Hits = 0;
+}
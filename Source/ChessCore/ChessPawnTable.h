@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FChessPosition;
+
+//Cached pawn structure scores of one pawn placement, white minus black
+struct CHESSCORE_API FChessPawnEntry
+{
+	uint64 Key = 0;
+	int32 Midgame = 0;
+	int32 Endgame = 0;
+};
+
+/*
+ * Pawn structure cache keyed by the pawn hash key of the position
+ * Pawns move rarely compared to other pieces, so most evaluations find their structure here
+ * Not thread safe, every search thread owns one
+ */
+class CHESSCORE_API FChessPawnTable
+{
+public:
+
+	/**Make table
+	 * @param SizeKB Size in kilobytes, rounded down to a power of two count of entries
+	 */
+	explicit FChessPawnTable(int32 SizeKB = 256);
+
+	/**Get pawn structure of the position, evaluated and stored on a miss
+	 * @param Position Position to get pawn structure of
+	 * @return Entry valid until the next probe
+	 */
+	const FChessPawnEntry& Probe(const FChessPosition& Position);
+
+	//Remove all entries and reset counters
+	void Clear();
+
+	//Reset hit counters only
+	void ResetStats();
+
+	uint64 GetProbes() const { return Probes; }
+	uint64 GetHits() const { return Hits; }
+
+	//Share of probes found in the table, 0..1
+	double GetHitRate() const { return Probes > 0 ? double(Hits) / Probes : 0.0; }
+
+private:
+
+	//Empty entries have zero key and scores, exactly what a position without pawns has
+	TArray<FChessPawnEntry> Entries;
+	uint64 Mask = 0;
+
+	uint64 Probes = 0;
+	uint64 Hits = 0;
+};
@@ -0,0 +1,219 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChessPerft.h"
+#include "ChessPosition.h"
+
+FChessPerftCache::FChessPerftCache(int32 SizeMB)
+{
+	const uint64 Bytes = static_cast<uint64>(FMath::Max(SizeMB, 1)) * 1024 * 1024;
+
+	uint64 EntryCount = 1;
+	while (EntryCount * 2 * sizeof(FEntry) <= Bytes)
+	{
+		EntryCount *= 2;
+	}
+
+	Entries.SetNum(static_cast<int32>(EntryCount));
+	EntryMask = EntryCount - 1;
+}
+
+bool FChessPerftCache::Probe(uint64 Key, int32 Depth, uint64& OutNodes) const
+{
+	const FEntry& Entry = Entries[static_cast<int32>(Key & EntryMask)];
+
+	if (Entry.Key == Key && Entry.Depth == Depth)
+	{
+		OutNodes = Entry.Nodes;
+		return true;
+	}
+
+	return false;
+}
+
+void FChessPerftCache::Store(uint64 Key, int32 Depth, uint64 Nodes)
+{
+	//Always replace, recent subtrees are the most likely to transpose
+	Entries[static_cast<int32>(Key & EntryMask)] = { Key, Nodes, Depth };
+}
+
+uint64 FChessPerft::Perft(FChessPosition& Position, int32 Depth, FChessPerftCache* Cache)
+{
+	if (Depth <= 0)
+	{
+		return 1;
+	}
+
+	//Each ply keeps its own moves on the stack
+	FChessMoveList Moves;
+	Position.GenerateMoves(Moves);
+
+	//Generated moves are legal, so the last ply is just counted
+	if (Depth == 1)
+	{
+		return Moves.Num();
+	}
+
+	uint64 Nodes = 0;
+
+	if (Cache && Cache->Probe(Position.GetPosHashKey(), Depth, Nodes))
+	{
+		return Nodes;
+	}
+
+	for (auto&& Move : Moves)
+	{
+		Position.MakeMove(Move);
+		Nodes += Perft(Position, Depth - 1, Cache);
+		Position.TakeMove();
+	}
+
+	if (Cache)
+	{
+		Cache->Store(Position.GetPosHashKey(), Depth, Nodes);
+	}
+
+	return Nodes;
+}
+
+FChessPerftResult FChessPerft::Run(FChessPosition& Position, int32 Depth, bool bDivide, FChessPerftCache* Cache)
+{
+	FChessPerftResult Result;
+	const double StartTime = FPlatformTime::Seconds();
+
+	if (bDivide && Depth > 0)
+	{
+		FChessMoveList Moves;
+		Position.GenerateMoves(Moves);
+
+		for (auto&& Move : Moves)
+		{
+			Position.MakeMove(Move);
+			const uint64 Nodes = Perft(Position, Depth - 1, Cache);
+			Position.TakeMove();
+
+			Result.Divide.Emplace(MakeTuple(Move, Nodes));
+			Result.Nodes += Nodes;
+		}
+	}
+	else
+	{
+		Result.Nodes = Perft(Position, Depth, Cache);
+	}
+
+	Result.Seconds = FPlatformTime::Seconds() - StartTime;
+
+	//Leave position with moves of the root
+	Position.GenerateAllMoves();
+
+	return Result;
+}
+
+const TArray<FChessPerftReference>& FChessPerft::GetReferencePositions()
+{
+	//Counts from www.chessprogramming.org/Perft_Results
+	//and the edge case collection by Martin Sedlak
+	static const TArray<FChessPerftReference> References = {
+		{
+			TEXT("Start position"),
+			TEXT("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"),
+			{ 20, 400, 8902, 197281, 4865609, 119060324 }
+		},
+		{
+			TEXT("Kiwipete"),
+			TEXT("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"),
+			{ 48, 2039, 97862, 4085603, 193690690 }
+		},
+		{
+			TEXT("Rook endgame, en passant pins"),
+			TEXT("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"),
+			{ 14, 191, 2812, 43238, 674624, 11030083 }
+		},
+		{
+			TEXT("Promotions and castling"),
+			TEXT("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"),
+			{ 6, 264, 9467, 422333, 15833292 }
+		},
+		{
+			TEXT("Underpromotion with check"),
+			TEXT("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"),
+			{ 44, 1486, 62379, 2103487, 89941194 }
+		},
+		{
+			TEXT("Symmetric middlegame"),
+			TEXT("r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10"),
+			{ 46, 2079, 89890, 3894594, 164075551 }
+		},
+		{
+			TEXT("Illegal en passant, pinned on rank"),
+			TEXT("3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1"),
+			{ 18, 92, 1670, 10138, 185429, 1134888 }
+		},
+		{
+			TEXT("Illegal en passant, pinned on diagonal"),
+			TEXT("8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1"),
+			{ 13, 102, 1266, 10276, 135655, 1015133 }
+		},
+		{
+			TEXT("En passant capture gives check"),
+			TEXT("8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1"),
+			{ 15, 126, 1928, 13931, 206379, 1440467 }
+		},
+		{
+			TEXT("Short castling gives check"),
+			TEXT("5k2/8/8/8/8/8/8/4K2R w K - 0 1"),
+			{ 15, 66, 1198, 6399, 120330, 661072 }
+		},
+		{
+			TEXT("Long castling gives check"),
+			TEXT("3k4/8/8/8/8/8/8/R3K3 w Q - 0 1"),
+			{ 16, 71, 1286, 7418, 141077, 803711 }
+		},
+		{
+			TEXT("Castling rights lost by capture"),
+			TEXT("r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1"),
+			{ 26, 1141, 27826, 1274206 }
+		},
+		{
+			TEXT("Castling prevented"),
+			TEXT("r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1"),
+			{ 44, 1494, 50509, 1720476 }
+		},
+		{
+			TEXT("Promote out of check"),
+			TEXT("2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1"),
+			{ 11, 133, 1442, 19174, 266199, 3821001 }
+		},
+		{
+			TEXT("Discovered check"),
+			TEXT("8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1"),
+			{ 29, 165, 5160, 31961, 1004658 }
+		},
+		{
+			TEXT("Promote to give check"),
+			TEXT("4k3/1P6/8/8/8/8/K7/8 w - - 0 1"),
+			{ 9, 40, 472, 2661, 38983, 217342 }
+		},
+		{
+			TEXT("Underpromote to give check"),
+			TEXT("8/P1k5/K7/8/8/8/8/8 w - - 0 1"),
+			{ 6, 27, 273, 1329, 18135, 92683 }
+		},
+		{
+			TEXT("Self stalemate"),
+			TEXT("K1k5/8/P7/8/8/8/8/8 w - - 0 1"),
+			{ 2, 6, 13, 63, 382, 2217 }
+		},
+		{
+			TEXT("Stalemate and checkmate"),
+			TEXT("8/k1P5/8/1K6/8/8/8/8 w - - 0 1"),
+			{ 10, 25, 268, 926, 10857, 43261, 567584 }
+		},
+		{
+			TEXT("Stalemate and checkmate 2"),
+			TEXT("8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1"),
+			{ 37, 183, 6559, 23527 }
+		}
+	};
+
+	return References;
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChessMove.h"
+
+class FChessPosition;
+
+//Known node counts of a test position, used to validate move generation
+struct CHESSCORE_API FChessPerftReference
+{
+	//Short description of what the position tests
+	const TCHAR* Name;
+
+	//Position
+	const TCHAR* FEN;
+
+	//Node count for each depth, starting from depth 1
+	TArray<uint64> Nodes;
+};
+
+//Result of a single perft run
+struct CHESSCORE_API FChessPerftResult
+{
+	//Total count of leaf nodes
+	uint64 Nodes = 0;
+
+	//Wall time of the run
+	double Seconds = 0.0;
+
+	//Leaf nodes below each legal root move, filled only for divide runs
+	TArray<TPair<FChessMove, uint64>> Divide;
+
+	//Nodes per second
+	double GetNodesPerSecond() const
+	{
+		return Seconds > 0.0 ? Nodes / Seconds : 0.0;
+	}
+};
+
+/*
+ * Leaf node counts of already counted subtrees, keyed by position hash key and depth
+ * Transpositions are counted once, node counts don't fit FChessTranspositionTable entries, so perft has its own table
+ */
+class CHESSCORE_API FChessPerftCache
+{
+public:
+
+	//Size in megabytes, rounded down to a power of two count of entries
+	explicit FChessPerftCache(int32 SizeMB);
+
+	bool Probe(uint64 Key, int32 Depth, uint64& OutNodes) const;
+	void Store(uint64 Key, int32 Depth, uint64 Nodes);
+
+private:
+
+	struct FEntry
+	{
+		uint64 Key = 0;
+		uint64 Nodes = 0;
+		int32 Depth = 0;
+	};
+
+	TArray<FEntry> Entries;
+	uint64 EntryMask = 0;
+};
+
+/*
+ * Performance test: counts leaf nodes of the legal move tree
+ * Exercises GenerateAllMoves, MakeMove and TakeMove, see www.chessprogramming.org/Perft
+ */
+class CHESSCORE_API FChessPerft
+{
+public:
+
+	//Count leaf nodes at given depth, subtrees found in the cache aren't walked again
+	static uint64 Perft(FChessPosition& Position, int32 Depth, FChessPerftCache* Cache = nullptr);
+
+	/**Run timed perft
+	 * @param Position Position to test, restored on return
+	 * @param Depth Depth of the tree
+	 * @param bDivide Collect node counts for each root move
+	 * @param Cache Optional subtree counts cache
+	 */
+	static FChessPerftResult Run(FChessPosition& Position, int32 Depth, bool bDivide = false, FChessPerftCache* Cache = nullptr);
+
+	//Standard test positions with known node counts
+	static const TArray<FChessPerftReference>& GetReferencePositions();
+};
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChessPieceSquareTables.h"
+
+namespace
+{
+	//Piece values by offset (pawn..king), kings are never captured
+	//
+	constexpr int16 MidgameValues[7] = { 0, 100, 350, 350, 550, 1000, 0 };
+	constexpr int16 EndgameValues[7] = { 0, 120, 330, 360, 580, 1000, 0 };
+
+	//Tables below are written as seen by white: first row is rank 8, last one is rank 1
+
+	constexpr int16 PawnMidgame[64] = {
+		 0,  0,   0,   0,   0,   0,  0,  0,
+		50, 50,  50,  50,  50,  50, 50, 50,
+		10, 10,  20,  30,  30,  20, 10, 10,
+		 5,  5,  10,  25,  25,  10,  5,  5,
+		 0,  0,   0,  20,  20,   0,  0,  0,
+		 5, -5, -10,   0,   0, -10, -5,  5,
+		 5, 10,  10, -20, -20,  10, 10,  5,
+		 0,  0,   0,   0,   0,   0,  0,  0
+	};
+
+	//Passers decide endgames, the closer to promotion the better
+	constexpr int16 PawnEndgame[64] = {
+		 0,  0,  0,  0,  0,  0,  0,  0,
+		80, 80, 80, 80, 80, 80, 80, 80,
+		50, 50, 50, 50, 50, 50, 50, 50,
+		30, 30, 30, 30, 30, 30, 30, 30,
+		15, 15, 15, 15, 15, 15, 15, 15,
+		 5,  5,  5,  5,  5,  5,  5,  5,
+		 0,  0,  0,  0,  0,  0,  0,  0,
+		 0,  0,  0,  0,  0,  0,  0,  0
+	};
+
+	constexpr int16 Knight[64] = {
+		-50, -40, -30, -30, -30, -30, -40, -50,
+		-40, -20,   0,   0,   0,   0, -20, -40,
+		-30,   0,  10,  15,  15,  10,   0, -30,
+		-30,   5,  15,  20,  20,  15,   5, -30,
+		-30,   0,  15,  20,  20,  15,   0, -30,
+		-30,   5,  10,  15,  15,  10,   5, -30,
+		-40, -20,   0,   5,   5,   0, -20, -40,
+		-50, -40, -30, -30, -30, -30, -40, -50
+	};
+
+	constexpr int16 Bishop[64] = {
+		-20, -10, -10, -10, -10, -10, -10, -20,
+		-10,   0,   0,   0,   0,   0,   0, -10,
+		-10,   0,   5,  10,  10,   5,   0, -10,
+		-10,   5,   5,  10,  10,   5,   5, -10,
+		-10,   0,  10,  10,  10,  10,   0, -10,
+		-10,  10,  10,  10,  10,  10,  10, -10,
+		-10,   5,   0,   0,   0,   0,   5, -10,
+		-20, -10, -10, -10, -10, -10, -10, -20
+	};
+
+	constexpr int16 RookMidgame[64] = {
+		 0,  0,  0,  0,  0,  0,  0,  0,
+		 5, 10, 10, 10, 10, 10, 10,  5,
+		-5,  0,  0,  0,  0,  0,  0, -5,
+		-5,  0,  0,  0,  0,  0,  0, -5,
+		-5,  0,  0,  0,  0,  0,  0, -5,
+		-5,  0,  0,  0,  0,  0,  0, -5,
+		-5,  0,  0,  0,  0,  0,  0, -5,
+		 0,  0,  0,  5,  5,  0,  0,  0
+	};
+
+	//Castled rook placement doesn't matter anymore, the seventh rank still does
+	constexpr int16 RookEndgame[64] = {
+		 0,  0,  0,  0,  0,  0,  0,  0,
+		10, 10, 10, 10, 10, 10, 10, 10,
+		 0,  0,  0,  0,  0,  0,  0,  0,
+		 0,  0,  0,  0,  0,  0,  0,  0,
+		 0,  0,  0,  0,  0,  0,  0,  0,
+		 0,  0,  0,  0,  0,  0,  0,  0,
+		 0,  0,  0,  0,  0,  0,  0,  0,
+		 0,  0,  0,  0,  0,  0,  0,  0
+	};
+
+	constexpr int16 Queen[64] = {
+		-20, -10, -10, -5, -5, -10, -10, -20,
+		-10,   0,   0,  0,  0,   0,   0, -10,
+		-10,   0,   5,  5,  5,   5,   0, -10,
+		 -5,   0,   5,  5,  5,   5,   0,  -5,
+		  0,   0,   5,  5,  5,   5,   0,  -5,
+		-10,   5,   5,  5,  5,   5,   0, -10,
+		-10,   0,   5,  0,  0,   0,   0, -10,
+		-20, -10, -10, -5, -5, -10, -10, -20
+	};
+
+	//King hides behind pawns while queens are on the board
+	constexpr int16 KingMidgame[64] = {
+		-30, -40, -40, -50, -50, -40, -40, -30,
+		-30, -40, -40, -50, -50, -40, -40, -30,
+		-30, -40, -40, -50, -50, -40, -40, -30,
+		-30, -40, -40, -50, -50, -40, -40, -30,
+		-20, -30, -30, -40, -40, -30, -30, -20,
+		-10, -20, -20, -20, -20, -20, -20, -10,
+		 20,  20,   0,   0,   0,   0,  20,  20,
+		 20,  30,  10,   0,   0,  10,  30,  20
+	};
+
+	//And goes to the center when they are gone
+	constexpr int16 KingEndgame[64] = {
+		-50, -40, -30, -20, -20, -30, -40, -50,
+		-30, -20, -10,   0,   0, -10, -20, -30,
+		-30, -10,  20,  30,  30,  20, -10, -30,
+		-30, -10,  30,  40,  40,  30, -10, -30,
+		-30, -10,  30,  40,  40,  30, -10, -30,
+		-30, -10,  20,  30,  30,  20, -10, -30,
+		-30, -30,   0,   0,   0,   0, -30, -30,
+		-50, -30, -30, -30, -30, -30, -30, -50
+	};
+
+	//By piece offset, knights, bishops and queens use one table for both phases
+	//
+	constexpr const int16* MidgameTables[7] = { nullptr, PawnMidgame, Knight, Bishop, RookMidgame, Queen, KingMidgame };
+	constexpr const int16* EndgameTables[7] = { nullptr, PawnEndgame, Knight, Bishop, RookEndgame, Queen, KingEndgame };
+
+	constexpr FChessPieceSquareTables::FTables MakeTables()
+	{
+		FChessPieceSquareTables::FTables Tables;
+
+		for (int32 Offset = 1; Offset <= 6; ++Offset)
+		{
+			for (int32 Square = 0; Square < 64; ++Square)
+			{
+				//Rows are written from rank 8, flipping the rank turns A1 = 0 square into table index for white,
+				//black sees the board flipped, so its index is the square itself
+				const int32 WhiteIndex = Square ^ 56;
+				const int32 BlackIndex = Square;
+
+				Tables.Midgame[Offset][Square] = MidgameValues[Offset] + MidgameTables[Offset][WhiteIndex];
+				Tables.Endgame[Offset][Square] = EndgameValues[Offset] + EndgameTables[Offset][WhiteIndex];
+
+				Tables.Midgame[Offset + 6][Square] = MidgameValues[Offset] + MidgameTables[Offset][BlackIndex];
+				Tables.Endgame[Offset + 6][Square] = EndgameValues[Offset] + EndgameTables[Offset][BlackIndex];
+			}
+		}
+
+		return Tables;
+	}
+}
+
+constexpr int32 FChessPieceSquareTables::MinorPhase;
+constexpr int32 FChessPieceSquareTables::MajorPhase;
+constexpr int32 FChessPieceSquareTables::MaxPhase;
+
+//Constant initialized, lives in read-only data and needs no startup code
+constexpr FChessPieceSquareTables::FTables FChessPieceSquareTables::Tables = MakeTables();
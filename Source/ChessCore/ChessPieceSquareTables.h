@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+ * Piece-square tables of the tapered evaluation, piece value included
+ * Every piece has a middlegame and an endgame score, the position blends them by the game phase
+ * Tables are built at compile time for both colors, black ones are mirrored white ones
+ */
+class CHESSCORE_API FChessPieceSquareTables
+{
+public:
+
+	//Phase weights of the pieces, phase goes from MaxPhase (all pieces on board) to 0 (pawns and kings only)
+	//MajorPieces doesn't tell rooks from queens, so they weigh the same
+	//
+	static constexpr int32 MinorPhase = 1;
+	static constexpr int32 MajorPhase = 3;
+	static constexpr int32 MaxPhase = 2 * (4 * MinorPhase + 3 * MajorPhase);
+
+	//Middlegame score of the piece code standing on the 0..63 square
+	static FORCEINLINE int32 GetMidgame(int32 Code, int32 Square)
+	{
+		return Tables.Midgame[Code][Square];
+	}
+
+	//Endgame score of the piece code standing on the 0..63 square
+	static FORCEINLINE int32 GetEndgame(int32 Code, int32 Square)
+	{
+		return Tables.Endgame[Code][Square];
+	}
+
+	/**Blend middlegame and endgame scores
+	 * @param Phase Game phase, clamped to MaxPhase (promotions may exceed it)
+	 */
+	static FORCEINLINE int32 Taper(int32 Midgame, int32 Endgame, int32 Phase)
+	{
+		Phase = FMath::Min(Phase, MaxPhase);
+		return (Midgame * Phase + Endgame * (MaxPhase - Phase)) / MaxPhase;
+	}
+
+	struct FTables
+	{
+		//By piece code, code 0 (no piece) is all zeros
+		int16 Midgame[13][64] = {};
+		int16 Endgame[13][64] = {};
+	};
+
+private:
+
+	static const FTables Tables;
+};
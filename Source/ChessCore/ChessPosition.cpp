@@ -0,0 +1,1770 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ChessPosition.h"
+#include "ChessBitboards.h"
+#include "ChessPieceSquareTables.h"
+#include "ChessZobrist.h"
+#include "ChessTranspositionTable.h"
+
+namespace
+{
+	//Castle permissions left after a piece moves from or to the square
+	//Only king and rook initial squares clear anything
+	const int32 CastlePermissionMask[64] = {
+		13, 15, 15, 15, 12, 15, 15, 14,
+		15, 15, 15, 15, 15, 15, 15, 15,
+		15, 15, 15, 15, 15, 15, 15, 15,
+		15, 15, 15, 15, 15, 15, 15, 15,
+		15, 15, 15, 15, 15, 15, 15, 15,
+		15, 15, 15, 15, 15, 15, 15, 15,
+		15, 15, 15, 15, 15, 15, 15, 15,
+		 7, 15, 15, 15,  3, 15, 15, 11
+	};
+
+	//Squares used by castling
+	enum ECastlingSquare : int32
+	{
+		SquareA1 = 0, SquareB1, SquareC1, SquareD1, SquareE1, SquareF1, SquareG1, SquareH1,
+		SquareA8 = 56, SquareB8, SquareC8, SquareD8, SquareE8, SquareF8, SquareG8, SquareH8
+	};
+
+	//Piece codes are laid out as pawn, knight, bishop, rook, queen, king for white and then for black
+	//So the piece of given color code is ColorCode * 6 + Offset
+	const int32 PawnOffset = 1;
+	const int32 KnightOffset = 2;
+	const int32 BishopOffset = 3;
+	const int32 RookOffset = 4;
+	const int32 QueenOffset = 5;
+	const int32 KingOffset = 6;
+
+	//Most valuable victim first, among equal victims the least valuable attacker first
+	//Promotions add the value of the new piece, so queen promotions go before captures of minor pieces
+	FORCEINLINE int32 GetMvvLvaScore(const FChessPiece& Victim, const FChessPiece& Attacker)
+	{
+		return Victim.GetCost() * 10 - Attacker.GetCost() / 100;
+	}
+}
+
+FChessPosition::FChessPosition()
+{
+	ResetBoard();
+}
+
+void FChessPosition::SetSide(EPieceColor NewSide)
+{
+	if (NewSide == Side)
+	{
+		return;
+	}
+
+	//En passant capture belongs to the side which was moving
+	if (EnPassantTile.IsSet())
+	{
+		HashEnPassant();
+		EnPassantTile.Reset();
+	}
+
+	Side = NewSide;
+	HashSide();
+
+#if CHESS_VERIFY_HASH
+	VerifyHashKeys();
+#endif
+
+	GenerateAllMoves();
+}
+
+EPieceColor FChessPosition::GetSide() const
+{
+	return Side;
+}
+
+bool FChessPosition::InitBoard(const FString& FEN)
+{
+	//Board, side, castling and en passant fields are required, the move counters are optional (EPD)
+	TArray<FString> Fields;
+	FEN.TrimStartAndEnd().ParseIntoArrayWS(Fields, nullptr, true);
+
+	if (Fields.Num() < 4 || Fields.Num() > 6)
+	{
+		return false;
+	}
+
+	//Everything is parsed and checked before the board changes, so a bad FEN leaves the position as it was
+	//
+	//Firstly parse pieces, ranks from eight to one, files from A to H
+	TArray<FString> Rows;
+	Fields[0].ParseIntoArray(Rows, TEXT("/"), false);
+
+	if (Rows.Num() != 8)
+	{
+		return false;
+	}
+
+	TStaticArray<FChessPiece, 64> Pieces{ GEmptyChessPiece };
+
+	for (int32 RowIndex = 0; RowIndex < Rows.Num(); ++RowIndex)
+	{
+		const int32 Rank = 7 - RowIndex;
+		int32 File = 0;
+
+		for (auto&& Char : Rows[RowIndex])
+		{
+			if (Char >= '1' && Char <= '8')
+			{
+				//Count of empty tiles
+				File += Char - '0';
+			}
+			else
+			{
+				const FChessPiece& Piece = FChessPiece::GetPieceFromChar(Char);
+
+				if (Piece == GEmptyChessPiece || File >= 8)
+				{
+					return false;
+				}
+
+				Pieces[Rank * 8 + File++] = Piece;
+			}
+
+			if (File > 8)
+			{
+				return false;
+			}
+		}
+
+		if (File != 8)
+		{
+			return false;
+		}
+	}
+
+	int32 WhiteKings = 0;
+	int32 BlackKings = 0;
+
+	for (int32 Square = 0; Square < 64; ++Square)
+	{
+		WhiteKings += Pieces[Square] == GWhiteKing;
+		BlackKings += Pieces[Square] == GBlackKing;
+
+		//Pawns never stand on the first and the last rank
+		if ((Square < 8 || Square >= 56) && (Pieces[Square] == GWhitePawn || Pieces[Square] == GBlackPawn))
+		{
+			return false;
+		}
+	}
+
+	//Move generation needs both kings
+	if (WhiteKings != 1 || BlackKings != 1)
+	{
+		return false;
+	}
+
+	//Secondly parse state
+	EPieceColor NewSide;
+
+	if (Fields[1] == TEXT("w"))
+	{
+		NewSide = EPieceColor::White;
+	}
+	else if (Fields[1] == TEXT("b"))
+	{
+		NewSide = EPieceColor::Black;
+	}
+	else
+	{
+		return false;
+	}
+
+	int32 NewCastlePermission = 0;
+
+	if (Fields[2] != TEXT("-"))
+	{
+		for (auto&& Char : Fields[2])
+		{
+			switch (Char)
+			{
+			case 'K': NewCastlePermission |= static_cast<int32>(ECastlingType::WhiteKing);
+				break;
+			case 'Q': NewCastlePermission |= static_cast<int32>(ECastlingType::WhiteQueen);
+				break;
+			case 'k': NewCastlePermission |= static_cast<int32>(ECastlingType::BlackKing);
+				break;
+			case 'q': NewCastlePermission |= static_cast<int32>(ECastlingType::BlackQueen);
+				break;
+
+			default:
+				return false;
+			}
+		}
+	}
+
+	//Rights without the king and the rook on their squares can't be used, castling would move a missing rook
+	if (Pieces[SquareE1] != GWhiteKing || Pieces[SquareH1] != GWhiteRook)
+	{
+		NewCastlePermission &= ~static_cast<int32>(ECastlingType::WhiteKing);
+	}
+
+	if (Pieces[SquareE1] != GWhiteKing || Pieces[SquareA1] != GWhiteRook)
+	{
+		NewCastlePermission &= ~static_cast<int32>(ECastlingType::WhiteQueen);
+	}
+
+	if (Pieces[SquareE8] != GBlackKing || Pieces[SquareH8] != GBlackRook)
+	{
+		NewCastlePermission &= ~static_cast<int32>(ECastlingType::BlackKing);
+	}
+
+	if (Pieces[SquareE8] != GBlackKing || Pieces[SquareA8] != GBlackRook)
+	{
+		NewCastlePermission &= ~static_cast<int32>(ECastlingType::BlackQueen);
+	}
+
+	TOptional<int32> NewEnPassantTile;
+
+	if (Fields[3] != TEXT("-"))
+	{
+		//Tile behind the pawn which has just moved two tiles, so the sixth rank if white moves and the third if black
+		const int32 EnPassantRank = NewSide == EPieceColor::White ? 5 : 2;
+
+		if (Fields[3].Len() != 2 || Fields[3][0] < 'a' || Fields[3][0] > 'h' || Fields[3][1] - '1' != EnPassantRank)
+		{
+			return false;
+		}
+
+		const int32 Square = EnPassantRank * 8 + (Fields[3][0] - 'a');
+		const int32 PawnSquare = NewSide == EPieceColor::White ? Square - 8 : Square + 8;
+
+		if (Pieces[Square] != GEmptyChessPiece || Pieces[PawnSquare] != (NewSide == EPieceColor::White ? GBlackPawn : GWhitePawn))
+		{
+			return false;
+		}
+
+		NewEnPassantTile.Emplace(Square);
+	}
+
+	//Halfmove clock, the fullmove number is checked but not kept
+	int32 NewFiftyMoveCounter = 0;
+
+	for (int32 i = 4; i < Fields.Num(); ++i)
+	{
+		for (auto&& Char : Fields[i])
+		{
+			if (Char < '0' || Char > '9')
+			{
+				return false;
+			}
+		}
+
+		if (i == 4)
+		{
+			NewFiftyMoveCounter = FCString::Atoi(*Fields[i]);
+		}
+	}
+
+	ResetBoard();
+
+	for (int32 Square = 0; Square < 64; ++Square)
+	{
+		Board[Square] = Pieces[Square];
+	}
+
+	Side = NewSide;
+	CastlePermission = NewCastlePermission;
+	EnPassantTile = NewEnPassantTile;
+	FiftyMoveCounter = NewFiftyMoveCounter;
+
+	UpdateListsMaterial();
+	RefreshAccumulator();
+	PosHashKey = GeneratePositionHashKey();
+	PawnHashKey = GeneratePawnHashKey();
+	MaterialHashKey = GenerateMaterialHashKey();
+
+	GenerateAllMoves();
+
+	return true;
+}
+
+const FChessPiece& FChessPosition::GetPieceAtTile(EBoardFile File, EBoardRank Rank) const
+{
+	return Board[GetTileIndexAt_64(File, Rank)];
+}
+
+int32 FChessPosition::GetPieceCount(const FChessPiece& Piece) const
+{
+	return FChessBitboards::PopCount(PieceBitboards[Piece.GetCode()]);
+}
+
+bool FChessPosition::IsTileAttacked(EBoardFile File, EBoardRank Rank, EPieceColor MovingSide) const
+{
+	return IsSquareAttacked(GetTileIndexAt_64(File, Rank), static_cast<int32>(MovingSide), Occupancy[2]);
+}
+
+bool FChessPosition::IsSquareAttacked(int32 Square, int32 AttackerColorCode, uint64 Occupied) const
+{
+	const int32 Base = AttackerColorCode * 6;
+
+	//Our pawn on the square would attack the same tiles where their pawns attack it from
+	if (FChessBitboards::GetPawnAttacks(AttackerColorCode ^ 1, Square) & PieceBitboards[Base + PawnOffset])
+	{
+		return true;
+	}
+
+	if (FChessBitboards::GetKnightAttacks(Square) & PieceBitboards[Base + KnightOffset])
+	{
+		return true;
+	}
+
+	if (FChessBitboards::GetKingAttacks(Square) & PieceBitboards[Base + KingOffset])
+	{
+		return true;
+	}
+
+	const uint64 Queens = PieceBitboards[Base + QueenOffset];
+
+	if (FChessBitboards::GetBishopAttacks(Square, Occupied) & (PieceBitboards[Base + BishopOffset] | Queens))
+	{
+		return true;
+	}
+
+	if (FChessBitboards::GetRookAttacks(Square, Occupied) & (PieceBitboards[Base + RookOffset] | Queens))
+	{
+		return true;
+	}
+
+	//Tile is not attacked
+	return false;
+}
+
+uint64 FChessPosition::GetAttackers(int32 Square, int32 AttackerColorCode, uint64 Occupied) const
+{
+	const int32 Base = AttackerColorCode * 6;
+	const uint64 Queens = PieceBitboards[Base + QueenOffset];
+
+	return
+		(FChessBitboards::GetPawnAttacks(AttackerColorCode ^ 1, Square) & PieceBitboards[Base + PawnOffset]) |
+		(FChessBitboards::GetKnightAttacks(Square) & PieceBitboards[Base + KnightOffset]) |
+		(FChessBitboards::GetKingAttacks(Square) & PieceBitboards[Base + KingOffset]) |
+		(FChessBitboards::GetBishopAttacks(Square, Occupied) & (PieceBitboards[Base + BishopOffset] | Queens)) |
+		(FChessBitboards::GetRookAttacks(Square, Occupied) & (PieceBitboards[Base + RookOffset] | Queens));
+}
+
+uint64 FChessPosition::GetPinnedPieces(int32 KingSquare, int32 ColorCode) const
+{
+	const int32 TheirBase = (ColorCode ^ 1) * 6;
+	const uint64 Queens = PieceBitboards[TheirBase + QueenOffset];
+
+	//Their sliders which would attack the king if only their own pieces were on the board
+	uint64 Snipers =
+		(FChessBitboards::GetBishopAttacks(KingSquare, Occupancy[ColorCode ^ 1]) & (PieceBitboards[TheirBase + BishopOffset] | Queens)) |
+		(FChessBitboards::GetRookAttacks(KingSquare, Occupancy[ColorCode ^ 1]) & (PieceBitboards[TheirBase + RookOffset] | Queens));
+
+	uint64 Pinned = 0;
+
+	while (Snipers)
+	{
+		const uint64 Blockers = FChessBitboards::GetBetween(KingSquare, FChessBitboards::PopLsb(Snipers)) & Occupancy[2];
+
+		//Single piece in between is pinned, if it is ours
+		if (Blockers && !(Blockers & (Blockers - 1)))
+		{
+			Pinned |= Blockers & Occupancy[ColorCode];
+		}
+	}
+
+	return Pinned;
+}
+
+int32 FChessPosition::GetKingSquare(int32 ColorCode) const
+{
+	const uint64 King = PieceBitboards[ColorCode * 6 + KingOffset];
+	return King ? FChessBitboards::GetLsb(King) : INDEX_NONE;
+}
+
+void FChessPosition::AddQuietMove(FChessMoveList& OutMoves, const FChessMove& Move) const
+{
+	if (Move.IsPromotion())
+	{
+		OutMoves.Add(Move, GetMvvLvaScore(Move.GetPromotedPiece(Side), Board[Move.GetFromSquare()]));
+	}
+	else
+	{
+		OutMoves.Add(Move);
+	}
+}
+
+void FChessPosition::AddCaptureMove(FChessMoveList& OutMoves, const FChessMove& Move) const
+{
+	int32 Score = GetMvvLvaScore(Board[Move.GetToSquare()], Board[Move.GetFromSquare()]);
+
+	if (Move.IsPromotion())
+	{
+		Score += Move.GetPromotedPiece(Side).GetCost() * 10;
+	}
+
+	OutMoves.Add(Move, Score);
+}
+
+void FChessPosition::AddEnPassantMove(FChessMoveList& OutMoves, const FChessMove& Move) const
+{
+	//Pawn takes pawn
+	OutMoves.Add(Move, GetMvvLvaScore(GWhitePawn, GWhitePawn));
+}
+
+void FChessPosition::AddPawnMoves(FChessMoveList& OutMoves, uint64 Targets, int32 Offset, int32 Flags) const
+{
+	while (Targets)
+	{
+		const int32 To = FChessBitboards::PopLsb(Targets);
+		const int32 From = To - Offset;
+
+		const bool bCapture = Board[To] != GEmptyChessPiece;
+		const int32 MoveFlags = Flags | (bCapture ? FChessMove::FLAG_Capture : 0);
+
+		if (FChessBitboards::SquareBit(To) & (FChessBitboards::Rank1 | FChessBitboards::Rank8))
+		{
+			for (int32 Promotion : { FChessMove::PROMOTION_Queen, FChessMove::PROMOTION_Rook, FChessMove::PROMOTION_Bishop, FChessMove::PROMOTION_Knight })
+			{
+				const FChessMove Move{ From, To, MoveFlags | FChessMove::FLAG_Promotion | Promotion };
+
+				if (bCapture)
+				{
+					AddCaptureMove(OutMoves, Move);
+				}
+				else
+				{
+					AddQuietMove(OutMoves, Move);
+				}
+			}
+		}
+		else
+		{
+			const FChessMove Move{ From, To, MoveFlags };
+
+			if (bCapture)
+			{
+				AddCaptureMove(OutMoves, Move);
+			}
+			else
+			{
+				AddQuietMove(OutMoves, Move);
+			}
+		}
+	}
+}
+
+void FChessPosition::AddPieceMoves(FChessMoveList& OutMoves, int32 From, uint64 Targets) const
+{
+	while (Targets)
+	{
+		const int32 To = FChessBitboards::PopLsb(Targets);
+		if (Board[To] == GEmptyChessPiece)
+		{
+			AddQuietMove(OutMoves, {From, To, FChessMove::FLAG_Quiet});
+		}
+		else
+		{
+			AddCaptureMove(OutMoves, {From, To, FChessMove::FLAG_Capture});
+		}
+	}
+}
+
+void FChessPosition::GenerateAllMoves()
+{
+	GenerateMoves(Moves);
+
+	//Consumers of the list can skip or defer captures which lose material
+	for (int32 i = 0; i < Moves.Num(); ++i)
+	{
+		if (Moves[i].IsCapture())
+		{
+			const int32 Gain = SEE(Moves[i]);
+
+			if (Gain < 0)
+			{
+				Moves.SetScore(i, FChessMoveList::LosingCaptureScore + Gain);
+			}
+		}
+	}
+}
+
+void FChessPosition::GenerateMoves(FChessMoveList& OutMoves, EChessMoveGen Type) const
+{
+	GenerateMoves(OutMoves, Type, ~uint64(0));
+}
+
+void FChessPosition::GenerateMoves(FChessMoveList& OutMoves, EChessMoveGen Type, uint64 FromMask) const
+{
+	OutMoves.Reset();
+
+	if (Side != EPieceColor::NoColor && Side != EPieceColor::Both)
+	{
+		const int32 SideCode = static_cast<int32>(Side);
+		const int32 KingSquare = GetKingSquare(SideCode);
+
+		//Pieces capture on enemy tiles and move quietly to empty ones
+		//Pawns are special, promotions are generated with captures
+		const uint64 TypeMask =
+			Type == EChessMoveGen::Captures ? Occupancy[SideCode ^ 1] :
+			Type == EChessMoveGen::Quiets ? ~Occupancy[2] :
+			~uint64(0);
+
+		//Without a king (board setup) every pseudo-legal move is legal
+		uint64 Pinned = 0;
+		uint64 TargetMask = ~uint64(0);
+
+		if (KingSquare != INDEX_NONE)
+		{
+			const uint64 Checkers = GetAttackers(KingSquare, SideCode ^ 1, Occupancy[2]);
+			Pinned = GetPinnedPieces(KingSquare, SideCode);
+
+			const bool bKingMoves = (FromMask & FChessBitboards::SquareBit(KingSquare)) != 0;
+
+			if (bKingMoves)
+			{
+				GenerateKingMoves(OutMoves, KingSquare, TypeMask);
+			}
+
+			//Only the king can escape double check
+			if (Checkers & (Checkers - 1))
+			{
+				return;
+			}
+
+			if (Checkers)
+			{
+				//Capture the checker or block its line
+				TargetMask = FChessBitboards::GetBetween(KingSquare, FChessBitboards::GetLsb(Checkers)) | Checkers;
+			}
+			else if (Type != EChessMoveGen::Captures && bKingMoves)
+			{
+				GenerateCastling(OutMoves);
+			}
+		}
+
+		//Free pawns move as a set, pinned ones one by one along their pin line
+		const uint64 Pawns = PieceBitboards[SideCode * 6 + PawnOffset] & FromMask;
+		GeneratePawnMoves(OutMoves, Pawns & ~Pinned, TargetMask, Type);
+
+		uint64 PinnedPawns = Pawns & Pinned;
+		while (PinnedPawns)
+		{
+			const int32 From = FChessBitboards::PopLsb(PinnedPawns);
+			GeneratePawnMoves(OutMoves, FChessBitboards::SquareBit(From), TargetMask & FChessBitboards::GetLine(KingSquare, From), Type);
+		}
+
+		if (Type != EChessMoveGen::Quiets)
+		{
+			GenerateEnPassantMoves(OutMoves, KingSquare, FromMask);
+		}
+
+		GeneratePieceMoves(OutMoves, TargetMask & TypeMask, KingSquare, Pinned, FromMask);
+	}
+}
+
+void FChessPosition::ClearPiece(const FTileCoord& Coord)
+{
+	check(Coord.IsValid());
+
+	ClearPiece(GetTileAs64(Coord.ToInt()));
+}
+
+void FChessPosition::ClearPiece(int32 Square)
+{
+	const FChessPiece Piece = Board[Square];
+	check(Piece != GEmptyChessPiece);
+
+	const int32 ColorCode = Piece.GetColorCode();
+	const uint64 Bit = FChessBitboards::SquareBit(Square);
+
+	HashPiece(Piece, Square);
+
+	Board[Square] = GEmptyChessPiece;
+	Material[ColorCode] -= Piece.GetCost();
+
+	MidgameScore[ColorCode] -= FChessPieceSquareTables::GetMidgame(Piece.GetCode(), Square);
+	EndgameScore[ColorCode] -= FChessPieceSquareTables::GetEndgame(Piece.GetCode(), Square);
+
+	if (Network && !bTakingMove)
+	{
+		Network->RemovePiece(Accumulators.Last(), Piece.GetCode(), Square);
+	}
+
+	PieceBitboards[Piece.GetCode()] &= ~Bit;
+	Occupancy[ColorCode] &= ~Bit;
+	Occupancy[2] &= ~Bit;
+
+	HashMaterial(Piece, FChessBitboards::PopCount(PieceBitboards[Piece.GetCode()]));
+
+	if (Piece.IsBigPiece())
+	{
+		--BigPieces[ColorCode];
+
+		if (Piece.IsMajorPiece())
+		{
+			--MajorPieces[ColorCode];
+		}
+
+		if (Piece.IsMinorPiece())
+		{
+			--MinorPieces[ColorCode];
+		}
+	}
+}
+
+void FChessPosition::AddPiece(const FTileCoord& Coord, const FChessPiece& Piece)
+{
+	check(Coord.IsValid());
+
+	AddPiece(GetTileAs64(Coord.ToInt()), Piece);
+}
+
+void FChessPosition::AddPiece(int32 Square, const FChessPiece& Piece)
+{
+	check(Piece != GEmptyChessPiece);
+	check(Board[Square] == GEmptyChessPiece);
+
+	const int32 ColorCode = Piece.GetColorCode();
+	const uint64 Bit = FChessBitboards::SquareBit(Square);
+
+	HashPiece(Piece, Square);
+
+	Board[Square] = Piece;
+
+	HashMaterial(Piece, FChessBitboards::PopCount(PieceBitboards[Piece.GetCode()]));
+
+	PieceBitboards[Piece.GetCode()] |= Bit;
+	Occupancy[ColorCode] |= Bit;
+	Occupancy[2] |= Bit;
+
+	if (Piece.IsBigPiece())
+	{
+		++BigPieces[ColorCode];
+
+		if (Piece.IsMajorPiece())
+		{
+			++MajorPieces[ColorCode];
+		}
+
+		if (Piece.IsMinorPiece())
+		{
+			++MinorPieces[ColorCode];
+		}
+	}
+
+	Material[ColorCode] += Piece.GetCost();
+
+	MidgameScore[ColorCode] += FChessPieceSquareTables::GetMidgame(Piece.GetCode(), Square);
+	EndgameScore[ColorCode] += FChessPieceSquareTables::GetEndgame(Piece.GetCode(), Square);
+
+	if (Network && !bTakingMove)
+	{
+		Network->AddPiece(Accumulators.Last(), Piece.GetCode(), Square);
+	}
+}
+
+void FChessPosition::MovePiece(const FTileCoord& From, const FTileCoord& To)
+{
+	check(From.IsValid());
+	check(To.IsValid());
+
+	MovePiece(GetTileAs64(From.ToInt()), GetTileAs64(To.ToInt()));
+}
+
+void FChessPosition::MovePiece(int32 From, int32 To)
+{
+	const FChessPiece Piece = Board[From];
+
+	//Piece must move!
+	check(Piece != GEmptyChessPiece);
+	check(Board[To] == GEmptyChessPiece);
+
+	HashPiece(Piece, From);
+	Board[From] = GEmptyChessPiece;
+
+	HashPiece(Piece, To);
+	Board[To] = Piece;
+
+	//Combined mask of both tiles flips them at once
+	const uint64 FromToMask = FChessBitboards::SquareBit(From) | FChessBitboards::SquareBit(To);
+
+	PieceBitboards[Piece.GetCode()] ^= FromToMask;
+	Occupancy[Piece.GetColorCode()] ^= FromToMask;
+	Occupancy[2] ^= FromToMask;
+
+	const int32 Code = Piece.GetCode();
+	MidgameScore[Piece.GetColorCode()] += FChessPieceSquareTables::GetMidgame(Code, To) - FChessPieceSquareTables::GetMidgame(Code, From);
+	EndgameScore[Piece.GetColorCode()] += FChessPieceSquareTables::GetEndgame(Code, To) - FChessPieceSquareTables::GetEndgame(Code, From);
+
+	if (Network && !bTakingMove)
+	{
+		Network->MovePiece(Accumulators.Last(), Code, From, To);
+	}
+}
+
+int32 FChessPosition::GetPhase() const
+{
+	return (MinorPieces[0] + MinorPieces[1]) * FChessPieceSquareTables::MinorPhase
+		+ (MajorPieces[0] + MajorPieces[1]) * FChessPieceSquareTables::MajorPhase;
+}
+
+void FChessPosition::TakeMove()
+{
+	const FChessMoveRecord& Record = History.Last();
+	const FChessMove Move = Record.Move;
+
+	const int32 From = Move.GetFromSquare();
+	const int32 To = Move.GetToSquare();
+
+	//Revert back values
+	CastlePermission = Record.CastlePermission;
+	FiftyMoveCounter = Record.FiftyMove;
+
+	bTakingMove = true;
+
+	if (Record.EnPassantTile != INDEX_NONE)
+	{
+		EnPassantTile.Emplace(Record.EnPassantTile);
+	}
+	else
+	{
+		EnPassantTile.Reset();
+	}
+
+	//Revert moving side
+	Side = static_cast<EPieceColor>((int32)Side ^ 1);
+
+	//If was en passant move, revert captured pawn
+	if (Move.IsEnPassantMove())
+	{
+		if (Side == EPieceColor::White)
+		{
+			AddPiece(To - 8, GBlackPawn);
+		}
+		else
+		{
+			AddPiece(To + 8, GWhitePawn);
+		}
+	}
+	else if (Move.IsCastlingMove())
+	{
+		//If was castling move, revert rook position
+		switch (To)
+		{
+		case SquareC1:
+			MovePiece(SquareD1, SquareA1);
+			break;
+
+		case SquareC8:
+			MovePiece(SquareD8, SquareA8);
+			break;
+
+		case SquareG1:
+			MovePiece(SquareF1, SquareH1);
+			break;
+
+		case SquareG8:
+			MovePiece(SquareF8, SquareH8);
+			break;
+
+		default:
+
+			check(false && "Invalid castling move");
+			break;
+		}
+	}
+
+	//Revert moved piece
+	MovePiece(To, From);
+
+	//If piece was captured, return it back to the board
+	if (Record.Captured != GEmptyChessPiece)
+	{
+		AddPiece(To, Record.Captured);
+	}
+
+	//If piece was promoted, remove it and return pawn back
+	if (Move.IsPromotion())
+	{
+		ClearPiece(From);
+		AddPiece(From,
+			Side == EPieceColor::White ? GWhitePawn : GBlackPawn
+		);
+	}
+
+	//Pieces were hashed back by the calls above, side, castling and en passant keys are simply restored
+	PosHashKey = Record.PosHashKey;
+
+	bTakingMove = false;
+
+	if (Network)
+	{
+		Accumulators.RemoveAt(Accumulators.Num() - 1, 1, false);
+	}
+
+	//Delete history record
+	History.Pop();
+
+#if CHESS_VERIFY_HASH
+	VerifyHashKeys();
+#endif
+}
+
+void FChessPosition::MakeMove(const FChessMove& Move)
+{
+	const int32 From = Move.GetFromSquare();
+	const int32 To = Move.GetToSquare();
+
+	const FChessPiece Piece = Board[From];
+	check(Piece != GEmptyChessPiece);
+
+	//Move doesn't know what it takes, read it from the board (en passant pawn is cleared separately)
+	const FChessPiece CapturedPiece = Board[To];
+
+	FChessMoveRecord HistoryRecord {
+		Move,
+		CapturedPiece,
+		static_cast<uint8>(CastlePermission),
+		static_cast<int8>(EnPassantTile.Get(INDEX_NONE)),
+		static_cast<uint16>(FiftyMoveCounter),
+		PosHashKey
+	};
+
+	History.Push(HistoryRecord);
+
+	//Accumulator of the move starts as a copy of the previous one
+	if (Network)
+	{
+		const int32 Index = Accumulators.AddUninitialized(1);
+		FMemory::Memcpy(&Accumulators[Index], &Accumulators[Index - 1], sizeof(FChessAccumulator));
+	}
+
+	if (Move.IsEnPassantMove())
+	{
+		if (Side == EPieceColor::White)
+		{
+			ClearPiece(To - 8);
+		}
+		else
+		{
+			ClearPiece(To + 8);
+		}
+	}
+	else if (Move.IsCastlingMove())
+	{
+		switch (To)
+		{
+		case SquareC1:
+			MovePiece(SquareA1, SquareD1);
+			break;
+
+		case SquareC8:
+			MovePiece(SquareA8, SquareD8);
+			break;
+
+		case SquareG1:
+			MovePiece(SquareH1, SquareF1);
+			break;
+
+		case SquareG8:
+			MovePiece(SquareH8, SquareF8);
+			break;
+
+		default:
+			check(false && "Invalid castling move");
+		}
+	}
+
+	if (EnPassantTile.IsSet())
+	{
+		HashEnPassant();
+	}
+
+	HashCastle();
+
+	CastlePermission &= CastlePermissionMask[From];
+	CastlePermission &= CastlePermissionMask[To];
+	EnPassantTile.Reset();
+
+	HashCastle();
+
+	++FiftyMoveCounter;
+
+	if (CapturedPiece != GEmptyChessPiece)
+	{
+		ClearPiece(To);
+		FiftyMoveCounter = 0;
+	}
+
+	if (Piece.IsA(EChessPieceRole::Pawn))
+	{
+		FiftyMoveCounter = 0;
+		if (Move.IsPawnStartMove())
+		{
+			if (Side == EPieceColor::White)
+			{
+				EnPassantTile.Emplace(From + 8);
+			}
+			else
+			{
+				EnPassantTile.Emplace(From - 8);
+			}
+
+			HashEnPassant();
+		}
+	}
+
+	MovePiece(From, To);
+
+	if (Move.IsPromotion())
+	{
+		ClearPiece(To);
+		AddPiece(To, Move.GetPromotedPiece(Side));
+	}
+
+	int32 SideCode = static_cast<int32>(Side);
+	Side = static_cast<EPieceColor>(SideCode ^ 1);
+
+	//Generator emits only legal moves, so own king can't be left attacked
+	checkSlow(GetKingSquare(SideCode) == INDEX_NONE || !IsSquareAttacked(GetKingSquare(SideCode), SideCode ^ 1, Occupancy[2]));
+
+	HashSide();
+
+	//Search probes the new position right away, start loading its bucket now
+	if (TranspositionTable)
+	{
+		TranspositionTable->Prefetch(PosHashKey);
+	}
+
+#if CHESS_VERIFY_HASH
+	VerifyHashKeys();
+#endif
+}
+
+const FChessMoveList& FChessPosition::GetMoves() const
+{
+	return Moves;
+}
+
+bool FChessPosition::IsLegalMove(const FChessMove& Move) const
+{
+	if (!Move.IsValid() || Side == EPieceColor::NoColor || Side == EPieceColor::Both || Board[Move.GetFromSquare()].GetColor() != Side)
+	{
+		return false;
+	}
+
+	//Castling rights and attacked squares are left to the generator, castling moves are rare
+	if (Move.IsCastlingMove())
+	{
+		//Only the moves of the king
+		FChessMoveList PieceMoves;
+		GenerateMoves(PieceMoves, EChessMoveGen::All, FChessBitboards::SquareBit(Move.GetFromSquare()));
+
+		for (auto&& LegalMove : PieceMoves)
+		{
+			if (LegalMove == Move)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	return IsPseudoLegalMove(Move) && !IsKingAttackedAfter(Move);
+}
+
+bool FChessPosition::IsPseudoLegalMove(const FChessMove& Move) const
+{
+	const int32 SideCode = static_cast<int32>(Side);
+	const int32 From = Move.GetFromSquare();
+	const int32 To = Move.GetToSquare();
+	const int32 Flags = Move.GetFlags();
+	const uint64 ToBit = FChessBitboards::SquareBit(To);
+
+	if (ToBit & Occupancy[SideCode])
+	{
+		return false;
+	}
+
+	//Flags must be the ones the generator gives, moves are compared with all 16 bits
+	const bool bCapture = (ToBit & Occupancy[SideCode ^ 1]) != 0;
+	const int32 Offset = Board[From].GetCode() - SideCode * 6;
+
+	switch (Offset)
+	{
+	case PawnOffset:
+	{
+		const int32 Forward = SideCode == 0 ? 8 : -8;
+		const bool bLastRank = (ToBit & (FChessBitboards::Rank1 | FChessBitboards::Rank8)) != 0;
+		const bool bDiagonal = (FChessBitboards::GetPawnAttacks(SideCode, From) & ToBit) != 0;
+
+		if (Flags == FChessMove::FLAG_EnPassantMove)
+		{
+			return bDiagonal && EnPassantTile.IsSet() && EnPassantTile.GetValue() == To;
+		}
+
+		if (Flags == FChessMove::FLAG_PawnStartMove)
+		{
+			const int32 StartRank = SideCode == 0 ? 1 : 6;
+			return From / 8 == StartRank && To == From + 2 * Forward && !((FChessBitboards::SquareBit(From + Forward) | ToBit) & Occupancy[2]);
+		}
+
+		//Plain moves and promotions, with or without capture, the promoted piece is any of the four
+		const int32 KindFlags = Move.IsPromotion() ? Flags & ~FChessMove::PROMOTION_Queen : Flags;
+		if (KindFlags != ((bLastRank ? FChessMove::FLAG_Promotion : 0) | (bCapture ? FChessMove::FLAG_Capture : 0)))
+		{
+			return false;
+		}
+
+		return bCapture ? bDiagonal : To == From + Forward && !(ToBit & Occupancy[2]);
+	}
+
+	case KnightOffset:
+	case BishopOffset:
+	case RookOffset:
+	case QueenOffset:
+	case KingOffset:
+	{
+		if (Flags != (bCapture ? FChessMove::FLAG_Capture : FChessMove::FLAG_Quiet))
+		{
+			return false;
+		}
+
+		const uint64 Attacks =
+			Offset == KnightOffset ? FChessBitboards::GetKnightAttacks(From) :
+			Offset == BishopOffset ? FChessBitboards::GetBishopAttacks(From, Occupancy[2]) :
+			Offset == RookOffset ? FChessBitboards::GetRookAttacks(From, Occupancy[2]) :
+			Offset == QueenOffset ? FChessBitboards::GetQueenAttacks(From, Occupancy[2]) :
+			FChessBitboards::GetKingAttacks(From);
+
+		return (Attacks & ToBit) != 0;
+	}
+
+	default:
+		return false;
+	}
+}
+
+bool FChessPosition::IsKingAttackedAfter(const FChessMove& Move) const
+{
+	const int32 SideCode = static_cast<int32>(Side);
+	const int32 KingSquare = GetKingSquare(SideCode);
+
+	//Without a king (board setup) every pseudo-legal move is legal
+	if (KingSquare == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const int32 From = Move.GetFromSquare();
+	const int32 To = Move.GetToSquare();
+
+	//En passant removes the pawn behind the target tile, which may uncover a slider on the rank
+	const uint64 Captured = Move.IsEnPassantMove()
+		? FChessBitboards::SquareBit(SideCode == 0 ? To - 8 : To + 8)
+		: FChessBitboards::SquareBit(To);
+
+	const uint64 Occupied = (Occupancy[2] & ~FChessBitboards::SquareBit(From) & ~Captured) | FChessBitboards::SquareBit(To);
+
+	//Attackers on the board before the move, the captured piece can't attack anymore
+	return (GetAttackers(From == KingSquare ? To : KingSquare, SideCode ^ 1, Occupied) & ~Captured) != 0;
+}
+
+int32 FChessPosition::SEE(const FChessMove& Move) const
+{
+	//Castling can't be recaptured, the king lands on a square which isn't attacked
+	if (Move.IsCastlingMove())
+	{
+		return 0;
+	}
+
+	const int32 From = Move.GetFromSquare();
+	const int32 To = Move.GetToSquare();
+	const uint64 BackRanks = FChessBitboards::Rank1 | FChessBitboards::Rank8;
+	const int32 PawnCost = GWhitePawn.GetCost();
+	const int32 QueenCost = GWhiteQueen.GetCost();
+
+	int32 ColorCode = Board[From].GetColorCode();
+	uint64 Occupied = Occupancy[2] ^ FChessBitboards::SquareBit(From);
+
+	//Gain[i] is the balance for the side making the i-th capture, if the exchange stops after it
+	//No more captures than pieces on the board are possible
+	int32 Gain[32];
+	int32 Depth = 0;
+
+	if (Move.IsEnPassantMove())
+	{
+		//Captured pawn stands behind the target square, its removal can open a line to the square
+		Occupied ^= FChessBitboards::SquareBit(ColorCode == 0 ? To - 8 : To + 8);
+		Gain[0] = PawnCost;
+	}
+	else
+	{
+		Gain[0] = Board[To].GetCost();
+	}
+
+	//Cost of the piece standing on the target square, the one captured next
+	int32 OnSquare = Board[From].GetCost();
+
+	if (Move.IsPromotion())
+	{
+		OnSquare = Move.GetPromotedPiece(Board[From].GetColor()).GetCost();
+		Gain[0] += OnSquare - PawnCost;
+	}
+
+	const uint64 DiagonalSliders =
+		PieceBitboards[BishopOffset] | PieceBitboards[QueenOffset] |
+		PieceBitboards[6 + BishopOffset] | PieceBitboards[6 + QueenOffset];
+	const uint64 StraightSliders =
+		PieceBitboards[RookOffset] | PieceBitboards[QueenOffset] |
+		PieceBitboards[6 + RookOffset] | PieceBitboards[6 + QueenOffset];
+
+	uint64 Attackers = (GetAttackers(To, 0, Occupied) | GetAttackers(To, 1, Occupied)) & Occupied;
+
+	while (true)
+	{
+		ColorCode ^= 1;
+
+		const uint64 SideAttackers = Attackers & Occupancy[ColorCode];
+		if (!SideAttackers)
+		{
+			break;
+		}
+
+		//Least valuable attacker captures next
+		int32 Offset = PawnOffset;
+		uint64 AttackerBits = 0;
+
+		for (; Offset <= KingOffset; ++Offset)
+		{
+			AttackerBits = SideAttackers & PieceBitboards[ColorCode * 6 + Offset];
+
+			if (AttackerBits)
+			{
+				break;
+			}
+		}
+
+		//King can't capture a defended piece
+		if (Offset == KingOffset && (Attackers & Occupancy[ColorCode ^ 1]))
+		{
+			break;
+		}
+
+		++Depth;
+		Gain[Depth] = OnSquare - Gain[Depth - 1];
+		OnSquare = FChessPiece::GetPieceFromCode(ColorCode * 6 + Offset).GetCost();
+
+		//Pawn recapturing on the back rank promotes
+		if (Offset == PawnOffset && (FChessBitboards::SquareBit(To) & BackRanks))
+		{
+			Gain[Depth] += QueenCost - PawnCost;
+			OnSquare = QueenCost;
+		}
+
+		Occupied ^= FChessBitboards::SquareBit(FChessBitboards::GetLsb(AttackerBits));
+
+		//Sliders behind the captured piece see the square now
+		if (Offset == PawnOffset || Offset == BishopOffset || Offset == QueenOffset)
+		{
+			Attackers |= FChessBitboards::GetBishopAttacks(To, Occupied) & DiagonalSliders;
+		}
+
+		if (Offset == RookOffset || Offset == QueenOffset)
+		{
+			Attackers |= FChessBitboards::GetRookAttacks(To, Occupied) & StraightSliders;
+		}
+
+		Attackers &= Occupied;
+	}
+
+	//Each side takes the better of stopping and continuing, from the last capture back to the first
+	while (Depth > 0)
+	{
+		Gain[Depth - 1] = -FMath::Max(-Gain[Depth - 1], Gain[Depth]);
+		--Depth;
+	}
+
+	return Gain[0];
+}
+
+void FChessPosition::GeneratePawnMoves(FChessMoveList& OutMoves, uint64 Pawns, uint64 TargetMask, EChessMoveGen Type) const
+{
+	const int32 SideCode = static_cast<int32>(Side);
+	const uint64 Empty = ~Occupancy[2];
+
+	//Pushes to the last rank are promotions and go with captures
+	const uint64 PromotionRank = Side == EPieceColor::White ? FChessBitboards::Rank8 : FChessBitboards::Rank1;
+	const uint64 PushMask =
+		Type == EChessMoveGen::Captures ? PromotionRank :
+		Type == EChessMoveGen::Quiets ? ~PromotionRank :
+		~uint64(0);
+
+	const uint64 Enemies = Type != EChessMoveGen::Quiets ? Occupancy[SideCode ^ 1] & TargetMask : 0;
+	const uint64 DoublePushMask = Type != EChessMoveGen::Captures ? TargetMask : 0;
+
+	//Whole set of pawns is shifted at once, A and H files are masked out so captures don't wrap around the board
+	//Double push must pass an empty tile, so only its destination is limited by TargetMask
+	if (Side == EPieceColor::White)
+	{
+		const uint64 Pushes = (Pawns << 8) & Empty;
+
+		AddPawnMoves(OutMoves, Pushes & TargetMask & PushMask, 8);
+		AddPawnMoves(OutMoves, ((Pushes & FChessBitboards::Rank3) << 8) & Empty & DoublePushMask, 16, FChessMove::FLAG_PawnStartMove);
+		AddPawnMoves(OutMoves, ((Pawns & ~FChessBitboards::FileA) << 7) & Enemies, 7);
+		AddPawnMoves(OutMoves, ((Pawns & ~FChessBitboards::FileH) << 9) & Enemies, 9);
+	}
+	else
+	{
+		const uint64 Pushes = (Pawns >> 8) & Empty;
+
+		AddPawnMoves(OutMoves, Pushes & TargetMask & PushMask, -8);
+		AddPawnMoves(OutMoves, ((Pushes & FChessBitboards::Rank6) >> 8) & Empty & DoublePushMask, -16, FChessMove::FLAG_PawnStartMove);
+		AddPawnMoves(OutMoves, ((Pawns & ~FChessBitboards::FileA) >> 9) & Enemies, -9);
+		AddPawnMoves(OutMoves, ((Pawns & ~FChessBitboards::FileH) >> 7) & Enemies, -7);
+	}
+}
+
+void FChessPosition::GenerateEnPassantMoves(FChessMoveList& OutMoves, int32 KingSquare, uint64 FromMask) const
+{
+	if (!EnPassantTile.IsSet())
+	{
+		return;
+	}
+
+	const int32 SideCode = static_cast<int32>(Side);
+	const int32 To = EnPassantTile.GetValue();
+	const uint64 CapturedBit = FChessBitboards::SquareBit(Side == EPieceColor::White ? To - 8 : To + 8);
+
+	//Our pawns standing where their pawn on the en passant square would attack
+	uint64 Attackers = PieceBitboards[SideCode * 6 + PawnOffset] & FChessBitboards::GetPawnAttacks(SideCode ^ 1, To) & FromMask;
+
+	while (Attackers)
+	{
+		const int32 From = FChessBitboards::PopLsb(Attackers);
+
+		if (KingSquare != INDEX_NONE)
+		{
+			//Two pawns leave the same rank at once, so pins and checks are tested on the resulting occupancy
+			const uint64 Occupied = (Occupancy[2] ^ FChessBitboards::SquareBit(From) ^ CapturedBit) | FChessBitboards::SquareBit(To);
+
+			if (GetAttackers(KingSquare, SideCode ^ 1, Occupied) & ~CapturedBit)
+			{
+				continue;
+			}
+		}
+
+		AddEnPassantMove(OutMoves, {From, To, FChessMove::FLAG_EnPassantMove});
+	}
+}
+
+void FChessPosition::GeneratePieceMoves(FChessMoveList& OutMoves, uint64 TargetMask, int32 KingSquare, uint64 Pinned, uint64 FromMask) const
+{
+	const int32 SideCode = static_cast<int32>(Side);
+	const int32 Base = SideCode * 6;
+
+	//Can't capture own pieces
+	TargetMask &= ~Occupancy[SideCode];
+
+	//Pinned piece can only move along the line between its king and the pinner
+	auto PinLine = [KingSquare, Pinned](int32 From)
+	{
+		return (Pinned & FChessBitboards::SquareBit(From)) ? FChessBitboards::GetLine(KingSquare, From) : ~uint64(0);
+	};
+
+	uint64 Pieces = PieceBitboards[Base + KnightOffset] & FromMask;
+	while (Pieces)
+	{
+		const int32 From = FChessBitboards::PopLsb(Pieces);
+		AddPieceMoves(OutMoves, From, FChessBitboards::GetKnightAttacks(From) & TargetMask & PinLine(From));
+	}
+
+	Pieces = PieceBitboards[Base + BishopOffset] & FromMask;
+	while (Pieces)
+	{
+		const int32 From = FChessBitboards::PopLsb(Pieces);
+		AddPieceMoves(OutMoves, From, FChessBitboards::GetBishopAttacks(From, Occupancy[2]) & TargetMask & PinLine(From));
+	}
+
+	Pieces = PieceBitboards[Base + RookOffset] & FromMask;
+	while (Pieces)
+	{
+		const int32 From = FChessBitboards::PopLsb(Pieces);
+		AddPieceMoves(OutMoves, From, FChessBitboards::GetRookAttacks(From, Occupancy[2]) & TargetMask & PinLine(From));
+	}
+
+	Pieces = PieceBitboards[Base + QueenOffset] & FromMask;
+	while (Pieces)
+	{
+		const int32 From = FChessBitboards::PopLsb(Pieces);
+		AddPieceMoves(OutMoves, From, FChessBitboards::GetQueenAttacks(From, Occupancy[2]) & TargetMask & PinLine(From));
+	}
+}
+
+void FChessPosition::GenerateKingMoves(FChessMoveList& OutMoves, int32 KingSquare, uint64 TargetMask) const
+{
+	const int32 SideCode = static_cast<int32>(Side);
+
+	//King is lifted from the board, otherwise it would shield the tiles behind it from the checking slider
+	const uint64 Occupied = Occupancy[2] ^ FChessBitboards::SquareBit(KingSquare);
+
+	uint64 Targets = FChessBitboards::GetKingAttacks(KingSquare) & ~Occupancy[SideCode] & TargetMask;
+	uint64 SafeTargets = 0;
+
+	while (Targets)
+	{
+		const int32 To = FChessBitboards::PopLsb(Targets);
+
+		if (!IsSquareAttacked(To, SideCode ^ 1, Occupied))
+		{
+			SafeTargets |= FChessBitboards::SquareBit(To);
+		}
+	}
+
+	AddPieceMoves(OutMoves, KingSquare, SafeTargets);
+}
+
+void FChessPosition::GenerateCastling(FChessMoveList& OutMoves) const
+{
+	struct FCastling
+	{
+		ECastlingType Type;
+		int32 KingFrom;
+		int32 KingTo;
+
+		//Tiles between king and rook
+		uint64 EmptyMask;
+
+		//Tile king passes through
+		int32 PassSquare;
+	};
+
+	static const FCastling WhiteCastlings[2] = {
+		{ ECastlingType::WhiteKing, SquareE1, SquareG1, (uint64)0x60, SquareF1 },
+		{ ECastlingType::WhiteQueen, SquareE1, SquareC1, (uint64)0x0E, SquareD1 }
+	};
+
+	static const FCastling BlackCastlings[2] = {
+		{ ECastlingType::BlackKing, SquareE8, SquareG8, (uint64)0x60 << 56, SquareF8 },
+		{ ECastlingType::BlackQueen, SquareE8, SquareC8, (uint64)0x0E << 56, SquareD8 }
+	};
+
+	const int32 TheirCode = static_cast<int32>(Side) ^ 1;
+	const FCastling (&Castlings)[2] = Side == EPieceColor::White ? WhiteCastlings : BlackCastlings;
+
+	//Called only when not in check, so the king's own tile is safe
+	for (auto&& Castling : Castlings)
+	{
+		if (
+			(CastlePermission & static_cast<int32>(Castling.Type)) &&
+			!(Occupancy[2] & Castling.EmptyMask) &&
+			!IsSquareAttacked(Castling.PassSquare, TheirCode, Occupancy[2]) &&
+			!IsSquareAttacked(Castling.KingTo, TheirCode, Occupancy[2])
+		)
+		{
+			AddQuietMove(OutMoves, {Castling.KingFrom, Castling.KingTo, FChessMove::FLAG_CastlingMove});
+		}
+	}
+}
+
+void FChessPosition::HashPiece(const FChessPiece& Piece, int32 Square)
+{
+	PosHashKey ^= FChessZobrist::GetPieceKey(Piece.GetCode(), Square);
+
+	if (Piece.IsA(EChessPieceRole::Pawn))
+	{
+		PawnHashKey ^= FChessZobrist::GetPieceKey(Piece.GetCode(), Square);
+	}
+}
+
+void FChessPosition::HashMaterial(const FChessPiece& Piece, int32 Count)
+{
+	MaterialHashKey ^= FChessZobrist::GetMaterialKey(Piece.GetCode(), Count);
+}
+
+void FChessPosition::HashCastle()
+{
+	PosHashKey ^= FChessZobrist::GetCastleKey(CastlePermission);
+}
+
+void FChessPosition::HashSide()
+{
+	PosHashKey ^= FChessZobrist::GetSideKey();
+}
+
+void FChessPosition::HashEnPassant()
+{
+	PosHashKey ^= FChessZobrist::GetEnPassantKey(EnPassantTile.GetValue());
+}
+
+void FChessPosition::UpdateListsMaterial()
+{
+	for (int32 Square = 0; Square < 64; ++Square)
+	{
+		const FChessPiece& Piece = Board[Square];
+
+		//If tile has a chess piece
+		if (Piece != GEmptyChessPiece)
+		{
+			int32 ColorCode = Piece.GetColorCode();
+
+			//Increment counters by chess piece type
+			if (Piece.IsBigPiece())
+			{
+				++BigPieces[ColorCode];
+			}
+
+			if (Piece.IsMajorPiece())
+			{
+				++MajorPieces[ColorCode];
+			}
+
+			if (Piece.IsMinorPiece())
+			{
+				++MinorPieces[ColorCode];
+			}
+
+			Material[ColorCode] += Piece.GetCost();
+
+			MidgameScore[ColorCode] += FChessPieceSquareTables::GetMidgame(Piece.GetCode(), Square);
+			EndgameScore[ColorCode] += FChessPieceSquareTables::GetEndgame(Piece.GetCode(), Square);
+
+			const uint64 Bit = FChessBitboards::SquareBit(Square);
+
+			PieceBitboards[Piece.GetCode()] |= Bit;
+			Occupancy[ColorCode] |= Bit;
+			Occupancy[2] |= Bit;
+		}
+	}
+}
+
+int32 FChessPosition::GetTileAs64(int32 Tile120) const
+{
+	const int32 File = Tile120 % 10 - 1;
+	const int32 Rank = Tile120 / 10 - 2;
+
+	return FMath::IsWithinInclusive(File, 0, 7) && FMath::IsWithinInclusive(Rank, 0, 7) ? Rank * 8 + File : 65;
+}
+
+int32 FChessPosition::GetTileAs120(int32 Tile64) const
+{
+	return FMath::IsWithinInclusive(Tile64, 0, 63) ? 21 + (Tile64 / 8) * 10 + Tile64 % 8 : 120;
+}
+
+bool FChessPosition::IsCheck() const
+{
+	if (Side != EPieceColor::White && Side != EPieceColor::Black)
+	{
+		return false;
+	}
+
+	const int32 SideCode = (int32)Side;
+	const int32 KingSquare = GetKingSquare(SideCode);
+
+	return KingSquare != INDEX_NONE && IsSquareAttacked(KingSquare, SideCode ^ 1, Occupancy[2]);
+}
+
+bool FChessPosition::IsCheckMate() const
+{
+	//No legal moves left and the king is attacked
+	return Moves.Num() == 0 && IsCheck();
+}
+
+void FChessPosition::SetNetwork(const FChessNetwork* InNetwork)
+{
+	Network = InNetwork;
+	RefreshAccumulator();
+}
+
+void FChessPosition::RefreshAccumulator()
+{
+	Accumulators.Reset();
+
+	if (Network)
+	{
+		Accumulators.AddUninitialized(1);
+		Network->Refresh(Accumulators.Last(), Board);
+	}
+}
+
+void FChessPosition::MakeNullMove()
+{
+	checkSlow(!IsCheck());
+
+	FChessMoveRecord HistoryRecord {
+		FChessMove(),
+		GEmptyChessPiece,
+		static_cast<uint8>(CastlePermission),
+		static_cast<int8>(EnPassantTile.Get(INDEX_NONE)),
+		static_cast<uint16>(FiftyMoveCounter),
+		PosHashKey
+	};
+
+	History.Push(HistoryRecord);
+
+	if (EnPassantTile.IsSet())
+	{
+		HashEnPassant();
+		EnPassantTile.Reset();
+	}
+
+	FiftyMoveCounter = 0;
+
+	Side = static_cast<EPieceColor>((int32)Side ^ 1);
+	HashSide();
+
+	if (TranspositionTable)
+	{
+		TranspositionTable->Prefetch(PosHashKey);
+	}
+
+#if CHESS_VERIFY_HASH
+	VerifyHashKeys();
+#endif
+}
+
+void FChessPosition::TakeNullMove()
+{
+	const FChessMoveRecord& Record = History.Last();
+	check(!Record.Move.IsValid());
+
+	FiftyMoveCounter = Record.FiftyMove;
+
+	if (Record.EnPassantTile != INDEX_NONE)
+	{
+		EnPassantTile.Emplace(Record.EnPassantTile);
+	}
+
+	Side = static_cast<EPieceColor>((int32)Side ^ 1);
+	PosHashKey = Record.PosHashKey;
+
+	History.Pop();
+
+#if CHESS_VERIFY_HASH
+	VerifyHashKeys();
+#endif
+}
+
+bool FChessPosition::IsRepetition() const
+{
+	//Records keep the key of the position before the move, the same side moved in every second one
+	//Capture or pawn move resets the fifty move counter, positions before it can't repeat
+	const int32 First = FMath::Max(History.Num() - FiftyMoveCounter, 0);
+
+	for (int32 i = History.Num() - 2; i >= First; i -= 2)
+	{
+		if (History[i].PosHashKey == PosHashKey)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+uint64 FChessPosition::GeneratePositionHashKey() const
+{
+	uint64 ResultKey = 0;
+
+	for (int32 Code = 1; Code < PieceBitboards.Num(); ++Code)
+	{
+		uint64 Pieces = PieceBitboards[Code];
+		while (Pieces)
+		{
+			ResultKey ^= FChessZobrist::GetPieceKey(Code, FChessBitboards::PopLsb(Pieces));
+		}
+	}
+
+	if (Side == EPieceColor::White)
+	{
+		ResultKey ^= FChessZobrist::GetSideKey();
+	}
+
+	//If en passant move available
+	if (EnPassantTile.IsSet())
+	{
+		ResultKey ^= FChessZobrist::GetEnPassantKey(EnPassantTile.GetValue());
+	}
+
+	ResultKey ^= FChessZobrist::GetCastleKey(CastlePermission);
+	return ResultKey;
+}
+
+uint64 FChessPosition::GetPolyglotKey(const uint64* Keys) const
+{
+	check(Keys);
+
+	uint64 ResultKey = 0;
+
+	for (int32 Code = 1; Code < PieceBitboards.Num(); ++Code)
+	{
+		//Polyglot orders pieces as black pawn, white pawn, black knight, white knight and so on
+		const int32 ColorCode = (Code - 1) / 6;
+		const int32 Kind = 2 * (Code - 1 - ColorCode * 6) + (ColorCode == 0 ? 1 : 0);
+
+		uint64 Pieces = PieceBitboards[Code];
+		while (Pieces)
+		{
+			ResultKey ^= Keys[64 * Kind + FChessBitboards::PopLsb(Pieces)];
+		}
+	}
+
+	//Castle rights go in the order of the permission bits, white king and queen side, then black
+	for (int32 Right = 0; Right < 4; ++Right)
+	{
+		if (CastlePermission & (1 << Right))
+		{
+			ResultKey ^= Keys[FChessZobrist::PolyglotCastleOffset + Right];
+		}
+	}
+
+	//En passant file counts only if a pawn of the moving side can capture, pins aren't checked
+	if (EnPassantTile.IsSet())
+	{
+		const int32 ColorCode = Side == EPieceColor::White ? 0 : 1;
+		const uint64 Capturers = FChessBitboards::GetPawnAttacks(1 - ColorCode, EnPassantTile.GetValue()) & PieceBitboards[ColorCode * 6 + PawnOffset];
+
+		if (Capturers)
+		{
+			ResultKey ^= Keys[FChessZobrist::PolyglotEnPassantOffset + EnPassantTile.GetValue() % 8];
+		}
+	}
+
+	if (Side == EPieceColor::White)
+	{
+		ResultKey ^= Keys[FChessZobrist::PolyglotTurnOffset];
+	}
+
+	return ResultKey;
+}
+
+uint64 FChessPosition::GeneratePawnHashKey() const
+{
+	uint64 ResultKey = 0;
+
+	for (const FChessPiece* Pawn : { &GWhitePawn, &GBlackPawn })
+	{
+		uint64 Pawns = PieceBitboards[Pawn->GetCode()];
+		while (Pawns)
+		{
+			ResultKey ^= FChessZobrist::GetPieceKey(Pawn->GetCode(), FChessBitboards::PopLsb(Pawns));
+		}
+	}
+
+	return ResultKey;
+}
+
+uint64 FChessPosition::GenerateMaterialHashKey() const
+{
+	uint64 ResultKey = 0;
+
+	for (int32 Code = 1; Code < PieceBitboards.Num(); ++Code)
+	{
+		const int32 Count = FChessBitboards::PopCount(PieceBitboards[Code]);
+		for (int32 i = 0; i < Count; ++i)
+		{
+			ResultKey ^= FChessZobrist::GetMaterialKey(Code, i);
+		}
+	}
+
+	return ResultKey;
+}
+
+void FChessPosition::VerifyHashKeys() const
+{
+	check(PosHashKey == GeneratePositionHashKey());
+	check(PawnHashKey == GeneratePawnHashKey());
+	check(MaterialHashKey == GenerateMaterialHashKey());
+}
+
+void FChessPosition::ResetBoard()
+{
+	//All tiles are empty
+	for (int32 i = 0; i < Board.Num(); ++i)
+	{
+		Board[i] = GEmptyChessPiece;
+	}
+
+	for (int32 i = 0; i < PieceBitboards.Num(); ++i)
+	{
+		PieceBitboards[i] = 0;
+	}
+
+	for (int32 i = 0; i < Occupancy.Num(); ++i)
+	{
+		Occupancy[i] = 0;
+	}
+
+	//Reset all counters to 0
+	for (int32 i = 0; i < BigPieces.Num(); ++i)
+	{
+		BigPieces[i] = 0;
+		MajorPieces[i] = 0;
+		MinorPieces[i] = 0;
+		Material[i] = 0;
+		MidgameScore[i] = 0;
+		EndgameScore[i] = 0;
+	}
+
+	RefreshAccumulator();
+
+	Side = EPieceColor::Both;
+
+	EnPassantTile.Reset();
+
+	FiftyMoveCounter = 0;
+	CastlePermission = 0;
+	PosHashKey = 0;
+	PawnHashKey = 0;
+	MaterialHashKey = 0;
+
+	Moves.Reset();
+	History.Reset();
+}
+
+bool FChessPosition::IsStalemate() const
+{
+	return Moves.Num() == 0 && !IsCheck();
+}
+
+int32 FChessPosition::GetTileIndexAt(EBoardFile File, EBoardRank Rank)
+{
+	return static_cast<int32>(File) + 21 + static_cast<int32>(Rank) * 10;
+}
+
+int32 FChessPosition::GetTileIndexAt_64(EBoardFile File, EBoardRank Rank)
+{
+	return (int32)Rank * 8 + (int32)File;
+}
+
+//Order of processing
+//
+//Assume we have 64bit integer
+//4		 15                   15                  15                  15 bit
+//0000 000000000000000 000000000000000 000000000000000 000000000000000
+//
+//We will have the following (divided by lines):
+//1. 0000 000000000000000 000000000000000 000000000000000 aaaaaaaaaaaaaaaaa
+//2. 0000 000000000000000 000000000000000 bbbbbbbbbbbbbbbbb aaaaaaaaaaaaaaaaa
+//3. 0000 000000000000000 ccccccccccccccccc bbbbbbbbbbbbbbbbb aaaaaaaaaaaaaaaaa
+//4. 0000 ddddddddddddddddd ccccccccccccccccc bbbbbbbbbbbbbbbbb aaaaaaaaaaaaaaaaa
+//5. eeee ddddddddddddddddd ccccccccccccccccc bbbbbbbbbbbbbbbbb aaaaaaaaaaaaaaaaa
+//
+//So we have 64 randomized bits (or uint64 randomized)
+
+uint64 FChessPosition::GetRandom64()
+{
+	return
+		(uint64)FMath::Rand() + 
+		((uint64)FMath::Rand() << 15) + 
+		((uint64)FMath::Rand() << 30) +
+		((uint64)FMath::Rand() << 45) +
+		(((uint64)FMath::Rand() & 0xf) << 60);
+}
+
+TPair<EBoardFile, EBoardRank> FChessPosition::ParsePositionFromString(const FString& InString)
+{
+	return MakeTuple(static_cast<EBoardFile>(InString[0] - L'a'), static_cast<EBoardRank>(InString[1] - L'1'));
+}
@@ -0,0 +1,346 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChessDefinitions.h"
+#include "TileCoordinate.h"
+#include "ChessMove.h"
+#include "ChessMoveList.h"
+#include "ChessMoveRecord.h"
+#include "ChessNetwork.h"
+
+class FChessTranspositionTable;
+
+//Which legal moves to generate
+enum class EChessMoveGen : uint8
+{
+	All,
+
+	//Captures, en passant and all promotions
+	Captures,
+
+	//Everything else, castling included
+	Quiets
+};
+
+//Recompute hash keys from scratch after every make/unmake and check them against the incremental ones
+#ifndef CHESS_VERIFY_HASH
+	#define CHESS_VERIFY_HASH UE_BUILD_DEBUG
+#endif
+
+/*
+ * Chess position without any UObject dependencies
+ * Holds the board, move generation, make/unmake moves and hashing
+ * Can be copied and used from any thread (search, perft, analysis)
+ *
+ * Board is stored as one bitboard per piece plus occupancy per side,
+ * squares are 0..63 (A1 = 0, H8 = 63), public API still takes 120-tile coords
+ */
+class CHESSCORE_API FChessPosition
+{
+public:
+
+	FChessPosition();
+
+	/**Init board layout from the FEN string
+	 * @param FEN Position description, the move counters may be left out
+	 * @return False if the FEN isn't valid (not 8x8 tiles, not one king per side, bad fields), the position is unchanged then
+	 */
+	bool InitBoard(const FString& FEN);
+
+	//Restart
+	void ResetBoard();
+
+	//Get moving side
+	EPieceColor GetSide() const;
+
+	//Set moving side, keys and moves follow it, the en passant tile is cleared
+	void SetSide(EPieceColor NewSide);
+
+	//Get chess piece at index
+	const FChessPiece& GetPieceAtTile(EBoardFile File, EBoardRank Rank) const;
+
+	//Is tile attacked by given side
+	bool IsTileAttacked(EBoardFile File, EBoardRank Rank, EPieceColor Side) const;
+
+	//All pieces move generation, only legal moves are generated
+	//Captures losing material by SEE are flagged (see FChessMoveList::IsLosingCapture)
+	void GenerateAllMoves();
+
+	/**Generate legal moves into the caller's list (search and perft keep one per ply)
+	 * Captures and promotions are scored by MVV-LVA, quiet moves get zero score
+	 * @param OutMoves List to fill, previous moves are removed
+	 * @param Type Which moves to generate
+	 */
+	void GenerateMoves(FChessMoveList& OutMoves, EChessMoveGen Type = EChessMoveGen::All) const;
+
+	//Get current legal moves for moving side
+	const FChessMoveList& GetMoves() const;
+
+	//Is move legal in the current position, doesn't need GenerateAllMoves (hash and killer moves are checked with it)
+	//Checked against the board and attacks of the king square without generating moves, except for castling
+	bool IsLegalMove(const FChessMove& Move) const;
+
+	/**Static exchange evaluation, material won by the moving side if both sides keep capturing on the target square
+	 * with their least valuable attacker, each side stops when capturing further would lose material
+	 * Sliders behind the capturing pieces (x-rays) join the exchange, pins are ignored
+	 * @param Move Legal move of the moving side, for a quiet move tells if the piece is safe on the target square
+	 * @return Gain in piece costs, negative if the move loses material
+	 */
+	int32 SEE(const FChessMove& Move) const;
+
+	//Move related functions
+	void ClearPiece(const FTileCoord& Coord);
+	void AddPiece(const FTileCoord& Coord, const FChessPiece& Piece);
+	void MovePiece(const FTileCoord& From, const FTileCoord& To);
+
+	//Main move functions
+	//
+	//Revert move (Undo)
+	void TakeMove();
+	//Make move (Do), move must be legal (taken from GetMoves)
+	void MakeMove(const FChessMove& Move);
+
+	//Pass the turn, for null move pruning, the side to move must not be in check
+	//Fifty move counter restarts, so repetitions aren't searched across the null move
+	//
+	void MakeNullMove();
+	void TakeNullMove();
+
+	//Is king under check on moving side
+	bool IsCheck() const;
+
+	//Is king under checkmate on moving side, valid after GenerateAllMoves
+	bool IsCheckMate() const;
+
+	//No moves and no check? Valid after GenerateAllMoves
+	bool IsStalemate() const;
+
+	//Did the position occur before, since the last capture or pawn move
+	bool IsRepetition() const;
+
+	//Index converters
+	//
+	int32 GetTileAs64(int32 Tile120) const;
+	int32 GetTileAs120(int32 Tile64) const;
+
+	//State getters
+	//
+	uint64 GetPosHashKey() const { return PosHashKey; }
+	//Key of the pawns placement only, for pawn structure caches
+	uint64 GetPawnHashKey() const { return PawnHashKey; }
+	//Key of the piece counts only, for material caches
+	uint64 GetMaterialHashKey() const { return MaterialHashKey; }
+	/**Key of the Polyglot opening book format, computed from the board on every call, only book lookups need it
+	 * @param Keys FChessZobrist::PolyglotKeyCount keys, see FChessZobrist::GetPolyglotKeys
+	 */
+	uint64 GetPolyglotKey(const uint64* Keys) const;
+	int32 GetCastlePermission() const { return CastlePermission; }
+	//En passant square as 0..63 index
+	TOptional<int32> GetEnPassantTile() const { return EnPassantTile; }
+	int32 GetFiftyMoveCounter() const { return FiftyMoveCounter; }
+	int32 GetMaterial(EPieceColor Color) const { return Material[(int32)Color]; }
+	//Count of non-pawn pieces, king included
+	int32 GetBigPieces(EPieceColor Color) const { return BigPieces[(int32)Color]; }
+
+	//Piece-square scores with piece values, see FChessPieceSquareTables
+	//
+	int32 GetMidgameScore(EPieceColor Color) const { return MidgameScore[(int32)Color]; }
+	int32 GetEndgameScore(EPieceColor Color) const { return EndgameScore[(int32)Color]; }
+
+	//Game phase from minor and major piece counts, FChessPieceSquareTables::MaxPhase at the start
+	int32 GetPhase() const;
+	int32 GetPieceCount(const FChessPiece& Piece) const;
+
+	//Piece at 0..63 square
+	const FChessPiece& GetPieceAt(int32 Square) const { return Board[Square]; }
+
+	//Move that led to this position, invalid at the start
+	FChessMove GetLastMove() const { return History.Num() > 0 ? History.Last().Move : FChessMove(); }
+
+	//Table whose bucket is prefetched after each MakeMove, nullptr to disable (copies of the position share it)
+	void SetTranspositionTable(const FChessTranspositionTable* Table) { TranspositionTable = Table; }
+
+	/**Network whose accumulator is updated with every piece change, nullptr to disable (copies of the position share it)
+	 * The accumulator of every made move is kept, so unmake doesn't update it back
+	 */
+	void SetNetwork(const FChessNetwork* InNetwork);
+	const FChessNetwork* GetNetwork() const { return Network; }
+
+	//Accumulator of the current position, valid only if the network is set
+	const FChessAccumulator& GetAccumulator() const { return Accumulators.Last(); }
+
+	//Bitboard of all pieces of given type
+	uint64 GetPieceBitboard(const FChessPiece& Piece) const { return PieceBitboards[Piece.GetCode()]; }
+
+	//Bitboard of all pieces of given color, EPieceColor::Both for all pieces
+	uint64 GetOccupancy(EPieceColor Color) const { return Occupancy[(int32)Color]; }
+	const TArray<FChessMoveRecord>& GetHistory() const { return History; }
+
+	/**Get 120-tile array index from given rank and file
+	 * @param File Board file
+	 * @param Rank Board rank
+	 * @return Index of playable tile in 120-tiles array
+	 */
+	static int32 GetTileIndexAt(EBoardFile File, EBoardRank Rank);
+
+	/**Converts File and Rank to 64-size array index
+	 * @param File Board file
+	 * @param Rank Board rank
+	 * @return Integer in range 0<=i<64
+	 */
+	static int32 GetTileIndexAt_64(EBoardFile File, EBoardRank Rank);
+
+	/**Makes random unsigned 64 bit integer
+	 * @note Not used for hashing, Zobrist keys are fixed (see FChessZobrist)
+	 * @return Unsigned 64 bit integer
+	 */
+	static uint64 GetRandom64();
+
+	/**Parses board position from the string
+	 * @note InString must be typed as "<BoardFileBoardRank>"
+	 * @param InString String to parse
+	 * @out Tuple with two coords - file and rank
+	 */
+	static TPair<EBoardFile, EBoardRank> ParsePositionFromString(const FString& InString);
+
+private:
+
+	//Square based versions of the move related functions
+	//
+	void ClearPiece(int32 Square);
+	void AddPiece(int32 Square, const FChessPiece& Piece);
+	void MovePiece(int32 From, int32 To);
+
+	//Is square attacked by pieces of given color code
+	bool IsSquareAttacked(int32 Square, int32 AttackerColorCode, uint64 Occupied) const;
+
+	//Pieces of given color code attacking the square, sliders are blocked by Occupied
+	uint64 GetAttackers(int32 Square, int32 AttackerColorCode, uint64 Occupied) const;
+
+	//Pieces of given color code which can't leave the line between their king and an enemy slider
+	uint64 GetPinnedPieces(int32 KingSquare, int32 ColorCode) const;
+
+	//Square of the king of given color code, or INDEX_NONE if there is no king
+	int32 GetKingSquare(int32 ColorCode) const;
+
+	//Can the piece on the From tile make the move by its movement rules and the move flags, castling excluded
+	bool IsPseudoLegalMove(const FChessMove& Move) const;
+
+	//Would the pseudo-legal move leave the moving side king attacked
+	bool IsKingAttackedAfter(const FChessMove& Move) const;
+
+	//Add basic moves
+	void AddQuietMove(FChessMoveList& OutMoves, const FChessMove& Move) const;
+	void AddCaptureMove(FChessMoveList& OutMoves, const FChessMove& Move) const;
+	void AddEnPassantMove(FChessMoveList& OutMoves, const FChessMove& Move) const;
+
+	//Add moves of the moving side pawns to every target tile, pawn stands Offset tiles behind the target
+	//Pawns reaching the last rank are added with all promotions
+	void AddPawnMoves(FChessMoveList& OutMoves, uint64 Targets, int32 Offset, int32 Flags = 0) const;
+
+	//Add moves of the piece standing on From to every target tile
+	void AddPieceMoves(FChessMoveList& OutMoves, int32 From, uint64 Targets) const;
+
+	//Piece placement by square, used to find out what is captured
+	TStaticArray<FChessPiece, 64> Board{ FChessPiece{ ETileState::NoPiece } };
+
+	//One bitboard per piece code, index 0 (no piece) is unused
+	TStaticArray<uint64, 13> PieceBitboards{ 0 };
+
+	//Occupied tiles by color, combined colors at index 2
+	TStaticArray<uint64, 3> Occupancy{ 0 };
+
+	//Moves
+	FChessMoveList Moves;
+
+	//The side that needs to make a move
+	EPieceColor Side = EPieceColor::Both;
+
+	//Square where en passant capture is possible
+	TOptional<int32> EnPassantTile;
+
+	//Count of all non-pawn pieces
+	TStaticArray<int32, 2> BigPieces{ 0 };
+
+	//Count of rooks, queens
+	TStaticArray<int32, 2> MajorPieces{ 0 };
+
+	//Count of bishops, knights
+	TStaticArray<int32, 2> MinorPieces{ 0 };
+
+	//Total values of pieces by color
+	TStaticArray<int32, 2> Material{ 0 };
+
+	//Piece-square scores by color, updated with every piece added, cleared and moved
+	//
+	TStaticArray<int32, 2> MidgameScore{ 0 };
+	TStaticArray<int32, 2> EndgameScore{ 0 };
+
+	//Tells which castle is available
+	int32 CastlePermission = 0;
+
+	//Move generator helpers
+	//TargetMask limits destination tiles: blocking or capturing the checker, staying on the pin line
+	//FromMask limits moving pieces, IsLegalMove generates moves of a single piece
+	//
+	void GenerateMoves(FChessMoveList& OutMoves, EChessMoveGen Type, uint64 FromMask) const;
+	void GeneratePawnMoves(FChessMoveList& OutMoves, uint64 Pawns, uint64 TargetMask, EChessMoveGen Type) const;
+	void GenerateEnPassantMoves(FChessMoveList& OutMoves, int32 KingSquare, uint64 FromMask) const;
+	void GeneratePieceMoves(FChessMoveList& OutMoves, uint64 TargetMask, int32 KingSquare, uint64 Pinned, uint64 FromMask) const;
+	void GenerateKingMoves(FChessMoveList& OutMoves, int32 KingSquare, uint64 TargetMask) const;
+	void GenerateCastling(FChessMoveList& OutMoves) const;
+
+	//Calculate total material
+	void UpdateListsMaterial();
+
+	//Hashing related functions, keys are shared by all positions (see FChessZobrist)
+	//All keys are updated incrementally, make move saves the position key and unmake restores it
+	//
+	void HashPiece(const FChessPiece& Piece, int32 Square);
+	void HashMaterial(const FChessPiece& Piece, int32 Count);
+	void HashCastle();
+	void HashSide();
+	void HashEnPassant();
+
+	uint64 PosHashKey = 0;
+	uint64 PawnHashKey = 0;
+	uint64 MaterialHashKey = 0;
+
+	//Compute keys from scratch
+	//
+	uint64 GeneratePositionHashKey() const;
+	uint64 GeneratePawnHashKey() const;
+	uint64 GenerateMaterialHashKey() const;
+
+	//Check incremental keys against the ones computed from scratch
+	void VerifyHashKeys() const;
+
+	//Searched positions cache, not owned
+	const FChessTranspositionTable* TranspositionTable = nullptr;
+
+	//Evaluation network, not owned
+	const FChessNetwork* Network = nullptr;
+
+	//Accumulator before every made move, the last one is the current position
+	TArray<FChessAccumulator> Accumulators;
+
+	//TakeMove restores pieces, the accumulator is restored by popping instead
+	bool bTakingMove = false;
+
+	//Compute the accumulator from scratch, drops the ones of previous moves
+	void RefreshAccumulator();
+
+
+	/*****************Going to the WIP section*****************/
+
+	//Counter that detects 50 move (100 half-move), when game is a draw
+	int32 FiftyMoveCounter = 0;
+
+	//
+	TArray<FChessMoveRecord> History;
+
+	/****************************************************/
+};
+
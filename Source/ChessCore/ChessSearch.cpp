@@ -0,0 +1,635 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChessSearch.h"
+#include "ChessEvaluation.h"
+#include "ChessTranspositionTable.h"
+
+namespace
+{
+	//Limits are checked once per this many nodes
+	const uint64 CheckLimitsNodes = 2047;
+
+	//Aspiration window half size at the start of iteration
+	const int32 AspirationWindow = 25;
+
+	//Iterations below this depth use the full window, their scores are too unstable
+	const int32 AspirationMinDepth = 4;
+
+	//Null move is tried from this depth, the reduction grows with depth
+	const int32 NullMoveMinDepth = 3;
+	const int32 NullMoveReduction = 3;
+
+	//Reverse futility margin per depth, and the deepest depth it's applied at
+	const int32 ReverseFutilityMargin = 90;
+	const int32 ReverseFutilityMaxDepth = 6;
+
+	//Razoring margin per depth, and the deepest depth it's applied at
+	const int32 RazoringMargin = 250;
+	const int32 RazoringMaxDepth = 3;
+
+	//Tablebase results are stored this much deeper than the node, no search would change them
+	const int32 TablebaseDepthBonus = 6;
+
+	//Late move reductions start at this depth, after this many moves
+	const int32 LateMoveMinDepth = 3;
+	const int32 LateMoveMinMoves = 3;
+
+	//Late move reduction by the log formula, later moves at bigger depths are reduced more
+	int32 GetLateMoveReduction(int32 Depth, int32 MoveNumber)
+	{
+		struct FReductions
+		{
+			int32 Table[64][64];
+
+			FReductions()
+			{
+				for (int32 D = 0; D < 64; ++D)
+				{
+					for (int32 M = 0; M < 64; ++M)
+					{
+						Table[D][M] = D > 0 && M > 0
+							? static_cast<int32>(0.75 + FMath::Loge((double)D) * FMath::Loge((double)M) / 2.25)
+							: 0;
+					}
+				}
+			}
+		};
+
+		static const FReductions Reductions;
+
+		return Reductions.Table[FMath::Min(Depth, 63)][FMath::Min(MoveNumber, 63)];
+	}
+}
+
+constexpr int32 FChessSearch::MaxPly;
+constexpr int32 FChessSearch::Infinity;
+constexpr int32 FChessSearch::MateScore;
+constexpr int32 FChessSearch::MateInMaxPly;
+constexpr int32 FChessSearch::TablebaseWinScore;
+
+FChessSearch::FChessSearch(FChessTranspositionTable& InTable, int32 InThreadIndex) :
+	Table(InTable),
+	Tablebase(FChessTablebase::Get()),
+	ThreadIndex(InThreadIndex)
+{
+}
+
+FChessSearchResult FChessSearch::Search(const FChessPosition& RootPosition, const FChessSearchLimits& InLimits)
+{
+	Setup(RootPosition, InLimits);
+	return Run();
+}
+
+void FChessSearch::Setup(const FChessPosition& RootPosition, const FChessSearchLimits& InLimits)
+{
+	Position = RootPosition;
+	Position.SetTranspositionTable(&Table);
+
+	Limits = InLimits;
+	StartTime = FPlatformTime::Seconds();
+	Nodes = 0;
+	PickerStats.Reset();
+	Ordering.NewSearch();
+	PawnTable.ResetStats();
+	bStopped = false;
+	bCanStop = false;
+}
+
+FChessSearchResult FChessSearch::Run()
+{
+	FChessSearchResult Result;
+
+	//Endgames of the tablebases are played from them, no search does better
+	if (ProbeTablebaseRoot(Position, Result))
+	{
+		Result.Seconds = FPlatformTime::Seconds() - StartTime;
+		return Result;
+	}
+
+	const int32 MaxDepth = Limits.Depth > 0 ? FMath::Min(Limits.Depth, MaxPly) : MaxPly;
+	int32 Score = 0;
+
+	//Lazy SMP: half of the helpers skip the first depth, so threads finish iterations at different times
+	//and fill the shared table with different parts of the tree
+	const int32 StartDepth = FMath::Min(1 + (ThreadIndex & 1), MaxDepth);
+
+	for (int32 Depth = StartDepth; Depth <= MaxDepth; ++Depth)
+	{
+		Score = AspirationSearch(Depth, Score);
+
+		if (bStopped)
+		{
+			break;
+		}
+
+		Result.Score = Score;
+		Result.Depth = Depth;
+		Result.PrincipalVariation.Reset();
+
+		for (int32 i = 0; i < PvLength[0]; ++i)
+		{
+			Result.PrincipalVariation.Add(PvTable[0][i]);
+		}
+
+		Result.BestMove = PvLength[0] > 0 ? PvTable[0][0] : FChessMove();
+		bCanStop = true;
+
+		//No moves at the root, or the mate is found and deeper iterations won't change it
+		if (!Result.BestMove.IsValid() || (IsMateScore(Score) && MateScore - FMath::Abs(Score) <= Depth))
+		{
+			break;
+		}
+
+		//The next iteration takes longer than all previous ones, don't start what can't be finished
+		const double Elapsed = FPlatformTime::Seconds() - StartTime;
+		if (Limits.TimeMs > 0 && Elapsed * 1000.0 > Limits.TimeMs * 0.5)
+		{
+			break;
+		}
+	}
+
+	Result.Nodes = Nodes;
+	Result.PickerStats = PickerStats;
+	Result.PawnTableHitRate = PawnTable.GetHitRate();
+	Result.Seconds = FPlatformTime::Seconds() - StartTime;
+
+	return Result;
+}
+
+void FChessSearch::Stop()
+{
+	bStopped = true;
+}
+
+int32 FChessSearch::AspirationSearch(int32 Depth, int32 PreviousScore)
+{
+	if (Depth < AspirationMinDepth || IsMateScore(PreviousScore))
+	{
+		return AlphaBeta(-Infinity, Infinity, Depth, 0);
+	}
+
+	int32 Delta = AspirationWindow;
+	int32 Alpha = FMath::Max(PreviousScore - Delta, -Infinity);
+	int32 Beta = FMath::Min(PreviousScore + Delta, Infinity);
+
+	while (true)
+	{
+		const int32 Score = AlphaBeta(Alpha, Beta, Depth, 0);
+
+		if (bStopped)
+		{
+			return Score;
+		}
+
+		//Failed, widen the window on the failed side and search again
+		if (Score <= Alpha)
+		{
+			Beta = (Alpha + Beta) / 2;
+			Alpha = FMath::Max(Score - Delta, -Infinity);
+		}
+		else if (Score >= Beta)
+		{
+			Beta = FMath::Min(Score + Delta, Infinity);
+		}
+		else
+		{
+			return Score;
+		}
+
+		Delta += Delta / 2;
+	}
+}
+
+int32 FChessSearch::AlphaBeta(int32 Alpha, int32 Beta, int32 Depth, int32 Ply)
+{
+	PvLength[Ply] = Ply;
+
+	const bool bRoot = Ply == 0;
+	const bool bPvNode = Beta - Alpha > 1;
+
+	if ((++Nodes & CheckLimitsNodes) == 0)
+	{
+		CheckLimits();
+	}
+
+	if (bStopped)
+	{
+		return 0;
+	}
+
+	if (!bRoot)
+	{
+		if (Position.GetFiftyMoveCounter() >= 100 || Position.IsRepetition())
+		{
+			return 0;
+		}
+
+		if (Ply >= MaxPly)
+		{
+			return FChessEvaluation::Evaluate(Position, &PawnTable);
+		}
+	}
+
+	const bool bInCheck = Position.IsCheck();
+
+	//Don't stop the search while in check, there may be a mate
+	if (bInCheck)
+	{
+		++Depth;
+	}
+
+	if (Depth <= 0)
+	{
+		return QSearch(Alpha, Beta, Ply);
+	}
+
+	const uint64 Key = Position.GetPosHashKey();
+
+	FChessTranspositionEntry Entry;
+	const bool bTableHit = Table.Probe(Key, Entry);
+
+	if (bTableHit && !bPvNode && Entry.Depth >= Depth)
+	{
+		const int32 TableScore = ScoreFromTable(Entry.Score, Ply);
+
+		if (Entry.Bound == EChessBound::Exact
+			|| (Entry.Bound == EChessBound::Lower && TableScore >= Beta)
+			|| (Entry.Bound == EChessBound::Upper && TableScore <= Alpha))
+		{
+			return TableScore;
+		}
+	}
+
+	//Right after a capture or pawn move the tablebase result is exact, the fifty move counter can't spoil it yet
+	EChessWdl Wdl;
+	if (!bRoot && Position.GetFiftyMoveCounter() == 0 && Tablebase.ProbeWdl(Position, Wdl))
+	{
+		const int32 Score = GetTablebaseScore(Wdl, Ply);
+
+		//Tables don't tell how fast the win is, the search may still find a mate
+		const EChessBound Bound = Wdl == EChessWdl::Win
+			? EChessBound::Lower
+			: (Wdl == EChessWdl::Loss ? EChessBound::Upper : EChessBound::Exact);
+
+		if (Bound == EChessBound::Exact
+			|| (Bound == EChessBound::Lower && Score >= Beta)
+			|| (Bound == EChessBound::Upper && Score <= Alpha))
+		{
+			const int32 Eval = bInCheck ? 0 : FChessEvaluation::Evaluate(Position, &PawnTable);
+			Table.Store(Key, FChessMove(), ScoreToTable(Score, Ply), Eval, FMath::Min(Depth + TablebaseDepthBonus, FChessTranspositionTable::MaxDepth), Bound);
+
+			return Score;
+		}
+	}
+
+	//Evaluation is meaningless in check, every evasion is searched anyway
+	int32 StaticEval = 0;
+	if (!bInCheck)
+	{
+		StaticEval = bTableHit ? Entry.Eval : FChessEvaluation::Evaluate(Position, &PawnTable);
+	}
+
+	//Selective pruning, PV nodes are always searched fully to keep the line exact
+	if (!bPvNode && !bInCheck)
+	{
+		//Far above beta near the leaves, the opponent won't recover in the remaining depth
+		if (Options.bReverseFutility
+			&& Depth <= ReverseFutilityMaxDepth
+			&& !IsMateScore(Beta)
+			&& StaticEval - ReverseFutilityMargin * Depth >= Beta)
+		{
+			return StaticEval;
+		}
+
+		//Far below alpha near the leaves, only captures can help, check them with quiescence
+		if (Options.bRazoring
+			&& Depth <= RazoringMaxDepth
+			&& StaticEval + RazoringMargin * Depth <= Alpha)
+		{
+			const int32 Score = QSearch(Alpha, Alpha + 1, Ply);
+
+			if (Score <= Alpha)
+			{
+				return Score;
+			}
+		}
+
+		//Pawn endings are full of zugzwang, passing may be the only bad move there,
+		//two null moves in a row would search the same position
+		if (Options.bNullMove
+			&& Depth >= NullMoveMinDepth
+			&& StaticEval >= Beta
+			&& Position.GetBigPieces(Position.GetSide()) > 1
+			&& Position.GetLastMove().IsValid())
+		{
+			const int32 Reduction = NullMoveReduction + Depth / 6;
+
+			Position.MakeNullMove();
+			int32 Score = -AlphaBeta(-Beta, -Beta + 1, Depth - 1 - Reduction, Ply + 1);
+			Position.TakeNullMove();
+
+			if (bStopped)
+			{
+				return 0;
+			}
+
+			if (Score >= Beta)
+			{
+				//Mate after passing isn't proven
+				return IsMateScore(Score) ? Beta : Score;
+			}
+		}
+	}
+
+	//Best move of the previous search of this position goes first, then captures by MVV-LVA, killers and quiet moves
+	FChessMovePicker Picker(Position, bTableHit ? Entry.Move : FChessMove(), &Ordering, Ply, &PickerStats);
+
+	const int32 OriginalAlpha = Alpha;
+	int32 BestScore = -Infinity;
+	FChessMove BestMove;
+	int32 MovesSearched = 0;
+
+	//Quiet moves which didn't cut off, their history is lowered when another quiet move does
+	FChessMove TriedQuiets[64];
+	int32 TriedQuietCount = 0;
+
+	for (FChessMove Move = Picker.Next(); Move.IsValid(); Move = Picker.Next())
+	{
+		Position.MakeMove(Move);
+
+		const bool bQuiet = !Move.IsCapture() && !Move.IsPromotion();
+
+		int32 Score;
+		if (MovesSearched++ == 0)
+		{
+			Score = -AlphaBeta(-Beta, -Alpha, Depth - 1, Ply + 1);
+		}
+		else
+		{
+			//Late quiet moves rarely beat the first ones, search them shallower first
+			int32 Reduction = 0;
+
+			if (Options.bLateMoveReductions
+				&& Depth >= LateMoveMinDepth
+				&& MovesSearched > LateMoveMinMoves
+				&& bQuiet
+				&& !bInCheck
+				&& !Position.IsCheck())
+			{
+				Reduction = GetLateMoveReduction(Depth, MovesSearched);
+
+				//Less in PV nodes and for killers, they are more likely to be good
+				if (bPvNode)
+				{
+					--Reduction;
+				}
+
+				if (Picker.GetStage() == EChessPickStage::Killers)
+				{
+					--Reduction;
+				}
+
+				Reduction = FMath::Clamp(Reduction, 0, Depth - 2);
+			}
+
+			//Prove the move is worse than the first one with a null window, search fully only if it isn't
+			Score = -AlphaBeta(-Alpha - 1, -Alpha, Depth - 1 - Reduction, Ply + 1);
+
+			if (Reduction > 0 && Score > Alpha)
+			{
+				Score = -AlphaBeta(-Alpha - 1, -Alpha, Depth - 1, Ply + 1);
+			}
+
+			if (Score > Alpha && Score < Beta)
+			{
+				Score = -AlphaBeta(-Beta, -Alpha, Depth - 1, Ply + 1);
+			}
+		}
+
+		Position.TakeMove();
+
+		if (bStopped)
+		{
+			return 0;
+		}
+
+		if (Score > BestScore)
+		{
+			BestScore = Score;
+			BestMove = Move;
+
+			if (Score > Alpha)
+			{
+				Alpha = Score;
+
+				//New PV: this move followed by the line of the child
+				PvTable[Ply][Ply] = Move;
+				for (int32 Next = Ply + 1; Next < PvLength[Ply + 1]; ++Next)
+				{
+					PvTable[Ply][Next] = PvTable[Ply + 1][Next];
+				}
+				PvLength[Ply] = PvLength[Ply + 1];
+
+				if (Alpha >= Beta)
+				{
+					if (bQuiet)
+					{
+						Ordering.UpdateCutoff(Position, Move, Ply, Depth, TriedQuiets, TriedQuietCount);
+					}
+
+					break;
+				}
+			}
+		}
+
+		if (bQuiet && TriedQuietCount < UE_ARRAY_COUNT(TriedQuiets))
+		{
+			TriedQuiets[TriedQuietCount++] = Move;
+		}
+	}
+
+	if (MovesSearched == 0)
+	{
+		//Mated positions closer to the root score worse
+		return bInCheck ? -MateScore + Ply : 0;
+	}
+
+	const EChessBound Bound = BestScore >= Beta
+		? EChessBound::Lower
+		: (BestScore > OriginalAlpha ? EChessBound::Exact : EChessBound::Upper);
+
+	Table.Store(Key, BestMove, ScoreToTable(BestScore, Ply), StaticEval, Depth, Bound);
+
+	return BestScore;
+}
+
+int32 FChessSearch::QSearch(int32 Alpha, int32 Beta, int32 Ply)
+{
+	if ((++Nodes & CheckLimitsNodes) == 0)
+	{
+		CheckLimits();
+	}
+
+	if (bStopped)
+	{
+		return 0;
+	}
+
+	const bool bInCheck = Position.IsCheck();
+
+	if (Ply >= MaxPly)
+	{
+		return bInCheck ? 0 : FChessEvaluation::Evaluate(Position, &PawnTable);
+	}
+
+	//In check every evasion is searched, standing pat would ignore the threat
+	int32 BestScore = -Infinity;
+
+	if (!bInCheck)
+	{
+		BestScore = FChessEvaluation::Evaluate(Position, &PawnTable);
+
+		if (BestScore >= Beta)
+		{
+			return BestScore;
+		}
+
+		Alpha = FMath::Max(Alpha, BestScore);
+	}
+
+	FChessMoveList Moves;
+	Position.GenerateMoves(Moves, bInCheck ? EChessMoveGen::All : EChessMoveGen::Captures);
+
+	if (bInCheck && Moves.Num() == 0)
+	{
+		return -MateScore + Ply;
+	}
+
+	for (int32 i = 0; i < Moves.Num(); ++i)
+	{
+		const FChessMove Move = Moves.PickNextMove(i);
+
+		//Losing exchanges can't raise the stand pat score, evasions are all needed
+		if (!bInCheck && Move.IsCapture() && Position.SEE(Move) < 0)
+		{
+			continue;
+		}
+
+		Position.MakeMove(Move);
+		const int32 Score = -QSearch(-Beta, -Alpha, Ply + 1);
+		Position.TakeMove();
+
+		if (bStopped)
+		{
+			return 0;
+		}
+
+		if (Score > BestScore)
+		{
+			BestScore = Score;
+
+			if (Score > Alpha)
+			{
+				Alpha = Score;
+
+				if (Alpha >= Beta)
+				{
+					break;
+				}
+			}
+		}
+	}
+
+	return BestScore;
+}
+
+void FChessSearch::CheckLimits()
+{
+	if (!bCanStop)
+	{
+		return;
+	}
+
+	if (Limits.Nodes > 0 && Nodes >= Limits.Nodes)
+	{
+		bStopped = true;
+	}
+
+	if (Limits.TimeMs > 0 && (FPlatformTime::Seconds() - StartTime) * 1000.0 >= Limits.TimeMs)
+	{
+		bStopped = true;
+	}
+}
+
+int32 FChessSearch::ScoreToTable(int32 Score, int32 Ply)
+{
+	if (Score >= MateInMaxPly)
+	{
+		return Score + Ply;
+	}
+
+	if (Score <= -MateInMaxPly)
+	{
+		return Score - Ply;
+	}
+
+	return Score;
+}
+
+int32 FChessSearch::ScoreFromTable(int32 Score, int32 Ply)
+{
+	if (Score >= MateInMaxPly)
+	{
+		return Score - Ply;
+	}
+
+	if (Score <= -MateInMaxPly)
+	{
+		return Score + Ply;
+	}
+
+	return Score;
+}
+
+int32 FChessSearch::GetTablebaseScore(EChessWdl Wdl, int32 Ply)
+{
+	switch (Wdl)
+	{
+	case EChessWdl::Win:
+		return TablebaseWinScore - Ply;
+
+	case EChessWdl::CursedWin:
+		return 1;
+
+	case EChessWdl::BlessedLoss:
+		return -1;
+
+	case EChessWdl::Loss:
+		return -TablebaseWinScore + Ply;
+
+	default:
+		return 0;
+	}
+}
+
+bool FChessSearch::ProbeTablebaseRoot(FChessPosition& Position, FChessSearchResult& OutResult)
+{
+	FChessMove Move;
+	EChessWdl Wdl;
+	int32 Dtz;
+
+	if (!FChessTablebase::Get().ProbeRoot(Position, Move, Wdl, Dtz))
+	{
+		return false;
+	}
+
+	OutResult = FChessSearchResult();
+	OutResult.BestMove = Move;
+	OutResult.Depth = 1;
+	OutResult.PrincipalVariation.Add(Move);
+
+	//Distance to the next capture or pawn move stands for the distance to mate, so the score falls as the win progresses
+	OutResult.Score = GetTablebaseScore(Wdl, FMath::Min(FMath::Abs(Dtz), MaxPly));
+
+	return true;
+}
@@ -0,0 +1,187 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChessMove.h"
+#include "ChessMoveOrdering.h"
+#include "ChessMovePicker.h"
+#include "ChessPawnTable.h"
+#include "ChessPosition.h"
+#include "ChessTablebase.h"
+#include "HAL/ThreadSafeBool.h"
+
+class FChessTranspositionTable;
+
+//When to stop the search, zero means no limit, search stops at whichever limit comes first
+struct CHESSCORE_API FChessSearchLimits
+{
+	//Wall time in milliseconds
+	int32 TimeMs = 0;
+
+	//Count of visited nodes
+	uint64 Nodes = 0;
+
+	//Iterative deepening depth
+	int32 Depth = 0;
+};
+
+//Selective search switches, all on by default, turned off one by one to measure their node savings
+struct CHESSCORE_API FChessSearchOptions
+{
+	//Give the opponent a free move, if the position still fails high it's not worth a full search
+	bool bNullMove = true;
+
+	//Search quiet moves ordered late to a smaller depth, re-search if they beat alpha
+	bool bLateMoveReductions = true;
+
+	//Near the leaves cut off when the static evaluation is above beta by a margin
+	bool bReverseFutility = true;
+
+	//Near the leaves drop into quiescence when the static evaluation is far below alpha
+	bool bRazoring = true;
+};
+
+//Result of the last completed iteration
+struct CHESSCORE_API FChessSearchResult
+{
+	FChessMove BestMove;
+
+	//Centipawns from the moving side point of view, see FChessSearch::IsMateScore
+	int32 Score = 0;
+
+	//Depth of the last completed iteration
+	int32 Depth = 0;
+
+	uint64 Nodes = 0;
+	double Seconds = 0.0;
+
+	//Expected line of play, starting with BestMove
+	TArray<FChessMove> PrincipalVariation;
+
+	//Stages reached by the move pickers of the main search
+	FChessMovePickerStats PickerStats;
+
+	//Share of evaluations which found their pawn structure cached, 0..1
+	double PawnTableHitRate = 0.0;
+};
+
+/*
+ * Iterative deepening alpha-beta search
+ * Principal variation search with aspiration windows, transposition table cutoffs and a triangular PV table
+ * Quiet moves are ordered by killers, countermoves and history, which are kept between searches of one instance
+ * Non-PV nodes are pruned by null move, reverse futility and razoring, late quiet moves are reduced (see FChessSearchOptions)
+ * Endgames of the tablebases (FChessTablebase::Get) are played from them at the root and scored by them in the tree
+ * Works on its own copy of the position, so it can run on any thread
+ */
+class CHESSCORE_API FChessSearch
+{
+public:
+
+	static constexpr int32 MaxPly = FChessMoveOrdering::MaxPly;
+
+	//Scores
+	//
+	static constexpr int32 Infinity = 32000;
+	static constexpr int32 MateScore = 31000;
+
+	//Scores above are mates found within MaxPly
+	static constexpr int32 MateInMaxPly = MateScore - MaxPly;
+
+	//Tablebase wins score below mates, but above any evaluation
+	static constexpr int32 TablebaseWinScore = MateInMaxPly - 1;
+
+	/**Make search
+	 * @param InTable Transposition table to use, shared with other searches
+	 * @param InThreadIndex Index of the thread in parallel search, helpers (index above 0) start at different depths
+	 */
+	explicit FChessSearch(FChessTranspositionTable& InTable, int32 InThreadIndex = 0);
+
+	/**Search best move of the position
+	 * @param RootPosition Position to search, it's copied, so the caller can keep using it
+	 * @param Limits When to stop
+	 * @return Result of the last completed iteration, depth 1 is always completed
+	 */
+	FChessSearchResult Search(const FChessPosition& RootPosition, const FChessSearchLimits& Limits);
+
+	//Search split in two steps for threads: Setup copies the position and clears the stop flag on the calling thread,
+	//Run searches on the worker thread, so Stop called after Setup is never lost
+	//
+	void Setup(const FChessPosition& RootPosition, const FChessSearchLimits& Limits);
+	FChessSearchResult Run();
+
+	//Abort the running search from another thread, Search returns the last completed iteration
+	void Stop();
+
+	//Options are read by the next search
+	//
+	void SetOptions(const FChessSearchOptions& InOptions) { Options = InOptions; }
+	const FChessSearchOptions& GetOptions() const { return Options; }
+
+	static bool IsMateScore(int32 Score) { return FMath::Abs(Score) >= MateInMaxPly; }
+
+	//Mate scores are stored in the table relative to the node, not to the root
+	//
+	static int32 ScoreToTable(int32 Score, int32 Ply);
+	static int32 ScoreFromTable(int32 Score, int32 Ply);
+
+	/**Score of the tablebase result, wins found closer to the root score higher
+	 * Cursed wins and blessed losses are drawn by the fifty move rule, they score just above and below a draw
+	 */
+	static int32 GetTablebaseScore(EChessWdl Wdl, int32 Ply);
+
+	/**Result of the root position played from the tablebases, no nodes are searched
+	 * @param Position Root position, moves are made and taken back
+	 * @param OutResult Best move by the tables, scored by the distance to the next capture or pawn move
+	 * @return False if the position isn't in the tables
+	 */
+	static bool ProbeTablebaseRoot(FChessPosition& Position, FChessSearchResult& OutResult);
+
+	/**Quiescence search of the position given to Setup: only captures and promotions are searched
+	 * until the position is quiet, so leaf scores don't miss a hanging piece (horizon effect)
+	 * The moving side may also stand pat, when it's not in check
+	 * @return Score for the moving side
+	 */
+	int32 QSearch(int32 Alpha, int32 Beta, int32 Ply = 0);
+
+private:
+
+	//Negamax with principal variation search, returns score for the moving side
+	int32 AlphaBeta(int32 Alpha, int32 Beta, int32 Depth, int32 Ply);
+
+	//Search all root moves to given depth, window is widened until the score falls into it
+	int32 AspirationSearch(int32 Depth, int32 PreviousScore);
+
+	//Check limits, called every few thousand nodes
+	void CheckLimits();
+
+	FChessPosition Position;
+	FChessTranspositionTable& Table;
+
+	//Shared tablebases, probed in the tree
+	const FChessTablebase& Tablebase;
+
+	int32 ThreadIndex = 0;
+
+	FChessSearchLimits Limits;
+	FChessSearchOptions Options;
+	double StartTime = 0.0;
+	uint64 Nodes = 0;
+	FChessMovePickerStats PickerStats;
+
+	//Quiet move ordering of this thread
+	FChessMoveOrdering Ordering;
+
+	//Pawn structure cache of this thread, kept between searches
+	FChessPawnTable PawnTable;
+
+	//Set when any limit is reached or Stop is called
+	FThreadSafeBool bStopped;
+
+	//Limits are ignored until the first iteration is completed, so there is always a move
+	bool bCanStop = false;
+
+	//Triangular PV table, line found at ply P is stored in PvTable[P][P..PvLength[P])
+	int32 PvLength[MaxPly + 1];
+	FChessMove PvTable[MaxPly + 1][MaxPly + 1];
+};
@@ -0,0 +1,427 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChessSlicedSearch.h"
+#include "ChessEvaluation.h"
+#include "ChessTranspositionTable.h"
+
+namespace
+{
+	//Clock is read once per this many steps, a step searches at most one node
+	const uint32 CheckTimeSteps = 31;
+
+	//Ordering score of the hash move, above everything FChessMoveOrdering::ScoreMoves gives
+	const int32 HashMoveScore = 1 << 30;
+
+	//Tablebase results are stored this much deeper than the node, the same as FChessSearch does
+	const int32 TablebaseDepthBonus = 6;
+}
+
+constexpr int32 FChessSlicedSearch::MaxPly;
+
+FChessSlicedSearch::FChessSlicedSearch(FChessTranspositionTable& InTable) :
+	Table(InTable),
+	Tablebase(FChessTablebase::Get())
+{
+	//Frames hold move lists, allocated once for the deepest line
+	Stack.SetNum(MaxPly + 1);
+}
+
+void FChessSlicedSearch::Start(const FChessPosition& InRootPosition, const FChessSearchLimits& InLimits)
+{
+	RootPosition = InRootPosition;
+	Position = RootPosition;
+	Position.SetTranspositionTable(&Table);
+
+	Limits = InLimits;
+	StartTime = FPlatformTime::Seconds();
+	Nodes = 0;
+	Ordering.NewSearch();
+	PawnTable.ResetStats();
+	Result = FChessSearchResult();
+
+	Top = 0;
+	IterationDepth = 1;
+	bRunning = true;
+
+	//Endgames of the tablebases are played from them, the root isn't pushed and the first Step finishes
+	if (FChessSearch::ProbeTablebaseRoot(Position, Result))
+	{
+		return;
+	}
+
+	PushNode(-FChessSearch::Infinity, FChessSearch::Infinity, IterationDepth);
+}
+
+bool FChessSlicedSearch::Step(int32 BudgetMicroseconds)
+{
+	const double Deadline = FPlatformTime::Seconds() + BudgetMicroseconds / 1000000.0;
+	uint32 Steps = 0;
+
+	//Root was resolved by the tablebases in Start
+	if (bRunning && Top == 0)
+	{
+		bRunning = false;
+	}
+
+	while (bRunning)
+	{
+		if ((++Steps & CheckTimeSteps) == 0)
+		{
+			if (IsLimitReached())
+			{
+				Stop();
+				break;
+			}
+
+			if (FPlatformTime::Seconds() >= Deadline)
+			{
+				break;
+			}
+		}
+
+		AdvanceNode();
+	}
+
+	Result.Nodes = Nodes;
+	Result.Seconds = FPlatformTime::Seconds() - StartTime;
+	Result.PawnTableHitRate = PawnTable.GetHitRate();
+
+	return !bRunning;
+}
+
+void FChessSlicedSearch::Stop()
+{
+	if (bRunning)
+	{
+		//Unwinding the made moves one by one is the same as starting from the root copy
+		Position = RootPosition;
+		Position.SetTranspositionTable(&Table);
+		Top = 0;
+		bRunning = false;
+	}
+}
+
+void FChessSlicedSearch::PushNode(int32 Alpha, int32 Beta, int32 Depth)
+{
+	checkSlow(Top <= MaxPly);
+
+	FFrame& Frame = Stack[Top++];
+	Frame.Alpha = Alpha;
+	Frame.Beta = Beta;
+	Frame.OriginalAlpha = Alpha;
+	Frame.Depth = Depth;
+	Frame.BestScore = -FChessSearch::Infinity;
+	Frame.BestMove = FChessMove();
+	Frame.CurrentMove = FChessMove();
+	Frame.NextMove = 0;
+	Frame.TriedQuietCount = 0;
+
+	++Nodes;
+
+	int32 Score;
+	if (EnterNode(Score))
+	{
+		LeaveNode(Score);
+	}
+}
+
+bool FChessSlicedSearch::EnterNode(int32& OutScore)
+{
+	FFrame& Frame = Stack[Top - 1];
+	const int32 Ply = Top - 1;
+
+	if (Ply > 0)
+	{
+		if (Position.GetFiftyMoveCounter() >= 100 || Position.IsRepetition())
+		{
+			OutScore = 0;
+			return true;
+		}
+
+		if (Ply >= MaxPly)
+		{
+			OutScore = FChessEvaluation::Evaluate(Position, &PawnTable);
+			return true;
+		}
+	}
+
+	Frame.bInCheck = Position.IsCheck();
+
+	//Don't stop the search while in check, there may be a mate
+	if (Frame.bInCheck)
+	{
+		++Frame.Depth;
+	}
+
+	Frame.bQuiescence = Frame.Depth <= 0;
+
+	if (Frame.bQuiescence)
+	{
+		//In check every evasion is searched, standing pat would ignore the threat
+		if (!Frame.bInCheck)
+		{
+			Frame.BestScore = FChessEvaluation::Evaluate(Position, &PawnTable);
+
+			if (Frame.BestScore >= Frame.Beta)
+			{
+				OutScore = Frame.BestScore;
+				return true;
+			}
+
+			Frame.Alpha = FMath::Max(Frame.Alpha, Frame.BestScore);
+		}
+
+		Position.GenerateMoves(Frame.Moves, Frame.bInCheck ? EChessMoveGen::All : EChessMoveGen::Captures);
+
+		if (Frame.bInCheck && Frame.Moves.Num() == 0)
+		{
+			OutScore = -FChessSearch::MateScore + Ply;
+			return true;
+		}
+
+		return false;
+	}
+
+	FChessTranspositionEntry Entry;
+	const bool bTableHit = Table.Probe(Position.GetPosHashKey(), Entry);
+
+	if (bTableHit && Ply > 0 && Entry.Depth >= Frame.Depth)
+	{
+		const int32 TableScore = FChessSearch::ScoreFromTable(Entry.Score, Ply);
+
+		if (Entry.Bound == EChessBound::Exact
+			|| (Entry.Bound == EChessBound::Lower && TableScore >= Frame.Beta)
+			|| (Entry.Bound == EChessBound::Upper && TableScore <= Frame.Alpha))
+		{
+			OutScore = TableScore;
+			return true;
+		}
+	}
+
+	//Right after a capture or pawn move the tablebase result is exact, the fifty move counter can't spoil it yet
+	EChessWdl Wdl;
+	if (Ply > 0 && Position.GetFiftyMoveCounter() == 0 && Tablebase.ProbeWdl(Position, Wdl))
+	{
+		const int32 Score = FChessSearch::GetTablebaseScore(Wdl, Ply);
+
+		//Tables don't tell how fast the win is, the search may still find a mate
+		const EChessBound Bound = Wdl == EChessWdl::Win
+			? EChessBound::Lower
+			: (Wdl == EChessWdl::Loss ? EChessBound::Upper : EChessBound::Exact);
+
+		if (Bound == EChessBound::Exact
+			|| (Bound == EChessBound::Lower && Score >= Frame.Beta)
+			|| (Bound == EChessBound::Upper && Score <= Frame.Alpha))
+		{
+			//Resolved nodes aren't stored when they leave, the result is stored here
+			const int32 Eval = Frame.bInCheck ? 0 : FChessEvaluation::Evaluate(Position, &PawnTable);
+			Table.Store(Position.GetPosHashKey(), FChessMove(), FChessSearch::ScoreToTable(Score, Ply), Eval, FMath::Min(Frame.Depth + TablebaseDepthBonus, FChessTranspositionTable::MaxDepth), Bound);
+
+			OutScore = Score;
+			return true;
+		}
+	}
+
+	//Table is shared with FChessSearch, which reads the static evaluation back
+	Frame.StaticEval = 0;
+	if (!Frame.bInCheck)
+	{
+		Frame.StaticEval = bTableHit ? Entry.Eval : FChessEvaluation::Evaluate(Position, &PawnTable);
+	}
+
+	Position.GenerateMoves(Frame.Moves);
+
+	if (Frame.Moves.Num() == 0)
+	{
+		OutScore = Frame.bInCheck ? -FChessSearch::MateScore + Ply : 0;
+		return true;
+	}
+
+	Ordering.ScoreMoves(Position, Frame.Moves, Ply);
+
+	if (bTableHit && Entry.Move.IsValid())
+	{
+		for (int32 i = 0; i < Frame.Moves.Num(); ++i)
+		{
+			if (Frame.Moves[i] == Entry.Move)
+			{
+				Frame.Moves.SetScore(i, HashMoveScore);
+				break;
+			}
+		}
+	}
+
+	return false;
+}
+
+void FChessSlicedSearch::LeaveNode(int32 Score)
+{
+	const int32 Ply = --Top;
+	const FFrame& Frame = Stack[Ply];
+
+	//Quiescence and resolved nodes leave before searching any move, they aren't stored
+	if (!Frame.bQuiescence && Frame.NextMove > 0)
+	{
+		const EChessBound Bound =
+			Score >= Frame.Beta ? EChessBound::Lower :
+			Score > Frame.OriginalAlpha ? EChessBound::Exact :
+			EChessBound::Upper;
+
+		Table.Store(Position.GetPosHashKey(), Frame.BestMove, FChessSearch::ScoreToTable(Score, Ply), Frame.StaticEval, Frame.Depth, Bound);
+	}
+
+	if (Top == 0)
+	{
+		CompleteIteration(Score);
+	}
+	else
+	{
+		ReturnedScore = Score;
+	}
+}
+
+void FChessSlicedSearch::AdvanceNode()
+{
+	FFrame& Frame = Stack[Top - 1];
+	const int32 Ply = Top - 1;
+
+	//Child of the current move returned
+	if (Frame.CurrentMove.IsValid())
+	{
+		const FChessMove Move = Frame.CurrentMove;
+		const int32 Score = -ReturnedScore;
+
+		Position.TakeMove();
+		Frame.CurrentMove = FChessMove();
+
+		const bool bQuiet = !Move.IsCapture() && !Move.IsPromotion();
+
+		if (Score > Frame.BestScore)
+		{
+			Frame.BestScore = Score;
+
+			if (Score > Frame.Alpha)
+			{
+				Frame.Alpha = Score;
+				Frame.BestMove = Move;
+
+				//Partial result, the root window is full, so every raise is a better move
+				if (Ply == 0)
+				{
+					Result.BestMove = Move;
+					Result.Score = Score;
+				}
+
+				if (Score >= Frame.Beta)
+				{
+					if (bQuiet && !Frame.bQuiescence)
+					{
+						Ordering.UpdateCutoff(Position, Move, Ply, Frame.Depth, Frame.TriedQuiets, Frame.TriedQuietCount);
+					}
+
+					LeaveNode(Score);
+					return;
+				}
+			}
+		}
+
+		if (bQuiet && Frame.TriedQuietCount < UE_ARRAY_COUNT(Frame.TriedQuiets))
+		{
+			Frame.TriedQuiets[Frame.TriedQuietCount++] = Move;
+		}
+	}
+
+	while (Frame.NextMove < Frame.Moves.Num())
+	{
+		const FChessMove Move = Frame.Moves.PickNextMove(Frame.NextMove++);
+
+		//Losing exchanges can't raise the stand pat score, evasions are all needed
+		if (Frame.bQuiescence && !Frame.bInCheck && Move.IsCapture() && Position.SEE(Move) < 0)
+		{
+			continue;
+		}
+
+		Frame.CurrentMove = Move;
+		Position.MakeMove(Move);
+
+		//Stack never grows, so the frame reference stays valid
+		PushNode(-Frame.Beta, -Frame.Alpha, Frame.Depth - 1);
+		return;
+	}
+
+	//Every move searched without a cutoff
+	LeaveNode(Frame.BestScore);
+}
+
+void FChessSlicedSearch::CompleteIteration(int32 Score)
+{
+	const FChessMove BestMove = Stack[0].BestMove;
+
+	Result.Depth = IterationDepth;
+	Result.Score = Score;
+	Result.BestMove = BestMove;
+
+	ExtractPrincipalVariation(IterationDepth);
+
+	const int32 MaxDepth = Limits.Depth > 0 ? FMath::Min(Limits.Depth, MaxPly) : MaxPly;
+	const double Elapsed = FPlatformTime::Seconds() - StartTime;
+
+	//No moves at the root, the mate is found and deeper iterations won't change it,
+	//or the next iteration takes longer than all previous ones and can't be finished
+	if (!BestMove.IsValid()
+		|| IterationDepth >= MaxDepth
+		|| (FChessSearch::IsMateScore(Score) && FChessSearch::MateScore - FMath::Abs(Score) <= IterationDepth)
+		|| (Limits.TimeMs > 0 && Elapsed * 1000.0 > Limits.TimeMs * 0.5))
+	{
+		bRunning = false;
+		return;
+	}
+
+	++IterationDepth;
+	PushNode(-FChessSearch::Infinity, FChessSearch::Infinity, IterationDepth);
+}
+
+void FChessSlicedSearch::ExtractPrincipalVariation(int32 MaxLength)
+{
+	Result.PrincipalVariation.Reset();
+
+	if (!Result.BestMove.IsValid())
+	{
+		return;
+	}
+
+	Result.PrincipalVariation.Add(Result.BestMove);
+	Position.MakeMove(Result.BestMove);
+
+	//Rest of the line is what the table remembers, it stops at the first overwritten entry
+	FChessTranspositionEntry Entry;
+
+	while (Result.PrincipalVariation.Num() < MaxLength
+		&& Table.Probe(Position.GetPosHashKey(), Entry)
+		&& Position.IsLegalMove(Entry.Move))
+	{
+		Result.PrincipalVariation.Add(Entry.Move);
+		Position.MakeMove(Entry.Move);
+	}
+
+	for (int32 i = 0; i < Result.PrincipalVariation.Num(); ++i)
+	{
+		Position.TakeMove();
+	}
+}
+
+bool FChessSlicedSearch::IsLimitReached() const
+{
+	//There is always a move of a completed iteration to report
+	if (Result.Depth == 0)
+	{
+		return false;
+	}
+
+	if (Limits.Nodes > 0 && Nodes >= Limits.Nodes)
+	{
+		return true;
+	}
+
+	return Limits.TimeMs > 0 && (FPlatformTime::Seconds() - StartTime) * 1000.0 >= Limits.TimeMs;
+}
@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChessMove.h"
+#include "ChessMoveList.h"
+#include "ChessMoveOrdering.h"
+#include "ChessPawnTable.h"
+#include "ChessPosition.h"
+#include "ChessSearch.h"
+
+class FChessTranspositionTable;
+
+/*
+ * Iterative deepening alpha-beta search which runs in slices on the calling thread
+ * Nodes are kept on an explicit stack instead of the call stack, so the search can return after any node
+ * and resume later from the same place, for configurations without worker threads
+ *
+ * Simpler than FChessSearch: no pruning, reductions or aspiration windows, ordering and tables are the same
+ * Quiescence nodes are on the same stack, so no slice runs longer than a few nodes past its budget
+ * Tablebases are used as FChessSearch uses them
+ */
+class CHESSCORE_API FChessSlicedSearch
+{
+public:
+
+	static constexpr int32 MaxPly = FChessSearch::MaxPly;
+
+	/**Make search
+	 * @param InTable Transposition table to use, must outlive the search
+	 */
+	explicit FChessSlicedSearch(FChessTranspositionTable& InTable);
+
+	/**Copy the position and prepare the search, no nodes are searched until Step
+	 * @param RootPosition Position to search
+	 * @param InLimits When to stop, time is measured from this call, not the sum of the slices
+	 */
+	void Start(const FChessPosition& RootPosition, const FChessSearchLimits& InLimits);
+
+	/**Search until the budget is spent or the search ends
+	 * @param BudgetMicroseconds Wall time of this slice
+	 * @return True if the search is finished
+	 */
+	bool Step(int32 BudgetMicroseconds);
+
+	//Abandon the search, the result found so far stays available
+	void Stop();
+
+	bool IsRunning() const { return bRunning; }
+
+	/**Best result so far, can be read at any time
+	 * Depth is the last completed iteration, the move and score may come from the running one,
+	 * as soon as it finds a better move at the root
+	 */
+	const FChessSearchResult& GetResult() const { return Result; }
+
+private:
+
+	//Node on the explicit stack, one per ply
+	struct FFrame
+	{
+		int32 Alpha = 0;
+		int32 Beta = 0;
+		int32 OriginalAlpha = 0;
+		int32 Depth = 0;
+		int32 BestScore = 0;
+		FChessMove BestMove;
+
+		//Static evaluation stored to the table with the node, zero in check
+		int32 StaticEval = 0;
+
+		//Only captures, and the stand pat score in BestScore
+		bool bQuiescence = false;
+		bool bInCheck = false;
+
+		//Move made to enter the child node, taken back when the child returns
+		FChessMove CurrentMove;
+
+		FChessMoveList Moves;
+		int32 NextMove = 0;
+
+		//Quiet moves which didn't cut off, for FChessMoveOrdering::UpdateCutoff
+		FChessMove TriedQuiets[64];
+		int32 TriedQuietCount = 0;
+	};
+
+	//Push the node searched by the parent with the move just made, or the root
+	void PushNode(int32 Alpha, int32 Beta, int32 Depth);
+
+	/**Set up the node on top of the stack
+	 * @param OutScore Score if the node is resolved without searching moves (table cutoff, draw, stand pat)
+	 * @return True if resolved
+	 */
+	bool EnterNode(int32& OutScore);
+
+	//Node on top is done, pop it and pass the score to the parent
+	void LeaveNode(int32 Score);
+
+	//Search the next move of the node on top, or leave it if there are none
+	void AdvanceNode();
+
+	//Root node returned, the iteration is complete
+	void CompleteIteration(int32 Score);
+
+	//Best line from the transposition table moves
+	void ExtractPrincipalVariation(int32 MaxLength);
+
+	//Stop the iteration when any limit is reached
+	bool IsLimitReached() const;
+
+	FChessPosition RootPosition;
+	FChessPosition Position;
+	FChessTranspositionTable& Table;
+
+	//Shared tablebases, probed in the tree
+	const FChessTablebase& Tablebase;
+
+	FChessSearchLimits Limits;
+	double StartTime = 0.0;
+	uint64 Nodes = 0;
+
+	FChessMoveOrdering Ordering;
+	FChessPawnTable PawnTable;
+
+	//Explicit stack, Stack[Ply] is the node at that ply, Top is the count of nodes in use
+	TArray<FFrame> Stack;
+	int32 Top = 0;
+
+	//Score returned by the last popped node, read by its parent
+	int32 ReturnedScore = 0;
+
+	//Depth of the running iteration
+	int32 IterationDepth = 0;
+
+	bool bRunning = false;
+
+	FChessSearchResult Result;
+};
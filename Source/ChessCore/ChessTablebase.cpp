@@ -0,0 +1,1596 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChessTablebase.h"
+#include "Async/MappedFileHandle.h"
+#include "ChessBitboards.h"
+#include "ChessMoveList.h"
+#include "ChessPosition.h"
+#include "ChessZobrist.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogChessTablebase, Log, All);
+
+namespace
+{
+	TAutoConsoleVariable<FString> CVarChessSyzygyPath(
+		TEXT("chess.SyzygyPath"),
+		TEXT(""),
+		TEXT("Directory of the Syzygy tablebase files (.rtbw, .rtbz), empty for Content/Syzygy.\n")
+		TEXT("Read on the first probe."),
+		ECVF_Default
+	);
+
+	constexpr int32 MaxTablePieces = FChessTablebase::MaxTablePieces;
+
+	//First bytes of WDL and DTZ files
+	const uint8 FileMagics[2][4] = { { 0x71, 0xE8, 0x23, 0x5D }, { 0xD7, 0x66, 0x0C, 0xA5 } };
+
+	const TCHAR* const FileExtensions[2] = { TEXT(".rtbw"), TEXT(".rtbz") };
+
+	//Flags of the file header
+	const uint8 HeaderHasPawns = 2;
+
+	//Flags of one table in the file, all but SingleValue are used by DTZ files only
+	enum ETableFlags : uint8
+	{
+		//Values are stored for black to move
+		FlagBlackToMove = 1,
+
+		//Values are indices into the value maps, sorted by frequency
+		FlagMapped = 2,
+
+		//Wins and losses are stored in plies, otherwise in moves
+		FlagWinPlies = 4,
+		FlagLossPlies = 8,
+
+		//Value maps are 16 bit
+		FlagWideMap = 16,
+
+		//All positions have the same value, stored instead of the compressed data
+		FlagSingleValue = 128
+	};
+
+	//Symbol which isn't a pair of other symbols, in the right half of a tree node
+	const int32 LeafSymbol = 0xFFF;
+
+	//Sizes of the records in the file
+	//
+	const int32 SparseEntrySize = 6;
+	const int32 TreeNodeSize = 3;
+
+	//Counts of leading group placements of pawnless tables, three unique pieces or the two kings
+	const uint64 UniquePiecesPlacements = 31332;
+	const uint64 KingsPlacements = 462;
+
+	//Numbers in the file headers are little-endian
+	FORCEINLINE uint32 ReadLittleEndian(const uint8* Data, int32 Size)
+	{
+		uint32 Value = 0;
+		for (int32 i = Size - 1; i >= 0; --i)
+		{
+			Value = (Value << 8) | Data[i];
+		}
+		return Value;
+	}
+
+	//Compressed data is read big-endian
+	FORCEINLINE uint64 ReadBigEndian(const uint8* Data, int32 Size)
+	{
+		uint64 Value = 0;
+		for (int32 i = 0; i < Size; ++i)
+		{
+			Value = (Value << 8) | Data[i];
+		}
+		return Value;
+	}
+
+	//Square helpers, squares are rank * 8 + file in the files too
+	//
+	FORCEINLINE int32 GetFile(int32 Square) { return Square & 7; }
+	FORCEINLINE int32 GetRank(int32 Square) { return Square >> 3; }
+	FORCEINLINE int32 FlipFile(int32 Square) { return Square ^ 7; }
+	FORCEINLINE int32 FlipRank(int32 Square) { return Square ^ 56; }
+	FORCEINLINE int32 FlipDiagonal(int32 Square) { return ((Square >> 3) | (Square << 3)) & 63; }
+
+	//Distance from the a1-h8 diagonal, negative below it
+	FORCEINLINE int32 GetDiagonalOffset(int32 Square) { return GetRank(Square) - GetFile(Square); }
+
+	//Piece codes of the files: white pawn..king 1..6, black pawn..king 9..14, so the color is flipped by XOR 8
+	FORCEINLINE int32 ToTablePiece(int32 Code) { return Code > 6 ? Code + 2 : Code; }
+
+	FORCEINLINE bool IsTablePawn(int32 TablePiece) { return (TablePiece & 7) == 1; }
+
+	//Piece type 1..6 of the letter in file names, 0 if it isn't a piece
+	int32 GetPieceType(TCHAR Letter)
+	{
+		switch (Letter)
+		{
+		case TEXT('P'): return 1;
+		case TEXT('N'): return 2;
+		case TEXT('B'): return 3;
+		case TEXT('R'): return 4;
+		case TEXT('Q'): return 5;
+		case TEXT('K'): return 6;
+		default: return 0;
+		}
+	}
+
+	int32 GetSign(int32 Value)
+	{
+		return (Value > 0) - (Value < 0);
+	}
+
+	//Distance of the move before a capture or pawn move, DTZ files don't store them
+	int32 GetDtzBeforeZeroing(EChessWdl Wdl)
+	{
+		switch (Wdl)
+		{
+		case EChessWdl::Win: return 1;
+		case EChessWdl::CursedWin: return 101;
+		case EChessWdl::BlessedLoss: return -101;
+		case EChessWdl::Loss: return -1;
+		default: return 0;
+		}
+	}
+
+	/*
+	 * Tables which map squares to indices of the position encoding, shared by all files
+	 * Pawnless positions are mirrored so the leading piece is in the a1-d1-d4 triangle,
+	 * positions with pawns so the leading pawn is on the a-d files
+	 */
+	struct FIndexTables
+	{
+		//Squares a2-h7 to 0..47, the leading pawn is the one with the highest value:
+		//nearest to the edge and, on the same file, with the lowest rank
+		int32 MapPawns[64] = {};
+
+		//Squares below the a1-h8 diagonal to 0..27
+		int32 MapB1H1H7[64] = {};
+
+		//Squares of the a1-d1-d4 triangle to 0..9, diagonal squares last
+		int32 MapA1D1D4[64] = {};
+
+		//Placements of two kings with the first one in the a1-d1-d4 triangle to 0..461
+		int32 MapKK[10][64] = {};
+
+		//Binomial[K][N] ways to pick K of N squares
+		uint64 Binomial[MaxTablePieces][64] = {};
+
+		//Index of the first placement of the leading pawns with the leading one on the square
+		int32 LeadPawnIndex[MaxTablePieces][64] = {};
+
+		//Placements of the leading pawns by the leading pawn file a-d
+		int32 LeadPawnsSize[MaxTablePieces][4] = {};
+
+		FIndexTables()
+		{
+			int32 Code = 0;
+			for (int32 Square = 0; Square < 64; ++Square)
+			{
+				if (GetDiagonalOffset(Square) < 0)
+				{
+					MapB1H1H7[Square] = Code++;
+				}
+			}
+
+			TArray<int32> Diagonal;
+			Code = 0;
+			for (int32 Rank = 0; Rank < 4; ++Rank)
+			{
+				for (int32 File = 0; File < 4; ++File)
+				{
+					const int32 Square = Rank * 8 + File;
+
+					if (GetDiagonalOffset(Square) < 0)
+					{
+						MapA1D1D4[Square] = Code++;
+					}
+					else if (GetDiagonalOffset(Square) == 0)
+					{
+						Diagonal.Add(Square);
+					}
+				}
+			}
+
+			for (int32 Square : Diagonal)
+			{
+				MapA1D1D4[Square] = Code++;
+			}
+
+			//Kings can't stand next to each other, when the first one is on the diagonal the second one isn't above it,
+			//placements with both kings on the diagonal come last
+			TArray<TPair<int32, int32>> BothOnDiagonal;
+			Code = 0;
+			for (int32 Index = 0; Index < 10; ++Index)
+			{
+				for (int32 First = 0; First < 28; ++First)
+				{
+					//Squares outside the triangle are mapped to 0 too, b1 is the one really mapped to it
+					if (MapA1D1D4[First] != Index || (Index == 0 && First != 1))
+					{
+						continue;
+					}
+
+					for (int32 Second = 0; Second < 64; ++Second)
+					{
+						if (First == Second || (FChessBitboards::GetKingAttacks(First) & FChessBitboards::SquareBit(Second)))
+						{
+							continue;
+						}
+
+						if (GetDiagonalOffset(First) == 0 && GetDiagonalOffset(Second) > 0)
+						{
+							continue;
+						}
+
+						if (GetDiagonalOffset(First) == 0 && GetDiagonalOffset(Second) == 0)
+						{
+							BothOnDiagonal.Add(MakeTuple(Index, Second));
+						}
+						else
+						{
+							MapKK[Index][Second] = Code++;
+						}
+					}
+				}
+			}
+
+			for (const TPair<int32, int32>& Placement : BothOnDiagonal)
+			{
+				MapKK[Placement.Key][Placement.Value] = Code++;
+			}
+
+			check(Code == static_cast<int32>(KingsPlacements));
+
+			//Pascal's triangle
+			Binomial[0][0] = 1;
+			for (int32 N = 1; N < 64; ++N)
+			{
+				for (int32 K = 0; K < MaxTablePieces && K <= N; ++K)
+				{
+					Binomial[K][N] = (K > 0 ? Binomial[K - 1][N - 1] : 0) + (K < N ? Binomial[K][N - 1] : 0);
+				}
+			}
+
+			//Every rank the leading pawn goes up leaves two squares (both edges) to the other pawns
+			int32 AvailableSquares = 47;
+			for (int32 LeadPawnCount = 1; LeadPawnCount < MaxTablePieces - 1; ++LeadPawnCount)
+			{
+				for (int32 File = 0; File < 4; ++File)
+				{
+					int32 Index = 0;
+					for (int32 Rank = 1; Rank < 7; ++Rank)
+					{
+						const int32 Square = Rank * 8 + File;
+
+						if (LeadPawnCount == 1)
+						{
+							MapPawns[Square] = AvailableSquares--;
+							MapPawns[FlipFile(Square)] = AvailableSquares--;
+						}
+
+						LeadPawnIndex[LeadPawnCount][Square] = Index;
+						Index += static_cast<int32>(Binomial[LeadPawnCount - 1][MapPawns[Square]]);
+					}
+
+					LeadPawnsSize[LeadPawnCount][File] = Index;
+				}
+			}
+		}
+	};
+
+	const FIndexTables& GetIndexTables()
+	{
+		static const FIndexTables Tables;
+		return Tables;
+	}
+
+	//Sort few squares, stable, by the key of every square
+	template <typename KeyType>
+	void SortSquares(int32* Squares, int32 Count, KeyType Key)
+	{
+		for (int32 i = 1; i < Count; ++i)
+		{
+			const int32 Square = Squares[i];
+
+			int32 j = i;
+			for (; j > 0 && Key(Squares[j - 1]) > Key(Square); --j)
+			{
+				Squares[j] = Squares[j - 1];
+			}
+
+			Squares[j] = Square;
+		}
+	}
+
+	/*
+	 * One compressed table of a file, there are two for WDL files of asymmetric material (white and black to move)
+	 * and four times as many for materials with pawns (leading pawn on the a, b, c or d file)
+	 *
+	 * Values are compressed by Recursive Pairing: every symbol is a value or a pair of symbols,
+	 * symbols are stored as canonical Huffman codes in blocks of BlockSize bytes
+	 */
+	struct FPairsData
+	{
+		uint8 Flags = 0;
+
+		uint64 BlockSize = 0;
+
+		//Every Span values there is a sparse index entry
+		uint64 Span = 0;
+
+		int32 BlockCount = 0;
+
+		//Huffman code lengths in bits
+		//
+		int32 MaxSymbolLength = 0;
+		int32 MinSymbolLength = 0;
+
+		//Lowest symbol of every code length, 16 bit
+		const uint8* LowestSymbols = nullptr;
+
+		//Left and right symbols of every pair, 12 bit each
+		const uint8* Tree = nullptr;
+
+		//Count of values minus one of every block, 16 bit
+		const uint8* BlockLengths = nullptr;
+		int32 BlockLengthCount = 0;
+
+		//Block and offset of the value at every Span / 2 + k * Span index
+		const uint8* SparseIndex = nullptr;
+		uint64 SparseIndexCount = 0;
+
+		const uint8* Blocks = nullptr;
+
+		//Lowest code of every length, left aligned in 64 bits
+		TArray<uint64> Base64;
+
+		//Count of values minus one of every symbol
+		TArray<uint8> SymbolLengths;
+
+		//Pieces in the encoding order, which defines the groups
+		uint8 Pieces[MaxTablePieces] = {};
+
+		//Multiplier of every group index, the one after the last group is the table size
+		uint64 GroupIndex[MaxTablePieces + 1] = {};
+
+		//Pieces of every group, zero terminated
+		int32 GroupLength[MaxTablePieces + 1] = {};
+
+		//Offsets of the DTZ value maps of wins, losses, cursed wins and blessed losses
+		uint16 DtzMapIndex[4] = {};
+
+		int32 GetLeft(int32 Symbol) const
+		{
+			const uint8* Node = Tree + Symbol * TreeNodeSize;
+			return ((Node[1] & 0xF) << 8) | Node[0];
+		}
+
+		int32 GetRight(int32 Symbol) const
+		{
+			const uint8* Node = Tree + Symbol * TreeNodeSize;
+			return (Node[2] << 4) | (Node[1] >> 4);
+		}
+
+		int32 GetBlockLength(uint32 Block) const
+		{
+			return static_cast<int32>(ReadLittleEndian(BlockLengths + Block * 2, 2));
+		}
+
+		int32 GetLowestSymbol(int32 Length) const
+		{
+			return static_cast<int32>(ReadLittleEndian(LowestSymbols + Length * 2, 2));
+		}
+	};
+
+	/**Split the pieces into groups and compute group multipliers
+	 * A group is pieces of one kind, but the first group which is the leading pawns, three unique pieces or the kings
+	 * @param Order Position of the leading group and of the other side pawns among the groups, 0xF if there aren't any
+	 * @param File Leading pawn file
+	 */
+	void SetGroups(FPairsData& Data, const int32 (&Order)[2], int32 File, int32 PieceCount, bool bHasPawns, bool bHasUniquePieces, bool bBothSidesPawns)
+	{
+		const FIndexTables& IndexTables = GetIndexTables();
+
+		int32 Groups = 0;
+		int32 FirstLength = bHasPawns ? 0 : (bHasUniquePieces ? 3 : 2);
+		Data.GroupLength[Groups] = 1;
+
+		for (int32 i = 1; i < PieceCount; ++i)
+		{
+			if (--FirstLength > 0 || Data.Pieces[i] == Data.Pieces[i - 1])
+			{
+				++Data.GroupLength[Groups];
+			}
+			else
+			{
+				Data.GroupLength[++Groups] = 1;
+			}
+		}
+
+		Data.GroupLength[++Groups] = 0;
+
+		//Groups are encoded as G1 * N(G2) * N(G3) + G2 * N(G3) + G3, in the order stored in the file
+		int32 Next = bBothSidesPawns ? 2 : 1;
+		int32 FreeSquares = 64 - Data.GroupLength[0] - (bBothSidesPawns ? Data.GroupLength[1] : 0);
+		uint64 Index = 1;
+
+		for (int32 k = 0; Next < Groups || k == Order[0] || k == Order[1]; ++k)
+		{
+			if (k == Order[0])
+			{
+				Data.GroupIndex[0] = Index;
+				Index *= bHasPawns
+					? IndexTables.LeadPawnsSize[Data.GroupLength[0]][File]
+					: (bHasUniquePieces ? UniquePiecesPlacements : KingsPlacements);
+			}
+			else if (k == Order[1])
+			{
+				Data.GroupIndex[1] = Index;
+				Index *= IndexTables.Binomial[Data.GroupLength[1]][48 - Data.GroupLength[0]];
+			}
+			else
+			{
+				Data.GroupIndex[Next] = Index;
+				Index *= IndexTables.Binomial[Data.GroupLength[Next]][FreeSquares];
+				FreeSquares -= Data.GroupLength[Next++];
+			}
+		}
+
+		Data.GroupIndex[Groups] = Index;
+	}
+
+	//Count of values of the symbol, pairs are expanded recursively, the tree is acyclic
+	uint8 SetSymbolLength(FPairsData& Data, int32 Symbol, TArray<bool>& Visited)
+	{
+		Visited[Symbol] = true;
+
+		const int32 Right = Data.GetRight(Symbol);
+		if (Right == LeafSymbol)
+		{
+			return 0;
+		}
+
+		const int32 Left = Data.GetLeft(Symbol);
+
+		if (!Visited[Left])
+		{
+			Data.SymbolLengths[Left] = SetSymbolLength(Data, Left, Visited);
+		}
+
+		if (!Visited[Right])
+		{
+			Data.SymbolLengths[Right] = SetSymbolLength(Data, Right, Visited);
+		}
+
+		return Data.SymbolLengths[Left] + Data.SymbolLengths[Right] + 1;
+	}
+
+	/**Read the sizes and the Huffman code of one table, SetGroups must be called first
+	 * @return Data after the table header, null if the header is corrupted
+	 */
+	const uint8* SetSizes(FPairsData& Data, const uint8* Cursor)
+	{
+		Data.Flags = *Cursor++;
+
+		if (Data.Flags & FlagSingleValue)
+		{
+			//The value is stored in place of the symbol length
+			Data.MinSymbolLength = *Cursor++;
+			return Cursor;
+		}
+
+		int32 Groups = 0;
+		while (Data.GroupLength[Groups] != 0)
+		{
+			++Groups;
+		}
+
+		const uint64 TableSize = Data.GroupIndex[Groups];
+
+		Data.BlockSize = 1ull << *Cursor++;
+		Data.Span = 1ull << *Cursor++;
+		Data.SparseIndexCount = (TableSize + Data.Span - 1) / Data.Span;
+
+		//Block lengths are padded, so the sparse index never points past them
+		const int32 Padding = *Cursor++;
+		Data.BlockCount = static_cast<int32>(ReadLittleEndian(Cursor, 4));
+		Cursor += 4;
+		Data.BlockLengthCount = Data.BlockCount + Padding;
+
+		Data.MaxSymbolLength = *Cursor++;
+		Data.MinSymbolLength = *Cursor++;
+
+		if (Data.MinSymbolLength < 1 || Data.MaxSymbolLength < Data.MinSymbolLength || Data.MaxSymbolLength >= 64)
+		{
+			return nullptr;
+		}
+
+		Data.LowestSymbols = Cursor;
+
+		//Longer codes have lower values (canonical code), so Base64 decreases with the length
+		//and a code of length L left aligned in 64 bits is between Base64[L - 1] and Base64[L]
+		const int32 Lengths = Data.MaxSymbolLength - Data.MinSymbolLength + 1;
+		Data.Base64.SetNumZeroed(Lengths);
+
+		for (int32 i = Lengths - 2; i >= 0; --i)
+		{
+			Data.Base64[i] = (Data.Base64[i + 1] + Data.GetLowestSymbol(i) - Data.GetLowestSymbol(i + 1)) / 2;
+		}
+
+		for (int32 i = 0; i < Lengths; ++i)
+		{
+			Data.Base64[i] <<= 64 - i - Data.MinSymbolLength;
+		}
+
+		Cursor += Lengths * 2;
+
+		const int32 SymbolCount = static_cast<int32>(ReadLittleEndian(Cursor, 2));
+		Cursor += 2;
+
+		Data.Tree = Cursor;
+		Data.SymbolLengths.SetNumZeroed(SymbolCount);
+
+		for (int32 Symbol = 0; Symbol < SymbolCount; ++Symbol)
+		{
+			const int32 Right = Data.GetRight(Symbol);
+			if (Right != LeafSymbol && (Right >= SymbolCount || Data.GetLeft(Symbol) >= SymbolCount))
+			{
+				return nullptr;
+			}
+		}
+
+		TArray<bool> Visited;
+		Visited.SetNumZeroed(SymbolCount);
+
+		for (int32 Symbol = 0; Symbol < SymbolCount; ++Symbol)
+		{
+			if (!Visited[Symbol])
+			{
+				Data.SymbolLengths[Symbol] = SetSymbolLength(Data, Symbol, Visited);
+			}
+		}
+
+		//Tree is padded to an even size
+		return Cursor + SymbolCount * TreeNodeSize + (SymbolCount & 1);
+	}
+
+	//Stored value of the position with given index
+	int32 DecompressPairs(const FPairsData& Data, uint64 Index)
+	{
+		if (Data.Flags & FlagSingleValue)
+		{
+			return Data.MinSymbolLength;
+		}
+
+		//Sparse index entry K points to the value with index K * Span + Span / 2,
+		//the block is found walking the block lengths from there
+		const uint32 K = static_cast<uint32>(Index / Data.Span);
+		const uint8* Entry = Data.SparseIndex + K * SparseEntrySize;
+
+		uint32 Block = ReadLittleEndian(Entry, 4);
+		int32 Offset = static_cast<int32>(ReadLittleEndian(Entry + 4, 2));
+
+		Offset += static_cast<int32>(Index % Data.Span) - static_cast<int32>(Data.Span / 2);
+
+		while (Offset < 0)
+		{
+			Offset += Data.GetBlockLength(--Block) + 1;
+		}
+
+		while (Offset > Data.GetBlockLength(Block))
+		{
+			Offset -= Data.GetBlockLength(Block++) + 1;
+		}
+
+		//Walk the symbols of the block until the one covering the offset
+		const uint8* Cursor = Data.Blocks + Block * Data.BlockSize;
+
+		uint64 Buffer = ReadBigEndian(Cursor, 8);
+		Cursor += 8;
+		int32 BufferBits = 64;
+
+		uint16 Symbol;
+
+		while (true)
+		{
+			int32 Length = 0;
+			while (Buffer < Data.Base64[Length])
+			{
+				++Length;
+			}
+
+			//Codes of one length are consecutive, as are their symbols
+			Symbol = static_cast<uint16>((Buffer - Data.Base64[Length]) >> (64 - Length - Data.MinSymbolLength));
+			Symbol += static_cast<uint16>(Data.GetLowestSymbol(Length));
+
+			if (Offset < Data.SymbolLengths[Symbol] + 1)
+			{
+				break;
+			}
+
+			Offset -= Data.SymbolLengths[Symbol] + 1;
+
+			Length += Data.MinSymbolLength;
+			Buffer <<= Length;
+			BufferBits -= Length;
+
+			if (BufferBits <= 32)
+			{
+				BufferBits += 32;
+				Buffer |= ReadBigEndian(Cursor, 4) << (64 - BufferBits);
+				Cursor += 4;
+			}
+		}
+
+		//Expand pairs down to the value, values of a pair are the left ones followed by the right ones
+		while (Data.SymbolLengths[Symbol] != 0)
+		{
+			const int32 Left = Data.GetLeft(Symbol);
+
+			if (Offset < Data.SymbolLengths[Left] + 1)
+			{
+				Symbol = static_cast<uint16>(Left);
+			}
+			else
+			{
+				Offset -= Data.SymbolLengths[Left] + 1;
+				Symbol = static_cast<uint16>(Data.GetRight(Symbol));
+			}
+		}
+
+		return Data.GetLeft(Symbol);
+	}
+}
+
+enum class FChessTablebase::EProbeState : uint8
+{
+	Ok,
+
+	//Table is missing
+	Fail,
+
+	//DTZ file stores the other side to move
+	ChangeSide,
+
+	//Best move is a capture or pawn move, the DTZ value isn't stored
+	ZeroingBestMove
+};
+
+struct FChessTablebase::FTable
+{
+	//File name without the extension, stronger side first
+	FString Name;
+
+	//Material keys with the stronger side white and black, equal for symmetric material
+	uint64 Key = 0;
+	uint64 Key2 = 0;
+
+	int32 PieceCount = 0;
+	bool bHasPawns = false;
+
+	//Some piece besides the kings is alone of its kind, pawnless positions then encode three pieces together
+	bool bHasUniquePieces = false;
+
+	//Pawns of the leading color (the side with fewer pawns, if it has any) and of the other one
+	int32 PawnCount[2] = {};
+
+	struct FFile
+	{
+		//Set when the file is mapped or found missing, the data below doesn't change after that
+		FThreadSafeBool bReady;
+
+		TUniquePtr<IMappedFileHandle> MappedFile;
+		TUniquePtr<IMappedFileRegion> MappedRegion;
+
+		//File contents when it can't be mapped
+		TArray<uint8> FileData;
+
+		//Start of the file, null if it's missing or corrupted
+		const uint8* Data = nullptr;
+
+		//Value maps of DTZ files
+		const uint8* DtzMap = nullptr;
+
+		//By side to move and leading pawn file
+		FPairsData Items[2][4];
+	};
+
+	FFile Files[FileTypeCount];
+
+	//WDL files of asymmetric material store both sides to move, DTZ files only one
+	FPairsData& GetItem(EFileType Type, int32 Side, int32 PawnFile)
+	{
+		return Files[Type].Items[Type == WdlFile ? Side : 0][bHasPawns ? PawnFile : 0];
+	}
+
+	const FPairsData& GetItem(EFileType Type, int32 Side, int32 PawnFile) const
+	{
+		return Files[Type].Items[Type == WdlFile ? Side : 0][bHasPawns ? PawnFile : 0];
+	}
+
+	/**Set up the decoding data of the mapped file
+	 * @return False if the file doesn't match the material or is shorter than its tables
+	 */
+	bool Parse(EFileType Type, int64 Size);
+
+	//Value of the position, see FChessTablebase::ProbeTable
+	int32 Probe(const FChessPosition& Position, EFileType Type, EChessWdl Wdl, EProbeState& OutState) const;
+
+	//Decoded DTZ value in plies, DTZ files store values by result
+	int32 MapScore(EFileType Type, int32 PawnFile, int32 Value, EChessWdl Wdl) const;
+};
+
+bool FChessTablebase::FTable::Parse(EFileType Type, int64 Size)
+{
+	FFile& File = Files[Type];
+
+	const uint8* const Start = File.Data;
+	const uint8* Data = Start + 4;
+
+	if (((*Data & HeaderHasPawns) != 0) != bHasPawns)
+	{
+		return false;
+	}
+
+	++Data;
+
+	const int32 Sides = Type == WdlFile && Key != Key2 ? 2 : 1;
+	const int32 MaxFile = bHasPawns ? 3 : 0;
+	const bool bBothSidesPawns = bHasPawns && PawnCount[1] > 0;
+
+	for (int32 PawnFile = 0; PawnFile <= MaxFile; ++PawnFile)
+	{
+		for (int32 Side = 0; Side < Sides; ++Side)
+		{
+			GetItem(Type, Side, PawnFile) = FPairsData();
+		}
+
+		//Low nibbles are for white to move, high ones for black
+		const int32 Order[2][2] = {
+			{ Data[0] & 0xF, bBothSidesPawns ? Data[1] & 0xF : 0xF },
+			{ Data[0] >> 4, bBothSidesPawns ? Data[1] >> 4 : 0xF }
+		};
+		Data += bBothSidesPawns ? 2 : 1;
+
+		for (int32 k = 0; k < PieceCount; ++k, ++Data)
+		{
+			for (int32 Side = 0; Side < Sides; ++Side)
+			{
+				GetItem(Type, Side, PawnFile).Pieces[k] = Side ? *Data >> 4 : *Data & 0xF;
+			}
+		}
+
+		for (int32 Side = 0; Side < Sides; ++Side)
+		{
+			SetGroups(GetItem(Type, Side, PawnFile), Order[Side], PawnFile, PieceCount, bHasPawns, bHasUniquePieces, bBothSidesPawns);
+		}
+	}
+
+	//Offsets are aligned from the start of the file, which is page aligned when mapped
+	Data += (Data - Start) & 1;
+
+	for (int32 PawnFile = 0; PawnFile <= MaxFile; ++PawnFile)
+	{
+		for (int32 Side = 0; Side < Sides; ++Side)
+		{
+			Data = SetSizes(GetItem(Type, Side, PawnFile), Data);
+
+			if (!Data || Data - Start > Size)
+			{
+				return false;
+			}
+		}
+	}
+
+	if (Type == DtzFile)
+	{
+		File.DtzMap = Data;
+
+		for (int32 PawnFile = 0; PawnFile <= MaxFile; ++PawnFile)
+		{
+			FPairsData& Item = GetItem(Type, 0, PawnFile);
+
+			if ((Item.Flags & FlagMapped) == 0)
+			{
+				continue;
+			}
+
+			//Maps of wins, losses, cursed wins and blessed losses, each with its count first
+			if (Item.Flags & FlagWideMap)
+			{
+				Data += (Data - Start) & 1;
+
+				for (int32 i = 0; i < 4; ++i)
+				{
+					Item.DtzMapIndex[i] = static_cast<uint16>((Data - File.DtzMap) / 2 + 1);
+					Data += 2 * ReadLittleEndian(Data, 2) + 2;
+				}
+			}
+			else
+			{
+				for (int32 i = 0; i < 4; ++i)
+				{
+					Item.DtzMapIndex[i] = static_cast<uint16>(Data - File.DtzMap + 1);
+					Data += *Data + 1;
+				}
+			}
+		}
+
+		Data += (Data - Start) & 1;
+	}
+
+	for (int32 PawnFile = 0; PawnFile <= MaxFile; ++PawnFile)
+	{
+		for (int32 Side = 0; Side < Sides; ++Side)
+		{
+			FPairsData& Item = GetItem(Type, Side, PawnFile);
+			Item.SparseIndex = Data;
+			Data += Item.SparseIndexCount * SparseEntrySize;
+		}
+	}
+
+	for (int32 PawnFile = 0; PawnFile <= MaxFile; ++PawnFile)
+	{
+		for (int32 Side = 0; Side < Sides; ++Side)
+		{
+			FPairsData& Item = GetItem(Type, Side, PawnFile);
+			Item.BlockLengths = Data;
+			Data += Item.BlockLengthCount * 2;
+		}
+	}
+
+	//Blocks are aligned to cache lines
+	for (int32 PawnFile = 0; PawnFile <= MaxFile; ++PawnFile)
+	{
+		for (int32 Side = 0; Side < Sides; ++Side)
+		{
+			FPairsData& Item = GetItem(Type, Side, PawnFile);
+			Data = Start + Align(Data - Start, 64);
+			Item.Blocks = Data;
+			Data += Item.BlockCount * Item.BlockSize;
+		}
+	}
+
+	return Data - Start <= Size;
+}
+
+int32 FChessTablebase::FTable::Probe(const FChessPosition& Position, EFileType Type, EChessWdl Wdl, EProbeState& OutState) const
+{
+	const FIndexTables& IndexTables = GetIndexTables();
+
+	int32 Squares[MaxTablePieces];
+	int32 Pieces[MaxTablePieces];
+	int32 Size = 0;
+
+	//Tables are stored with the stronger side white, and symmetric material only with white to move,
+	//other positions are looked up with the colors swapped and the board flipped
+	const bool bBlackToMove = Position.GetSide() == EPieceColor::Black;
+	const bool bFlip = (Key == Key2 && bBlackToMove) || Position.GetMaterialHashKey() != Key;
+
+	const int32 FlipColor = bFlip ? 8 : 0;
+	const int32 FlipSquares = bFlip ? 56 : 0;
+	const int32 Side = bFlip != bBlackToMove ? 1 : 0;
+
+	uint64 LeadPawns = 0;
+	int32 LeadPawnCount = 0;
+	int32 PawnFile = 0;
+
+	//Pawns of the leading color come first in every table, the leading pawn file picks the table
+	if (bHasPawns)
+	{
+		const int32 LeadPawn = GetItem(Type, 0, 0).Pieces[0] ^ FlipColor;
+		checkSlow(IsTablePawn(LeadPawn));
+
+		LeadPawns = Position.GetPieceBitboard(LeadPawn < 8 ? GWhitePawn : GBlackPawn);
+
+		uint64 Bits = LeadPawns;
+		while (Bits)
+		{
+			Squares[Size++] = FChessBitboards::PopLsb(Bits) ^ FlipSquares;
+		}
+
+		LeadPawnCount = Size;
+
+		int32 Lead = 0;
+		for (int32 i = 1; i < LeadPawnCount; ++i)
+		{
+			if (IndexTables.MapPawns[Squares[i]] > IndexTables.MapPawns[Squares[Lead]])
+			{
+				Lead = i;
+			}
+		}
+
+		Swap(Squares[0], Squares[Lead]);
+
+		PawnFile = FMath::Min(GetFile(Squares[0]), 7 - GetFile(Squares[0]));
+	}
+
+	//DTZ files store one side to move, symmetric pawnless material any side
+	if (Type == DtzFile)
+	{
+		const int32 StoredSide = (GetItem(Type, 0, PawnFile).Flags & FlagBlackToMove) ? 1 : 0;
+
+		if (StoredSide != Side && (Key != Key2 || bHasPawns))
+		{
+			OutState = EProbeState::ChangeSide;
+			return 0;
+		}
+	}
+
+	uint64 Bits = Position.GetOccupancy(EPieceColor::Both) ^ LeadPawns;
+	while (Bits)
+	{
+		const int32 Square = FChessBitboards::PopLsb(Bits);
+		Squares[Size] = Square ^ FlipSquares;
+		Pieces[Size++] = ToTablePiece(Position.GetPieceAt(Square).GetCode()) ^ FlipColor;
+	}
+
+	checkSlow(Size == PieceCount);
+
+	const FPairsData& Data = GetItem(Type, Side, PawnFile);
+
+	//Reorder the pieces to the encoding order of the table
+	for (int32 i = LeadPawnCount; i < Size - 1; ++i)
+	{
+		for (int32 j = i + 1; j < Size; ++j)
+		{
+			if (Data.Pieces[i] == Pieces[j])
+			{
+				Swap(Pieces[i], Pieces[j]);
+				Swap(Squares[i], Squares[j]);
+				break;
+			}
+		}
+	}
+
+	//Leading piece goes to the a-d files
+	if (GetFile(Squares[0]) > 3)
+	{
+		for (int32 i = 0; i < Size; ++i)
+		{
+			Squares[i] = FlipFile(Squares[i]);
+		}
+	}
+
+	uint64 Index;
+
+	if (bHasPawns)
+	{
+		Index = IndexTables.LeadPawnIndex[LeadPawnCount][Squares[0]];
+
+		SortSquares(Squares + 1, LeadPawnCount - 1, [&IndexTables](int32 Square) { return IndexTables.MapPawns[Square]; });
+
+		for (int32 i = 1; i < LeadPawnCount; ++i)
+		{
+			Index += IndexTables.Binomial[i][IndexTables.MapPawns[Squares[i]]];
+		}
+	}
+	else
+	{
+		//Leading piece goes below the fifth rank, then below the a1-h8 diagonal,
+		//the first piece of the leading group off the diagonal decides the diagonal flip
+		if (GetRank(Squares[0]) > 3)
+		{
+			for (int32 i = 0; i < Size; ++i)
+			{
+				Squares[i] = FlipRank(Squares[i]);
+			}
+		}
+
+		for (int32 i = 0; i < Data.GroupLength[0]; ++i)
+		{
+			if (GetDiagonalOffset(Squares[i]) == 0)
+			{
+				continue;
+			}
+
+			if (GetDiagonalOffset(Squares[i]) > 0)
+			{
+				for (int32 j = i; j < Size; ++j)
+				{
+					Squares[j] = FlipDiagonal(Squares[j]);
+				}
+			}
+
+			break;
+		}
+
+		if (bHasUniquePieces)
+		{
+			//Three pieces together: the first one in the triangle, the others on the 63 and 62 squares left,
+			//placements on the diagonal are encoded after the ones below it
+			const int32 Adjust1 = Squares[1] > Squares[0];
+			const int32 Adjust2 = (Squares[2] > Squares[0]) + (Squares[2] > Squares[1]);
+
+			if (GetDiagonalOffset(Squares[0]))
+			{
+				Index = (IndexTables.MapA1D1D4[Squares[0]] * 63 + (Squares[1] - Adjust1)) * 62
+					+ Squares[2] - Adjust2;
+			}
+			else if (GetDiagonalOffset(Squares[1]))
+			{
+				Index = (6 * 63 + GetRank(Squares[0]) * 28 + IndexTables.MapB1H1H7[Squares[1]]) * 62
+					+ Squares[2] - Adjust2;
+			}
+			else if (GetDiagonalOffset(Squares[2]))
+			{
+				Index = 6 * 63 * 62 + 4 * 28 * 62
+					+ GetRank(Squares[0]) * 7 * 28
+					+ (GetRank(Squares[1]) - Adjust1) * 28
+					+ IndexTables.MapB1H1H7[Squares[2]];
+			}
+			else
+			{
+				Index = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28
+					+ GetRank(Squares[0]) * 7 * 6
+					+ (GetRank(Squares[1]) - Adjust1) * 6
+					+ (GetRank(Squares[2]) - Adjust2);
+			}
+		}
+		else
+		{
+			Index = IndexTables.MapKK[IndexTables.MapA1D1D4[Squares[0]]][Squares[1]];
+		}
+	}
+
+	Index *= Data.GroupIndex[0];
+
+	//Other groups by their sorted squares, squares of the previous groups are skipped,
+	//pawns of the other side can't stand on the first rank
+	int32* GroupSquares = Squares + Data.GroupLength[0];
+	bool bRemainingPawns = bHasPawns && PawnCount[1] > 0;
+
+	for (int32 Group = 1; Data.GroupLength[Group] != 0; ++Group)
+	{
+		const int32 Length = Data.GroupLength[Group];
+		SortSquares(GroupSquares, Length, [](int32 Square) { return Square; });
+
+		uint64 GroupIndex = 0;
+		for (int32 i = 0; i < Length; ++i)
+		{
+			int32 Adjust = 0;
+			for (const int32* Previous = Squares; Previous < GroupSquares; ++Previous)
+			{
+				Adjust += GroupSquares[i] > *Previous;
+			}
+
+			GroupIndex += IndexTables.Binomial[i + 1][GroupSquares[i] - Adjust - (bRemainingPawns ? 8 : 0)];
+		}
+
+		bRemainingPawns = false;
+		Index += GroupIndex * Data.GroupIndex[Group];
+		GroupSquares += Length;
+	}
+
+	return MapScore(Type, PawnFile, DecompressPairs(Data, Index), Wdl);
+}
+
+int32 FChessTablebase::FTable::MapScore(EFileType Type, int32 PawnFile, int32 Value, EChessWdl Wdl) const
+{
+	if (Type == WdlFile)
+	{
+		return Value - 2;
+	}
+
+	//Map index by result: loss, blessed loss, draw, cursed win, win
+	static const int32 WdlMaps[] = { 1, 3, 0, 2, 0 };
+
+	const FPairsData& Data = GetItem(Type, 0, PawnFile);
+	const uint8* Map = Files[Type].DtzMap;
+	const int32 MapIndex = Data.DtzMapIndex[WdlMaps[static_cast<int32>(Wdl) + 2]];
+
+	if (Data.Flags & FlagMapped)
+	{
+		Value = (Data.Flags & FlagWideMap)
+			? static_cast<int32>(ReadLittleEndian(Map + 2 * (MapIndex + Value), 2))
+			: Map[MapIndex + Value];
+	}
+
+	//Values in moves are turned into plies
+	if ((Wdl == EChessWdl::Win && !(Data.Flags & FlagWinPlies))
+		|| (Wdl == EChessWdl::Loss && !(Data.Flags & FlagLossPlies))
+		|| Wdl == EChessWdl::CursedWin
+		|| Wdl == EChessWdl::BlessedLoss)
+	{
+		Value *= 2;
+	}
+
+	return Value + 1;
+}
+
+FChessTablebase::FChessTablebase(const FString& InDirectory)
+{
+	Init(InDirectory);
+}
+
+FChessTablebase::~FChessTablebase() = default;
+
+FChessTablebase& FChessTablebase::Get()
+{
+	//Thread safe static initialization, the directory is scanned once, files are mapped on their first probe
+	static FChessTablebase Tablebase(GetDefaultDirectory());
+	return Tablebase;
+}
+
+FString FChessTablebase::GetDefaultDirectory()
+{
+	const FString Path = CVarChessSyzygyPath.GetValueOnAnyThread();
+	return Path.IsEmpty() ? FPaths::ProjectContentDir() / TEXT("Syzygy") : Path;
+}
+
+int32 FChessTablebase::Init(const FString& InDirectory)
+{
+	Tables.Reset();
+	TableIndices.Reset();
+	MaxPieces = 0;
+	Directory = InDirectory;
+
+	if (Directory.IsEmpty())
+	{
+		return 0;
+	}
+
+	//Every material has a WDL file, DTZ files are optional
+	TArray<FString> FileNames;
+	IFileManager::Get().FindFiles(FileNames, *(Directory / TEXT("*.rtbw")), true, false);
+	FileNames.Sort();
+
+	for (const FString& FileName : FileNames)
+	{
+		AddTable(FPaths::GetBaseFilename(FileName));
+	}
+
+	UE_LOG(LogChessTablebase, Display, TEXT("Found %d tablebases of up to %d pieces in %s"), Tables.Num(), MaxPieces, *Directory);
+	return Tables.Num();
+}
+
+bool FChessTablebase::CanProbe(const FChessPosition& Position) const
+{
+	return MaxPieces > 0
+		&& Position.GetCastlePermission() == 0
+		&& FChessBitboards::PopCount(Position.GetOccupancy(EPieceColor::Both)) <= MaxPieces;
+}
+
+bool FChessTablebase::ProbeWdl(FChessPosition& Position, EChessWdl& OutWdl) const
+{
+	if (!CanProbe(Position))
+	{
+		return false;
+	}
+
+	EProbeState State = EProbeState::Ok;
+	OutWdl = SearchZeroingMoves(Position, false, State);
+
+	return State != EProbeState::Fail;
+}
+
+bool FChessTablebase::ProbeDtz(FChessPosition& Position, int32& OutDtz) const
+{
+	if (!CanProbe(Position))
+	{
+		return false;
+	}
+
+	EProbeState State = EProbeState::Ok;
+	OutDtz = ProbeDtz(Position, State);
+
+	return State != EProbeState::Fail;
+}
+
+bool FChessTablebase::ProbeRoot(FChessPosition& Position, FChessMove& OutMove, EChessWdl& OutWdl, int32& OutDtz) const
+{
+	if (!CanProbe(Position))
+	{
+		return false;
+	}
+
+	const int32 FiftyMoveCounter = Position.GetFiftyMoveCounter();
+
+	FChessMoveList Moves;
+	Position.GenerateMoves(Moves);
+
+	int32 BestRank = MIN_int32;
+
+	for (int32 i = 0; i < Moves.Num(); ++i)
+	{
+		const FChessMove Move = Moves[i];
+		EProbeState State = EProbeState::Ok;
+
+		Position.MakeMove(Move);
+
+		//Distance from the root, a capture or pawn move has the distance of the move before it
+		int32 Dtz;
+		if (Position.GetFiftyMoveCounter() == 0)
+		{
+			Dtz = GetDtzBeforeZeroing(Negate(SearchZeroingMoves(Position, false, State)));
+		}
+		else
+		{
+			Dtz = -ProbeDtz(Position, State);
+			Dtz += GetSign(Dtz);
+		}
+
+		//Mate is the shortest win
+		if (Dtz == 2 && Position.IsCheck())
+		{
+			FChessMoveList Replies;
+			Position.GenerateMoves(Replies);
+
+			if (Replies.Num() == 0)
+			{
+				Dtz = 1;
+			}
+		}
+
+		Position.TakeMove();
+
+		if (State == EProbeState::Fail)
+		{
+			return false;
+		}
+
+		//Wins before the fifty move rule by the shortest distance, then wins after it, draws,
+		//losses the fifty move rule may save and losses by the longest distance
+		int32 Rank;
+		if (Dtz > 0)
+		{
+			Rank = Dtz + FiftyMoveCounter <= 99 ? 2000 - Dtz : FMath::Max(1000 - Dtz - FiftyMoveCounter, 1);
+		}
+		else if (Dtz < 0)
+		{
+			Rank = FiftyMoveCounter - Dtz <= 100 ? -2000 - Dtz : FMath::Min(-1000 - Dtz + FiftyMoveCounter, -1);
+		}
+		else
+		{
+			Rank = 0;
+		}
+
+		if (Rank > BestRank)
+		{
+			BestRank = Rank;
+			OutMove = Move;
+			OutDtz = Dtz;
+		}
+	}
+
+	if (BestRank == MIN_int32)
+	{
+		return false;
+	}
+
+	if (OutDtz > 0)
+	{
+		OutWdl = BestRank >= 1000 ? EChessWdl::Win : EChessWdl::CursedWin;
+	}
+	else if (OutDtz < 0)
+	{
+		OutWdl = BestRank < -1000 ? EChessWdl::Loss : EChessWdl::BlessedLoss;
+	}
+	else
+	{
+		OutWdl = EChessWdl::Draw;
+	}
+
+	return true;
+}
+
+void FChessTablebase::AddTable(const FString& Name)
+{
+	//Piece counts of both sides by type 1..6, the stronger side first
+	int32 Counts[2][7] = {};
+	int32 NameSide = 0;
+	int32 PieceCount = 0;
+
+	for (int32 i = 0; i < Name.Len(); ++i)
+	{
+		if (Name[i] == TEXT('v') && NameSide == 0)
+		{
+			NameSide = 1;
+			continue;
+		}
+
+		const int32 Type = GetPieceType(Name[i]);
+		if (Type == 0)
+		{
+			return;
+		}
+
+		++Counts[NameSide][Type];
+		++PieceCount;
+	}
+
+	if (NameSide != 1 || Counts[0][6] != 1 || Counts[1][6] != 1 || PieceCount > MaxTablePieces)
+	{
+		UE_LOG(LogChessTablebase, Verbose, TEXT("%s isn't a tablebase file name"), *Name);
+		return;
+	}
+
+	TUniquePtr<FTable> Table = MakeUnique<FTable>();
+	Table->Name = Name;
+	Table->PieceCount = PieceCount;
+
+	//Black piece codes follow the white ones
+	for (int32 Type = 1; Type <= 6; ++Type)
+	{
+		for (int32 i = 0; i < Counts[0][Type]; ++i)
+		{
+			Table->Key ^= FChessZobrist::GetMaterialKey(Type, i);
+			Table->Key2 ^= FChessZobrist::GetMaterialKey(Type + 6, i);
+		}
+
+		for (int32 i = 0; i < Counts[1][Type]; ++i)
+		{
+			Table->Key ^= FChessZobrist::GetMaterialKey(Type + 6, i);
+			Table->Key2 ^= FChessZobrist::GetMaterialKey(Type, i);
+		}
+
+		if (Type < 6 && (Counts[0][Type] == 1 || Counts[1][Type] == 1))
+		{
+			Table->bHasUniquePieces = true;
+		}
+	}
+
+	if (TableIndices.Contains(Table->Key))
+	{
+		return;
+	}
+
+	const int32 StrongerPawns = Counts[0][1];
+	const int32 WeakerPawns = Counts[1][1];
+	Table->bHasPawns = StrongerPawns + WeakerPawns > 0;
+
+	//Side with fewer pawns leads, it compresses better
+	const bool bStrongerLeads = WeakerPawns == 0 || (StrongerPawns > 0 && WeakerPawns >= StrongerPawns);
+	Table->PawnCount[0] = bStrongerLeads ? StrongerPawns : WeakerPawns;
+	Table->PawnCount[1] = bStrongerLeads ? WeakerPawns : StrongerPawns;
+
+	const int32 Index = Tables.Add(MoveTemp(Table));
+	TableIndices.Add(Tables[Index]->Key, Index);
+	TableIndices.Add(Tables[Index]->Key2, Index);
+
+	MaxPieces = FMath::Max(MaxPieces, PieceCount);
+}
+
+FChessTablebase::FTable* FChessTablebase::FindTable(uint64 MaterialKey) const
+{
+	const int32* Index = TableIndices.Find(MaterialKey);
+	return Index ? Tables[*Index].Get() : nullptr;
+}
+
+bool FChessTablebase::MapFile(FTable& Table, EFileType Type) const
+{
+	FTable::FFile& File = Table.Files[Type];
+
+	if (File.bReady)
+	{
+		return File.Data != nullptr;
+	}
+
+	FScopeLock Lock(&MapLock);
+
+	//Another thread may have mapped it while this one waited
+	if (File.bReady)
+	{
+		return File.Data != nullptr;
+	}
+
+	const FString Path = Directory / (Table.Name + FileExtensions[Type]);
+	int64 Size = 0;
+
+	File.MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	if (File.MappedFile.IsValid() && File.MappedFile->GetFileSize() > 0)
+	{
+		File.MappedRegion.Reset(File.MappedFile->MapRegion(0, File.MappedFile->GetFileSize()));
+	}
+
+	if (File.MappedRegion.IsValid())
+	{
+		File.Data = File.MappedRegion->GetMappedPtr();
+		Size = File.MappedRegion->GetMappedSize();
+	}
+	else
+	{
+		File.MappedFile.Reset();
+
+		if (FFileHelper::LoadFileToArray(File.FileData, *Path, FILEREAD_Silent))
+		{
+			File.Data = File.FileData.GetData();
+			Size = File.FileData.Num();
+		}
+	}
+
+	if (File.Data)
+	{
+		if (Size < 5 || FMemory::Memcmp(File.Data, FileMagics[Type], 4) != 0 || !Table.Parse(Type, Size))
+		{
+			UE_LOG(LogChessTablebase, Warning, TEXT("Tablebase %s is corrupted"), *Path);
+
+			File.MappedRegion.Reset();
+			File.MappedFile.Reset();
+			File.FileData.Empty();
+			File.Data = nullptr;
+		}
+	}
+	else
+	{
+		UE_LOG(LogChessTablebase, Log, TEXT("Tablebase %s is missing"), *Path);
+	}
+
+	File.bReady = true;
+	return File.Data != nullptr;
+}
+
+int32 FChessTablebase::ProbeTable(const FChessPosition& Position, EFileType Type, EChessWdl Wdl, EProbeState& OutState) const
+{
+	//Bare kings have no file
+	if (FChessBitboards::PopCount(Position.GetOccupancy(EPieceColor::Both)) == 2)
+	{
+		return Type == WdlFile ? static_cast<int32>(EChessWdl::Draw) : 0;
+	}
+
+	FTable* Table = FindTable(Position.GetMaterialHashKey());
+
+	if (!Table || !MapFile(*Table, Type))
+	{
+		OutState = EProbeState::Fail;
+		return 0;
+	}
+
+	return Table->Probe(Position, Type, Wdl, OutState);
+}
+
+EChessWdl FChessTablebase::SearchZeroingMoves(FChessPosition& Position, bool bZeroingMoves, EProbeState& OutState) const
+{
+	FChessMoveList Moves;
+	Position.GenerateMoves(Moves);
+
+	EChessWdl BestValue = EChessWdl::Loss;
+	int32 MoveCount = 0;
+
+	for (int32 i = 0; i < Moves.Num(); ++i)
+	{
+		const FChessMove Move = Moves[i];
+
+		if (!Move.IsCapture() && (!bZeroingMoves || !Position.GetPieceAt(Move.GetFromSquare()).IsA(EChessPieceRole::Pawn)))
+		{
+			continue;
+		}
+
+		++MoveCount;
+
+		Position.MakeMove(Move);
+		const EChessWdl Value = Negate(SearchZeroingMoves(Position, false, OutState));
+		Position.TakeMove();
+
+		if (OutState == EProbeState::Fail)
+		{
+			return EChessWdl::Draw;
+		}
+
+		if (Value > BestValue)
+		{
+			BestValue = Value;
+
+			if (Value >= EChessWdl::Win)
+			{
+				OutState = EProbeState::ZeroingBestMove;
+				return Value;
+			}
+		}
+	}
+
+	//All moves were searched, the table isn't needed (and may be wrong, it doesn't know en passant)
+	const bool bNoMoreMoves = MoveCount > 0 && MoveCount == Moves.Num();
+
+	EChessWdl Value = BestValue;
+
+	if (!bNoMoreMoves)
+	{
+		Value = static_cast<EChessWdl>(ProbeTable(Position, WdlFile, EChessWdl::Draw, OutState));
+
+		if (OutState == EProbeState::Fail)
+		{
+			return EChessWdl::Draw;
+		}
+	}
+
+	//Stored value may be a don't care one where a zeroing move is at least as good
+	if (BestValue >= Value)
+	{
+		OutState = BestValue > EChessWdl::Draw || bNoMoreMoves ? EProbeState::ZeroingBestMove : EProbeState::Ok;
+		return BestValue;
+	}
+
+	OutState = EProbeState::Ok;
+	return Value;
+}
+
+int32 FChessTablebase::ProbeDtz(FChessPosition& Position, EProbeState& OutState) const
+{
+	OutState = EProbeState::Ok;
+
+	const EChessWdl Wdl = SearchZeroingMoves(Position, true, OutState);
+
+	//Draws aren't stored
+	if (OutState == EProbeState::Fail || Wdl == EChessWdl::Draw)
+	{
+		return 0;
+	}
+
+	if (OutState == EProbeState::ZeroingBestMove)
+	{
+		return GetDtzBeforeZeroing(Wdl);
+	}
+
+	int32 Dtz = ProbeTable(Position, DtzFile, Wdl, OutState);
+
+	if (OutState == EProbeState::Fail)
+	{
+		return 0;
+	}
+
+	if (OutState != EProbeState::ChangeSide)
+	{
+		const bool bFiftyMoveRule = Wdl == EChessWdl::CursedWin || Wdl == EChessWdl::BlessedLoss;
+		return (Dtz + (bFiftyMoveRule ? 100 : 0)) * GetSign(static_cast<int32>(Wdl));
+	}
+
+	//File stores the other side to move, the distance is one more than the best reply's
+	const int32 WdlSign = GetSign(static_cast<int32>(Wdl));
+	int32 MinDtz = MAX_int32;
+
+	FChessMoveList Moves;
+	Position.GenerateMoves(Moves);
+
+	for (int32 i = 0; i < Moves.Num(); ++i)
+	{
+		const FChessMove Move = Moves[i];
+		const bool bZeroing = Move.IsCapture() || Position.GetPieceAt(Move.GetFromSquare()).IsA(EChessPieceRole::Pawn);
+
+		Position.MakeMove(Move);
+
+		//Zeroing move has the distance of the move before it, the search after it only gives the result
+		Dtz = bZeroing
+			? -GetDtzBeforeZeroing(SearchZeroingMoves(Position, false, OutState))
+			: -ProbeDtz(Position, OutState);
+
+		if (Dtz == 1 && Position.IsCheck())
+		{
+			FChessMoveList Replies;
+			Position.GenerateMoves(Replies);
+
+			if (Replies.Num() == 0)
+			{
+				MinDtz = 1;
+			}
+		}
+
+		if (!bZeroing)
+		{
+			Dtz += GetSign(Dtz);
+		}
+
+		//Winning side only picks wins, the losing side the longest loss
+		if (Dtz < MinDtz && GetSign(Dtz) == WdlSign)
+		{
+			MinDtz = Dtz;
+		}
+
+		Position.TakeMove();
+
+		if (OutState == EProbeState::Fail)
+		{
+			return 0;
+		}
+	}
+
+	//No legal moves, mated
+	return MinDtz == MAX_int32 ? -1 : MinDtz;
+}
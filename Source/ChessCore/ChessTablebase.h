@@ -0,0 +1,147 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChessMove.h"
+#include "HAL/CriticalSection.h"
+
+class FChessPosition;
+
+//Game theoretical result for the moving side, cursed wins and blessed losses are drawn by the fifty move rule
+enum class EChessWdl : int8
+{
+	Loss = -2,
+	BlessedLoss = -1,
+	Draw = 0,
+	CursedWin = 1,
+	Win = 2
+};
+
+/*
+ * Syzygy endgame tablebases: win/draw/loss (.rtbw) and distance to zeroing move (.rtbz) files
+ * Init only finds the files of a local directory, every file is memory-mapped on its first probe and the mapping
+ * is shared by all threads and searches, so probing allocates nothing and costs a few cache misses
+ *
+ * Tables don't know castling rights, positions which can still castle are never probed
+ * WDL results ignore the fifty move counter, they are exact right after a capture or pawn move
+ * The file format and indexing are the ones of the probing code published with the tables (github.com/syzygy1/tb)
+ */
+class CHESSCORE_API FChessTablebase
+{
+public:
+
+	//Most pieces of a table, kings included
+	static constexpr int32 MaxTablePieces = 7;
+
+	/**Make tablebase
+	 * @param Directory Folder with the table files, empty for none
+	 */
+	explicit FChessTablebase(const FString& Directory = FString());
+	~FChessTablebase();
+
+	FChessTablebase(const FChessTablebase&) = delete;
+	FChessTablebase& operator=(const FChessTablebase&) = delete;
+
+	//Tables shared by all searches, found in the chess.SyzygyPath directory
+	static FChessTablebase& Get();
+
+	//Directory of the shared tables, chess.SyzygyPath or Content/Syzygy when it's empty
+	static FString GetDefaultDirectory();
+
+	/**Find the tables of the directory, tables found before are unmapped, so no search may be probing them
+	 * @param Directory Folder with .rtbw and .rtbz files, file names tell the material (KRPvKR.rtbw), empty for none
+	 * @return Count of WDL tables found
+	 */
+	int32 Init(const FString& Directory);
+
+	const FString& GetDirectory() const { return Directory; }
+
+	int32 GetTableCount() const { return Tables.Num(); }
+
+	//Most pieces of the tables found, zero without tables
+	int32 GetMaxPieces() const { return MaxPieces; }
+
+	//Are there few enough pieces for the tables found, and no castling rights
+	bool CanProbe(const FChessPosition& Position) const;
+
+	/**Win/draw/loss of the position, captures are searched since the tables store don't care values where a capture wins
+	 * @param Position Position to probe, moves are made and taken back, so it's the same on return
+	 * @param OutWdl Result for the moving side, as if the fifty move counter was zero
+	 * @return False if the position can't be probed or its table is missing
+	 */
+	bool ProbeWdl(FChessPosition& Position, EChessWdl& OutWdl) const;
+
+	/**Distance to zeroing move of the position, moves are made and taken back
+	 * @param OutDtz Plies to the next capture or pawn move of the winning side, positive if the moving side wins,
+	 * negative if it loses, zero for draws, above 100 for cursed wins and below -100 for blessed losses
+	 * Files which store full moves instead of plies may give a distance one ply too long
+	 * @return False if the position can't be probed or either of its tables is missing
+	 */
+	bool ProbeDtz(FChessPosition& Position, int32& OutDtz) const;
+
+	/**Best move of the root position by the tables: wins are played by the shortest distance to zeroing move,
+	 * so the win is never given away by the fifty move rule, losses defend the longest
+	 * @param OutMove Best legal move
+	 * @param OutWdl Result after the best move, for the moving side, the fifty move counter of the position is counted in
+	 * @param OutDtz Distance to zeroing move after the best move, for the moving side
+	 * @return False if the position can't be probed, any table is missing or there are no legal moves
+	 */
+	bool ProbeRoot(FChessPosition& Position, FChessMove& OutMove, EChessWdl& OutWdl, int32& OutDtz) const;
+
+	//Negated result is the one of the other side
+	static EChessWdl Negate(EChessWdl Wdl) { return static_cast<EChessWdl>(-static_cast<int32>(Wdl)); }
+
+private:
+
+	//File types of one table
+	enum EFileType
+	{
+		WdlFile,
+		DtzFile,
+		FileTypeCount
+	};
+
+	//Outcome of a probe
+	enum class EProbeState : uint8;
+
+	//Table of one material, both of its files and their decoding data, see the .cpp file
+	struct FTable;
+
+	/**Add the table of the file name
+	 * @param Name File name without the extension, like KRPvKR
+	 */
+	void AddTable(const FString& Name);
+
+	//Table of the position material, null if it wasn't found
+	FTable* FindTable(uint64 MaterialKey) const;
+
+	//Map the file on its first use, thread safe, returns false if the file is missing or corrupted
+	bool MapFile(FTable& Table, EFileType Type) const;
+
+	/**Value stored in the table for the position
+	 * @param Wdl Result of the position, DTZ values are stored by result
+	 * @return WDL result as int32 for WDL files, distance in plies for DTZ files
+	 */
+	int32 ProbeTable(const FChessPosition& Position, EFileType Type, EChessWdl Wdl, EProbeState& OutState) const;
+
+	/**Result with the captures searched (and pawn moves for DTZ), tables store don't care values where they win
+	 * @param bZeroingMoves Search pawn moves too
+	 */
+	EChessWdl SearchZeroingMoves(FChessPosition& Position, bool bZeroingMoves, EProbeState& OutState) const;
+
+	int32 ProbeDtz(FChessPosition& Position, EProbeState& OutState) const;
+
+	//Directory given to Init
+	FString Directory;
+
+	TArray<TUniquePtr<FTable>> Tables;
+
+	//Index into Tables by material key, for both colors of the stronger side
+	TMap<uint64, int32> TableIndices;
+
+	int32 MaxPieces = 0;
+
+	//Files are mapped under it, probes of mapped files don't lock
+	mutable FCriticalSection MapLock;
+};
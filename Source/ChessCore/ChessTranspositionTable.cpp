@@ -0,0 +1,191 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ChessTranspositionTable.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	TAutoConsoleVariable<int32> CVarChessHashSizeMB(
+		TEXT("chess.HashSizeMB"),
+		64,
+		TEXT("Size of the shared transposition table in megabytes.\n")
+		TEXT("Applied when the next search starts."),
+		ECVF_Default
+	);
+
+	//Entry data layout, from the lowest bits:
+	//Move 16, Score 16, Eval 16, Depth 8, Bound 2, Generation 6
+	FORCEINLINE uint64 PackData(const FChessMove& Move, int32 Score, int32 Eval, int32 Depth, EChessBound Bound, uint8 Generation)
+	{
+		return static_cast<uint64>(Move.Raw())
+			| static_cast<uint64>(static_cast<uint16>(Score)) << 16
+			| static_cast<uint64>(static_cast<uint16>(Eval)) << 32
+			| static_cast<uint64>(static_cast<uint8>(Depth)) << 48
+			| static_cast<uint64>(Bound) << 56
+			| static_cast<uint64>(Generation) << 58;
+	}
+
+	FORCEINLINE uint16 GetDataMove(uint64 Data) { return static_cast<uint16>(Data); }
+	FORCEINLINE int32 GetDataDepth(uint64 Data) { return static_cast<int8>(Data >> 48); }
+	FORCEINLINE EChessBound GetDataBound(uint64 Data) { return static_cast<EChessBound>((Data >> 56) & 0x3); }
+	FORCEINLINE uint8 GetDataGeneration(uint64 Data) { return static_cast<uint8>(Data >> 58); }
+
+	const uint8 GenerationMask = 0x3F;
+}
+
+constexpr int32 FChessTranspositionTable::MaxDepth;
+
+FChessTranspositionTable::FChessTranspositionTable(int32 InSizeMB)
+{
+	Resize(InSizeMB);
+}
+
+FChessTranspositionTable::FChessTranspositionTable(int32 InSizeMB, bool bInShared) :
+	bShared(bInShared)
+{
+	Resize(InSizeMB);
+}
+
+FChessTranspositionTable::~FChessTranspositionTable()
+{
+	FMemory::Free(Buckets);
+}
+
+FChessTranspositionTable& FChessTranspositionTable::Get()
+{
+	static FChessTranspositionTable Table(CVarChessHashSizeMB.GetValueOnAnyThread(), true);
+	return Table;
+}
+
+void FChessTranspositionTable::Resize(int32 InSizeMB)
+{
+	SizeMB = FMath::Max(InSizeMB, 1);
+
+	//Power of two count of buckets, so the index is just masked key
+	const uint64 Bytes = static_cast<uint64>(SizeMB) * 1024 * 1024;
+
+	uint64 BucketCount = 1;
+	while (BucketCount * 2 * sizeof(FBucket) <= Bytes)
+	{
+		BucketCount *= 2;
+	}
+
+	FMemory::Free(Buckets);
+	Buckets = static_cast<FBucket*>(FMemory::Malloc(BucketCount * sizeof(FBucket), alignof(FBucket)));
+	BucketMask = BucketCount - 1;
+
+	Clear();
+}
+
+void FChessTranspositionTable::Clear()
+{
+	FMemory::Memzero(Buckets, (BucketMask + 1) * sizeof(FBucket));
+	Generation = 0;
+}
+
+void FChessTranspositionTable::NewSearch()
+{
+	if (bShared && CVarChessHashSizeMB.GetValueOnAnyThread() != SizeMB)
+	{
+		Resize(CVarChessHashSizeMB.GetValueOnAnyThread());
+	}
+
+	Generation = (Generation + 1) & GenerationMask;
+}
+
+bool FChessTranspositionTable::Probe(uint64 Key, FChessTranspositionEntry& OutEntry) const
+{
+	const FBucket& Bucket = Buckets[Key & BucketMask];
+
+	for (const FEntry& Entry : Bucket.Entries)
+	{
+		//Read both words once, other threads may be writing the entry right now
+		const uint64 Data = Entry.Data;
+		const uint64 XorKey = Entry.XorKey;
+
+		if ((XorKey ^ Data) == Key && GetDataBound(Data) != EChessBound::None)
+		{
+			OutEntry.Move = FChessMove::FromRaw(GetDataMove(Data));
+			OutEntry.Score = static_cast<int16>(Data >> 16);
+			OutEntry.Eval = static_cast<int16>(Data >> 32);
+			OutEntry.Depth = GetDataDepth(Data);
+			OutEntry.Bound = GetDataBound(Data);
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void FChessTranspositionTable::Store(uint64 Key, const FChessMove& Move, int32 Score, int32 Eval, int32 Depth, EChessBound Bound)
+{
+	checkSlow(Score == static_cast<int16>(Score) && Eval == static_cast<int16>(Eval));
+
+	//Would read back negative
+	Depth = FMath::Min(Depth, MaxDepth);
+
+	FBucket& Bucket = Buckets[Key & BucketMask];
+
+	//Same position is always overwritten, otherwise the least valuable entry is replaced:
+	//empty one first, then by depth with 8 plies of penalty for each search the entry has lived
+	FEntry* Replace = nullptr;
+	int32 ReplaceValue = MAX_int32;
+
+	for (FEntry& Entry : Bucket.Entries)
+	{
+		const uint64 Data = Entry.Data;
+
+		if ((Entry.XorKey ^ Data) == Key)
+		{
+			//Keep the move of the previous search if this one has no move
+			const FChessMove StoredMove = Move.IsValid() ? Move : FChessMove::FromRaw(GetDataMove(Data));
+
+			//Don't let a shallow non-exact result replace a deeper one of the current search
+			if (Bound != EChessBound::Exact
+				&& GetDataGeneration(Data) == Generation
+				&& Depth + 2 < GetDataDepth(Data))
+			{
+				return;
+			}
+
+			const uint64 NewData = PackData(StoredMove, Score, Eval, Depth, Bound, Generation);
+			Entry.Data = NewData;
+			Entry.XorKey = Key ^ NewData;
+
+			return;
+		}
+
+		const int32 Age = (Generation - GetDataGeneration(Data)) & GenerationMask;
+		const int32 Value = GetDataBound(Data) == EChessBound::None ? MIN_int32 : GetDataDepth(Data) - 8 * Age;
+
+		if (Value < ReplaceValue)
+		{
+			ReplaceValue = Value;
+			Replace = &Entry;
+		}
+	}
+
+	const uint64 NewData = PackData(Move, Score, Eval, Depth, Bound, Generation);
+	Replace->Data = NewData;
+	Replace->XorKey = Key ^ NewData;
+}
+
+int32 FChessTranspositionTable::GetHashfull() const
+{
+	const uint64 SampleBuckets = FMath::Min<uint64>(250, BucketMask + 1);
+	int32 Used = 0;
+
+	for (uint64 i = 0; i < SampleBuckets; ++i)
+	{
+		for (const FEntry& Entry : Buckets[i].Entries)
+		{
+			if (GetDataBound(Entry.Data) != EChessBound::None && GetDataGeneration(Entry.Data) == Generation)
+			{
+				++Used;
+			}
+		}
+	}
+
+	return static_cast<int32>(Used * 1000 / (SampleBuckets * BucketSize));
+}
@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChessMove.h"
+
+//What the stored score tells about the real score of the position
+enum class EChessBound : uint8
+{
+	//Empty entry
+	None,
+
+	//Real score is at most the stored one (fail low)
+	Upper,
+
+	//Real score is at least the stored one (fail high)
+	Lower,
+
+	Exact
+};
+
+//Unpacked entry returned by the probe
+struct FChessTranspositionEntry
+{
+	FChessMove Move;
+	int32 Score = 0;
+	int32 Eval = 0;
+	int32 Depth = 0;
+	EChessBound Bound = EChessBound::None;
+};
+
+/*
+ * Hash table of searched positions, keyed by FChessPosition::GetPosHashKey
+ * One table is shared by all search threads, buckets of 4 entries fill exactly one cache line
+ * Replacement keeps the deepest entries, entries of older searches are replaced first (aging)
+ *
+ * Access is lock-free: every entry stores Key ^ Data next to Data
+ * If another thread tore the entry while writing it, the key check fails and the entry is treated as a miss
+ */
+class CHESSCORE_API FChessTranspositionTable
+{
+public:
+
+	explicit FChessTranspositionTable(int32 InSizeMB = 16);
+	~FChessTranspositionTable();
+
+	FChessTranspositionTable(const FChessTranspositionTable&) = delete;
+	FChessTranspositionTable& operator=(const FChessTranspositionTable&) = delete;
+
+	//Depth is stored in 8 signed bits, deeper results are stored with this depth
+	static constexpr int32 MaxDepth = MAX_int8;
+
+	//Table shared by the search and analysis, sized by chess.HashSizeMB
+	static FChessTranspositionTable& Get();
+
+	/**Reallocate the table, all entries are lost
+	 * @param SizeMB Size in megabytes, rounded down to a power of two count of buckets
+	 */
+	void Resize(int32 SizeMB);
+
+	//Remove all entries
+	void Clear();
+
+	/**Start of a new search, ages entries of the previous ones
+	 * Shared table also picks up chess.HashSizeMB changes here, so it must not be called while any search is running
+	 */
+	void NewSearch();
+
+	/**Find the entry of the position
+	 * @param Key Position hash key
+	 * @param OutEntry Found entry
+	 * @return True if entry was found
+	 */
+	bool Probe(uint64 Key, FChessTranspositionEntry& OutEntry) const;
+
+	/**Store the search result of the position
+	 * @param Key Position hash key
+	 * @param Move Best move found, invalid move keeps the stored one
+	 * @param Score Search score, must fit into 16 bits
+	 * @param Eval Static evaluation, must fit into 16 bits
+	 * @param Depth Remaining search depth, clamped to MaxDepth
+	 * @param Bound Kind of the score
+	 */
+	void Store(uint64 Key, const FChessMove& Move, int32 Score, int32 Eval, int32 Depth, EChessBound Bound);
+
+	//Pull the bucket of the key into cache, so the probe after making a move doesn't stall
+	FORCEINLINE void Prefetch(uint64 Key) const
+	{
+		FPlatformMisc::Prefetch(&Buckets[Key & BucketMask]);
+	}
+
+	//Permille of entries written by the current search, sampled from the first buckets (UCI hashfull)
+	int32 GetHashfull() const;
+
+	int32 GetSizeMB() const { return SizeMB; }
+
+private:
+
+	FChessTranspositionTable(int32 InSizeMB, bool bInShared);
+
+	//16 bytes, data packs the move, scores, depth, bound and generation
+	struct FEntry
+	{
+		uint64 XorKey;
+		uint64 Data;
+	};
+
+	static constexpr int32 BucketSize = 4;
+
+	struct alignas(64) FBucket
+	{
+		FEntry Entries[BucketSize];
+	};
+
+	static_assert(sizeof(FBucket) == 64, "Bucket must fill one cache line");
+
+	FBucket* Buckets = nullptr;
+	uint64 BucketMask = 0;
+	int32 SizeMB = 0;
+
+	//Search counter stored in every entry, 6 bits
+	uint8 Generation = 0;
+
+	//Is this the table returned by Get
+	bool bShared = false;
+};
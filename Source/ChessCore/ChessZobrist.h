@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+ * Zobrist keys used to hash positions
+ * Keys are generated at compile time from a fixed seed, so one read-only copy is shared by all positions
+ * and hashes are equal across processes (persistent caches, opening books)
+ */
+class CHESSCORE_API FChessZobrist
+{
+public:
+
+	//Key of the piece code standing on the 0..63 square
+	static FORCEINLINE uint64 GetPieceKey(int32 Code, int32 Square)
+	{
+		return Keys.Pieces[Code][Square];
+	}
+
+	//Key of the en passant square
+	static FORCEINLINE uint64 GetEnPassantKey(int32 Square)
+	{
+		return Keys.Pieces[0][Square];
+	}
+
+	//Key of the castle permission flags
+	static FORCEINLINE uint64 GetCastleKey(int32 CastlePermission)
+	{
+		return Keys.Castle[CastlePermission];
+	}
+
+	//Key toggled when white is to move
+	static FORCEINLINE uint64 GetSideKey()
+	{
+		return Keys.Side;
+	}
+
+	//Key of the Count-th piece of given code, material key is the XOR of keys 0..Count-1 of every piece code
+	static FORCEINLINE uint64 GetMaterialKey(int32 Code, int32 Count)
+	{
+		checkSlow(Count >= 0 && Count < 16);
+		return Keys.Material[Code][Count];
+	}
+
+	//Polyglot opening book keys: 768 piece keys, 4 castle rights, 8 en passant files and the side to move
+	//
+	static constexpr int32 PolyglotCastleOffset = 768;
+	static constexpr int32 PolyglotEnPassantOffset = 772;
+	static constexpr int32 PolyglotTurnOffset = 780;
+	static constexpr int32 PolyglotKeyCount = 781;
+
+	/**Random64 table of the Polyglot book format
+	 * The table is published with Polyglot and can't be generated, so it's embedded as constant data
+	 * @return PolyglotKeyCount keys
+	 */
+	static const uint64* GetPolyglotKeys();
+
+	//Seed of the keys generator, changing it invalidates every stored hash
+	static constexpr uint64 Seed = 0x9E3779B97F4A7C15ull;
+
+	struct FKeys
+	{
+		//By piece code, code 0 (no piece) is used for en passant squares
+		uint64 Pieces[13][64] = {};
+		uint64 Castle[16] = {};
+		uint64 Side = 0;
+
+		//By piece code and piece count
+		uint64 Material[13][16] = {};
+	};
+
+private:
+
+	static const FKeys Keys;
+
+	static const uint64 PolyglotKeys[PolyglotKeyCount];
+};
@@ -115,3 +115,17 @@ int32 FTileCoord::GetMaxFileIndex()
 {
 	return (int32)EBoardFile::H;
 }
+
+FString FTileCoord::ToString() const
+{
+	if (!IsValid())
+	{
+		return TEXT("-");
+	}
+
+	FString Result;
+	Result.AppendChar(TEXT('a') + (int32)File);
+	Result.AppendChar(TEXT('1') + (int32)Rank);
+
+	return Result;
+}
@@ -20,7 +20,7 @@ enum class ETileCoord : uint8
 };
 
 USTRUCT()
-struct UNREALCHESS_API FTileCoord
+struct CHESSCORE_API FTileCoord
 {
 	GENERATED_BODY()
 	
@@ -51,6 +51,9 @@ public:
 	FORCEINLINE int32 ToInt() const;
 	FORCEINLINE bool operator==(const FTileCoord& Other) const;
 
+	//Coordinate in algebraic notation ("e4"), or "-" if invalid
+	FString ToString() const;
+
 	static EBoardRank ToRank(int32 Int);
 	static EBoardFile ToFile(int32 Int);
 	static int32 GetMinRankIndex();
@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+//Standalone UCI engine for chess GUIs and tournament managers, runs the ChessCore search without the game
+[SupportedPlatforms(UnrealPlatformClass.Desktop)]
+public class ChessUCITarget : TargetRules
+{
+	public ChessUCITarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Program;
+		LinkType = TargetLinkType.Monolithic;
+		LaunchModuleName = "ChessUCI";
+		DefaultBuildSettings = BuildSettingsVersion.V2;
+
+		//No Engine, no editor tools, only Core and the reflection ChessCore structs need
+		//CoreUObject stays because the ChessCore enums and FChessMove are Blueprint types used by the game,
+		//its start only registers those few types, the startup time is logged as "UCI engine started in"
+		bCompileAgainstEngine = false;
+		bCompileAgainstCoreUObject = true;
+		bCompileAgainstApplicationCore = false;
+		bBuildDeveloperTools = false;
+		bBuildWithEditorOnlyData = false;
+
+		//Protocol talks over stdin and stdout, so main() instead of WinMain()
+		bIsBuildingConsoleApplication = true;
+	}
+}
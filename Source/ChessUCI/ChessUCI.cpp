@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ChessUciEngine.h"
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/ThreadSafeBool.h"
+#include "RequiredProgramMainCPPInclude.h"
+
+#include <stdio.h>
+
+DEFINE_LOG_CATEGORY_STATIC(LogChessUCI, Log, All);
+
+IMPLEMENT_APPLICATION(ChessUCI, "ChessUCI");
+
+namespace
+{
+	//Longest command line, position commands of long games with all their moves fit
+	const int32 MaxLineLength = 64 * 1024;
+
+	/*
+	 * Reads stdin on its own thread, so the main loop never blocks on input and keeps polling the search
+	 * Ends after quit or at the end of input, which is turned into quit, so the thread is always joined
+	 */
+	class FChessUciInput : public FRunnable
+	{
+	public:
+
+		FChessUciInput()
+		{
+			Thread.Reset(FRunnableThread::Create(this, TEXT("ChessUciInput"), 0, TPri_Normal));
+		}
+
+		~FChessUciInput()
+		{
+			Thread.Reset();
+		}
+
+		uint32 Run() override
+		{
+			TArray<ANSICHAR> Buffer;
+			Buffer.SetNumZeroed(MaxLineLength);
+
+			while (fgets(Buffer.GetData(), Buffer.Num(), stdin))
+			{
+				const FString Line = FString(UTF8_TO_TCHAR(Buffer.GetData())).TrimStartAndEnd();
+				Lines.Enqueue(Line);
+
+				if (Line == TEXT("quit"))
+				{
+					return 0;
+				}
+			}
+
+			//GUI closed the pipe without quit
+			Lines.Enqueue(TEXT("quit"));
+			return 0;
+		}
+
+		bool Dequeue(FString& OutLine)
+		{
+			return Lines.Dequeue(OutLine);
+		}
+
+	private:
+
+		TQueue<FString, EQueueMode::Spsc> Lines;
+		TUniquePtr<FRunnableThread> Thread;
+	};
+}
+
+INT32_MAIN_INT32_ARGC_TCHAR_ARGV()
+{
+	//Timing isn't set up before PreInit, so cycles are converted after it
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	GEngineLoop.PreInit(ArgC, ArgV);
+
+	//Protocol owns stdout, log messages only go to the log file
+	if (GLogConsole)
+	{
+		GLog->RemoveOutputDevice(GLogConsole);
+	}
+
+	//Cost of Core and CoreUObject start, the only startup work before the engine reads its first command
+	UE_LOG(LogChessUCI, Display, TEXT("UCI engine started in %.1f ms"), (FPlatformTime::Cycles64() - StartCycles) * FPlatformTime::GetSecondsPerCycle64() * 1000.0);
+
+	{
+		FChessUciEngine Engine;
+		FChessUciInput Input;
+
+		bool bRunning = true;
+		while (bRunning)
+		{
+			bool bIdle = true;
+
+			FString Line;
+			while (bRunning && Input.Dequeue(Line))
+			{
+				bRunning = Engine.Execute(Line);
+				bIdle = false;
+			}
+
+			Engine.Update();
+
+			//Stop, ponderhit and the end of the search are noticed within a millisecond
+			if (bIdle)
+			{
+				FPlatformProcess::Sleep(0.001f);
+			}
+		}
+	}
+
+	FEngineLoop::AppPreExit();
+	FEngineLoop::AppExit();
+
+	return 0;
+}
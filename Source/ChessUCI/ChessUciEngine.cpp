@@ -0,0 +1,554 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ChessUciEngine.h"
+#include "Async/Async.h"
+#include "ChessMoveList.h"
+#include "ChessNetwork.h"
+#include "ChessParallelSearch.h"
+#include "ChessPerft.h"
+#include "ChessTablebase.h"
+#include "ChessTranspositionTable.h"
+#include "HAL/PlatformProcess.h"
+
+namespace
+{
+	const TCHAR* StartFEN = TEXT("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+
+	//Option limits, also sent to the GUI
+	//
+	const int32 MaxHashSizeMB = 4096;
+	const int32 MaxMoveOverheadMs = 5000;
+
+	//Sudden death games are planned as if this many moves were left
+	const int32 DefaultMovesToGo = 30;
+
+	//Takes a few seconds with one thread, long enough for a stable nodes per second figure
+	const int32 DefaultBenchDepth = 8;
+
+	//Score in UCI units, mates are counted in moves, negative when the engine is mated
+	FString FormatScore(int32 Score)
+	{
+		if (FChessSearch::IsMateScore(Score))
+		{
+			const int32 Plies = FChessSearch::MateScore - FMath::Abs(Score);
+			const int32 Moves = (Plies + 1) / 2;
+			return FString::Printf(TEXT("mate %d"), Score > 0 ? Moves : -Moves);
+		}
+
+		return FString::Printf(TEXT("cp %d"), Score);
+	}
+
+	//Value following the key, zero if the line ends after the key
+	int64 ParseValue(const TArray<FString>& Tokens, int32& Index)
+	{
+		return Index + 1 < Tokens.Num() ? FCString::Atoi64(*Tokens[++Index]) : 0;
+	}
+}
+
+FChessUciEngine::FChessUciEngine()
+{
+	Table = MakeUnique<FChessTranspositionTable>(HashSizeMB);
+	CreateSearch();
+
+	Position.InitBoard(StartFEN);
+}
+
+FChessUciEngine::~FChessUciEngine()
+{
+	//Search thread uses the tables, it must end before they are destroyed
+	while (IsSearching() && !SearchResult.IsReady())
+	{
+		Search->Stop();
+		FPlatformProcess::Sleep(0.001f);
+	}
+}
+
+bool FChessUciEngine::Execute(const FString& Line)
+{
+	TArray<FString> Tokens;
+	Line.ParseIntoArrayWS(Tokens);
+
+	if (Tokens.Num() == 0)
+	{
+		return true;
+	}
+
+	const FString Command = Tokens[0];
+	Tokens.RemoveAt(0);
+
+	if (Command == TEXT("uci"))
+	{
+		Uci();
+	}
+	else if (Command == TEXT("isready"))
+	{
+		//Answered even during the search, GUIs use it to check the engine is alive
+		Send(TEXT("readyok"));
+	}
+	else if (Command == TEXT("ucinewgame"))
+	{
+		NewGame();
+	}
+	else if (Command == TEXT("setoption"))
+	{
+		SetOption(Tokens);
+	}
+	else if (Command == TEXT("position"))
+	{
+		SetPosition(Tokens);
+	}
+	else if (Command == TEXT("go"))
+	{
+		Go(Tokens);
+	}
+	else if (Command == TEXT("stop"))
+	{
+		StopSearch();
+	}
+	else if (Command == TEXT("ponderhit"))
+	{
+		PonderHit();
+	}
+	else if (Command == TEXT("bench"))
+	{
+		Bench(Tokens.Num() > 0 ? FCString::Atoi(*Tokens[0]) : DefaultBenchDepth);
+	}
+	else if (Command == TEXT("perft"))
+	{
+		Perft(Tokens.Num() > 0 ? FCString::Atoi(*Tokens[0]) : 1);
+	}
+	else if (Command == TEXT("quit"))
+	{
+		FinishSearch();
+		return false;
+	}
+	else
+	{
+		Send(FString::Printf(TEXT("info string Unknown command: %s"), *Command));
+	}
+
+	return true;
+}
+
+void FChessUciEngine::Update()
+{
+	if (!IsSearching())
+	{
+		return;
+	}
+
+	if (StopTime > 0.0 && FPlatformTime::Seconds() >= StopTime)
+	{
+		bStopRequested = true;
+	}
+
+	if (bStopRequested)
+	{
+		Search->Stop();
+	}
+
+	if (SearchResult.IsReady() && !bHoldResult)
+	{
+		const FChessSearchResult Result = SearchResult.Get();
+		SearchResult = TFuture<FChessSearchResult>();
+
+		ReportResult(Result);
+	}
+}
+
+void FChessUciEngine::Uci() const
+{
+	Send(TEXT("id name UnrealChess"));
+	Send(TEXT("id author UnrealChess developers"));
+
+	Send(FString::Printf(TEXT("option name Hash type spin default %d min 1 max %d"), HashSizeMB, MaxHashSizeMB));
+	Send(FString::Printf(TEXT("option name Threads type spin default %d min 1 max %d"), Threads, FChessParallelSearch::GetMaxThreadCount()));
+	Send(FString::Printf(TEXT("option name Move Overhead type spin default %d min 0 max %d"), MoveOverheadMs, MaxMoveOverheadMs));
+	Send(TEXT("option name Ponder type check default false"));
+	Send(TEXT("option name EvalFile type string default <empty>"));
+	Send(TEXT("option name SyzygyPath type string default <empty>"));
+	Send(TEXT("option name Clear Hash type button"));
+
+	Send(TEXT("uciok"));
+}
+
+void FChessUciEngine::NewGame()
+{
+	FinishSearch();
+
+	//Nothing learned in the previous game applies, ordering statistics go with the search
+	Table->Clear();
+	CreateSearch();
+
+	Position.InitBoard(StartFEN);
+}
+
+void FChessUciEngine::SetOption(const TArray<FString>& Tokens)
+{
+	FinishSearch();
+
+	//setoption name <words> [value <words>], names may contain spaces
+	FString Name;
+	FString Value;
+	FString* Target = nullptr;
+
+	for (const FString& Token : Tokens)
+	{
+		if (Token == TEXT("name"))
+		{
+			Target = &Name;
+		}
+		else if (Token == TEXT("value"))
+		{
+			Target = &Value;
+		}
+		else if (Target)
+		{
+			if (!Target->IsEmpty())
+			{
+				Target->AppendChar(TEXT(' '));
+			}
+
+			Target->Append(Token);
+		}
+	}
+
+	if (Name == TEXT("Hash"))
+	{
+		HashSizeMB = FMath::Clamp(FCString::Atoi(*Value), 1, MaxHashSizeMB);
+		Table->Resize(HashSizeMB);
+	}
+	else if (Name == TEXT("Threads"))
+	{
+		Threads = FMath::Clamp(FCString::Atoi(*Value), 1, FChessParallelSearch::GetMaxThreadCount());
+		CreateSearch();
+	}
+	else if (Name == TEXT("Move Overhead"))
+	{
+		MoveOverheadMs = FMath::Clamp(FCString::Atoi(*Value), 0, MaxMoveOverheadMs);
+	}
+	else if (Name == TEXT("EvalFile"))
+	{
+		if (Value.IsEmpty() || Value == TEXT("<empty>"))
+		{
+			Network.Reset();
+		}
+		else
+		{
+			TUniquePtr<FChessNetwork> Loaded = MakeUnique<FChessNetwork>();
+
+			if (Loaded->Load(Value))
+			{
+				Network = MoveTemp(Loaded);
+				Send(FString::Printf(TEXT("info string Network %s loaded"), *Value));
+			}
+			else
+			{
+				Send(FString::Printf(TEXT("info string Network %s can't be loaded, evaluation is unchanged"), *Value));
+			}
+		}
+
+		Position.SetNetwork(Network.Get());
+	}
+	else if (Name == TEXT("SyzygyPath"))
+	{
+		FChessTablebase& Tablebase = FChessTablebase::Get();
+		const int32 Count = Tablebase.Init(Value == TEXT("<empty>") ? FString() : Value);
+
+		Send(FString::Printf(TEXT("info string Found %d tablebases of up to %d pieces"), Count, Tablebase.GetMaxPieces()));
+	}
+	else if (Name == TEXT("Clear Hash"))
+	{
+		Table->Clear();
+	}
+	else if (Name != TEXT("Ponder"))
+	{
+		Send(FString::Printf(TEXT("info string Unknown option: %s"), *Name));
+	}
+}
+
+void FChessUciEngine::SetPosition(const TArray<FString>& Tokens)
+{
+	FinishSearch();
+
+	//position (startpos | fen <fields>) [moves <moves>]
+	FString FEN;
+	int32 Index = 0;
+
+	if (Tokens.Num() > 0 && Tokens[0] == TEXT("startpos"))
+	{
+		FEN = StartFEN;
+		Index = 1;
+	}
+	else if (Tokens.Num() > 0 && Tokens[0] == TEXT("fen"))
+	{
+		for (Index = 1; Index < Tokens.Num() && Tokens[Index] != TEXT("moves"); ++Index)
+		{
+			FEN += Tokens[Index] + TEXT(" ");
+		}
+	}
+
+	//Parsed into a copy, so a bad command leaves the previous position
+	FChessPosition NewPosition;
+	NewPosition.SetNetwork(Network.Get());
+
+	if (FEN.IsEmpty() || !NewPosition.InitBoard(FEN))
+	{
+		Send(TEXT("info string Invalid position"));
+		return;
+	}
+
+	Position = NewPosition;
+
+	if (Index < Tokens.Num() && Tokens[Index] == TEXT("moves"))
+	{
+		for (++Index; Index < Tokens.Num(); ++Index)
+		{
+			const FChessMove Move = ParseMove(Tokens[Index]);
+
+			if (!Move.IsValid())
+			{
+				Send(FString::Printf(TEXT("info string Illegal move: %s"), *Tokens[Index]));
+				break;
+			}
+
+			//Moves stay in the history, so repetitions of the game are seen by the search
+			Position.MakeMove(Move);
+		}
+	}
+}
+
+void FChessUciEngine::Go(const TArray<FString>& Tokens)
+{
+	//GUI sends stop first, this only happens with a hand typed go
+	FinishSearch();
+
+	FChessSearchLimits Limits;
+	int32 Time[2] = { 0, 0 };
+	int32 Increment[2] = { 0, 0 };
+	int32 MovesToGo = 0;
+	int32 MoveTime = 0;
+	bool bInfinite = false;
+	bool bPonder = false;
+
+	for (int32 i = 0; i < Tokens.Num(); ++i)
+	{
+		const FString& Key = Tokens[i];
+
+		if (Key == TEXT("wtime"))          { Time[0] = static_cast<int32>(ParseValue(Tokens, i)); }
+		else if (Key == TEXT("btime"))     { Time[1] = static_cast<int32>(ParseValue(Tokens, i)); }
+		else if (Key == TEXT("winc"))      { Increment[0] = static_cast<int32>(ParseValue(Tokens, i)); }
+		else if (Key == TEXT("binc"))      { Increment[1] = static_cast<int32>(ParseValue(Tokens, i)); }
+		else if (Key == TEXT("movestogo")) { MovesToGo = static_cast<int32>(ParseValue(Tokens, i)); }
+		else if (Key == TEXT("movetime"))  { MoveTime = static_cast<int32>(ParseValue(Tokens, i)); }
+		else if (Key == TEXT("depth"))     { Limits.Depth = static_cast<int32>(ParseValue(Tokens, i)); }
+		else if (Key == TEXT("nodes"))     { Limits.Nodes = static_cast<uint64>(FMath::Max<int64>(ParseValue(Tokens, i), 0)); }
+		else if (Key == TEXT("infinite"))  { bInfinite = true; }
+		else if (Key == TEXT("ponder"))    { bPonder = true; }
+		else if (Key == TEXT("perft"))
+		{
+			Perft(static_cast<int32>(ParseValue(Tokens, i)));
+			return;
+		}
+	}
+
+	const int32 Side = Position.GetSide() == EPieceColor::White ? 0 : 1;
+
+	int32 TimeMs = 0;
+	if (MoveTime > 0)
+	{
+		TimeMs = FMath::Max(MoveTime - MoveOverheadMs, 1);
+	}
+	else if (Time[Side] > 0)
+	{
+		TimeMs = GetMoveTime(Time[Side], Increment[Side], MovesToGo);
+	}
+
+	//Pondering is on the opponent's time, the clock starts with ponderhit
+	//Infinite search ignores the clock, depth and nodes still stop it
+	Limits.TimeMs = bPonder || bInfinite ? 0 : TimeMs;
+	PonderTimeMs = bPonder ? TimeMs : 0;
+	bHoldResult = bPonder || bInfinite;
+	bStopRequested = false;
+	StopTime = 0.0;
+
+	FChessParallelSearch* const ParallelSearch = Search.Get();
+	SearchResult = Async(EAsyncExecution::Thread, [ParallelSearch, RootPosition = Position, Limits]()
+	{
+		return ParallelSearch->Search(RootPosition, Limits);
+	});
+}
+
+void FChessUciEngine::StopSearch()
+{
+	if (IsSearching())
+	{
+		bHoldResult = false;
+		bStopRequested = true;
+		Search->Stop();
+	}
+}
+
+void FChessUciEngine::PonderHit()
+{
+	if (IsSearching())
+	{
+		//Opponent played the expected move, the search goes on as a normal one
+		bHoldResult = false;
+
+		if (PonderTimeMs > 0)
+		{
+			StopTime = FPlatformTime::Seconds() + PonderTimeMs / 1000.0;
+		}
+	}
+}
+
+void FChessUciEngine::Bench(int32 Depth)
+{
+	FinishSearch();
+
+	FChessSearchLimits Limits;
+	Limits.Depth = FMath::Max(Depth, 1);
+
+	uint64 TotalNodes = 0;
+	double TotalSeconds = 0.0;
+
+	for (const FChessPerftReference& Reference : FChessPerft::GetReferencePositions())
+	{
+		FChessPosition BenchPosition;
+		BenchPosition.SetNetwork(Network.Get());
+		BenchPosition.InitBoard(Reference.FEN);
+
+		//Every position starts cold, so the node count is the same from run to run with one thread
+		Table->Clear();
+
+		const FChessSearchResult Result = Search->Search(BenchPosition, Limits);
+
+		Send(FString::Printf(TEXT("info string %s: %s %s, %llu nodes"),
+		                     Reference.Name,
+		                     *Result.BestMove.ToString(),
+		                     *FormatScore(Result.Score),
+		                     Result.Nodes
+		));
+
+		TotalNodes += Result.Nodes;
+		TotalSeconds += Result.Seconds;
+	}
+
+	Table->Clear();
+
+	//Format read by OpenBench and similar testing frameworks
+	Send(FString::Printf(TEXT("%llu nodes %llu nps"),
+	                     TotalNodes,
+	                     TotalSeconds > 0.0 ? static_cast<uint64>(TotalNodes / TotalSeconds) : 0ull
+	));
+}
+
+void FChessUciEngine::Perft(int32 Depth)
+{
+	FinishSearch();
+
+	const FChessPerftResult Result = FChessPerft::Run(Position, FMath::Max(Depth, 1), true);
+
+	for (const TPair<FChessMove, uint64>& Entry : Result.Divide)
+	{
+		Send(FString::Printf(TEXT("%s: %llu"), *Entry.Key.ToString(), Entry.Value));
+	}
+
+	Send(TEXT(""));
+	Send(FString::Printf(TEXT("Nodes searched: %llu"), Result.Nodes));
+	Send(FString::Printf(TEXT("info string %.3f s, %.0f nps"), Result.Seconds, Result.GetNodesPerSecond()));
+}
+
+int32 FChessUciEngine::GetMoveTime(int32 Time, int32 Increment, int32 MovesToGo) const
+{
+	const int32 Moves = MovesToGo > 0 ? FMath::Min(MovesToGo, DefaultMovesToGo) : DefaultMovesToGo;
+
+	//Most of the increment comes back with the move, so it's spent on it
+	const int32 Planned = Time / Moves + Increment * 3 / 4;
+
+	//Never plan past the clock, the GUI and the pipe take their part of it
+	return FMath::Max(FMath::Min(Planned, Time - MoveOverheadMs), 1);
+}
+
+void FChessUciEngine::FinishSearch()
+{
+	if (!IsSearching())
+	{
+		return;
+	}
+
+	StopSearch();
+
+	while (!SearchResult.IsReady())
+	{
+		Search->Stop();
+		FPlatformProcess::Sleep(0.001f);
+	}
+
+	Update();
+}
+
+void FChessUciEngine::ReportResult(const FChessSearchResult& Result) const
+{
+	FString Info = FString::Printf(TEXT("info depth %d score %s nodes %llu nps %llu time %lld hashfull %d"),
+	                               Result.Depth,
+	                               *FormatScore(Result.Score),
+	                               Result.Nodes,
+	                               Result.Seconds > 0.0 ? static_cast<uint64>(Result.Nodes / Result.Seconds) : 0ull,
+	                               static_cast<int64>(Result.Seconds * 1000.0),
+	                               Table->GetHashfull()
+	);
+
+	if (Result.PrincipalVariation.Num() > 0)
+	{
+		Info += TEXT(" pv");
+
+		for (const FChessMove& Move : Result.PrincipalVariation)
+		{
+			Info += TEXT(" ") + Move.ToString();
+		}
+	}
+
+	Send(Info);
+
+	//Null move in UCI notation when there is nothing to play, mated or stalemated
+	FString BestMove = TEXT("bestmove ");
+	BestMove += Result.BestMove.IsValid() ? Result.BestMove.ToString() : TEXT("0000");
+
+	if (Result.PrincipalVariation.Num() > 1)
+	{
+		BestMove += TEXT(" ponder ") + Result.PrincipalVariation[1].ToString();
+	}
+
+	Send(BestMove);
+}
+
+FChessMove FChessUciEngine::ParseMove(const FString& Text) const
+{
+	FChessMoveList Moves;
+	Position.GenerateMoves(Moves);
+
+	for (int32 i = 0; i < Moves.Num(); ++i)
+	{
+		if (Moves[i].ToString() == Text)
+		{
+			return Moves[i];
+		}
+	}
+
+	return FChessMove();
+}
+
+void FChessUciEngine::CreateSearch()
+{
+	//Helper threads come from the shared pool, only the searches are made again
+	Search = MakeUnique<FChessParallelSearch>(*Table, Threads);
+}
+
+void FChessUciEngine::Send(const FString& Line)
+{
+	printf("%s\n", TCHAR_TO_UTF8(*Line));
+	fflush(stdout);
+}
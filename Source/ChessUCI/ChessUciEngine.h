@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "ChessPosition.h"
+#include "ChessSearch.h"
+
+class FChessNetwork;
+class FChessParallelSearch;
+class FChessTranspositionTable;
+
+/*
+ * Universal Chess Interface engine: parses GUI commands and answers on stdout
+ * See www.shredderchess.com/download/div/uci.zip for the protocol
+ *
+ * Search runs on its own thread, so commands keep being executed while it searches,
+ * stop and ponderhit reach it at once and isready is answered immediately
+ * Besides the standard commands, "bench [depth]" searches the perft reference positions
+ * and "perft <depth>" (or "go perft <depth>") divides the current position
+ */
+class FChessUciEngine
+{
+public:
+
+	FChessUciEngine();
+	~FChessUciEngine();
+
+	/**Execute one line received from the GUI
+	 * @return False after quit
+	 */
+	bool Execute(const FString& Line);
+
+	//Report the finished search, stop the search when time runs out after ponderhit, called by the main loop
+	void Update();
+
+	bool IsSearching() const { return SearchResult.IsValid(); }
+
+private:
+
+	//Commands, Tokens start after the command name
+	//
+	void Uci() const;
+	void NewGame();
+	void SetOption(const TArray<FString>& Tokens);
+	void SetPosition(const TArray<FString>& Tokens);
+	void Go(const TArray<FString>& Tokens);
+	void StopSearch();
+	void PonderHit();
+	void Bench(int32 Depth);
+	void Perft(int32 Depth);
+
+	/**Time for the move from the clock of the moving side
+	 * @param Time Remaining time in milliseconds
+	 * @param Increment Increment per move in milliseconds
+	 * @param MovesToGo Moves until the next time control, zero for sudden death
+	 */
+	int32 GetMoveTime(int32 Time, int32 Increment, int32 MovesToGo) const;
+
+	//Stop the running search and report it, commands which change the position or tables can't run during the search
+	void FinishSearch();
+
+	//Print info and bestmove lines
+	void ReportResult(const FChessSearchResult& Result) const;
+
+	//Legal move of the current position in long algebraic notation (e2e4, e7e8q), invalid move if there is none
+	FChessMove ParseMove(const FString& Text) const;
+
+	//Recreate the search, tables and helper threads belong to it
+	void CreateSearch();
+
+	//Write line to stdout and flush it, GUIs read the output line by line
+	static void Send(const FString& Line);
+
+	//Position set by the last position command
+	FChessPosition Position;
+
+	TUniquePtr<FChessTranspositionTable> Table;
+	TUniquePtr<FChessParallelSearch> Search;
+
+	//Network loaded by EvalFile, null to use the hand written evaluation
+	TUniquePtr<FChessNetwork> Network;
+
+	//Options
+	//
+	int32 HashSizeMB = 16;
+	int32 Threads = 1;
+	int32 MoveOverheadMs = 30;
+
+	//Set while a search runs on its thread
+	TFuture<FChessSearchResult> SearchResult;
+
+	//Ponder and infinite searches may finish by themselves, but bestmove must wait for stop or ponderhit
+	bool bHoldResult = false;
+
+	//Stop flag set before the search thread calls Setup would be lost, so Stop is repeated until the search ends
+	bool bStopRequested = false;
+
+	//Time of the pondered move once ponderhit arrives, zero for no limit
+	int32 PonderTimeMs = 0;
+
+	//Wall time when the search is stopped, zero for no deadline
+	double StopTime = 0.0;
+};
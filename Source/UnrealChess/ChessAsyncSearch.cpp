@@ -0,0 +1,196 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ChessAsyncSearch.h"
+#include "Async/Async.h"
+#include "ChessTranspositionTable.h"
+#include "Engine/LatentActionManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/QueuedThreadPool.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+	//Stack of the search threads, the same as the parallel search helpers have
+	constexpr uint32 SearchStackSize = 1024 * 1024;
+
+	/**Pool of the requests of all boards, made on the first request and destroyed before exit
+	 * The engine pool has small stacks in game builds and a single thread on dedicated servers
+	 * One thread per core, Lazy SMP helpers are lent only to fill cores these leave idle
+	 */
+	FQueuedThreadPool& GetSearchPool()
+	{
+		//Thread safe static initialization
+		static FQueuedThreadPool* const Pool = []()
+		{
+			FQueuedThreadPool* NewPool = FQueuedThreadPool::Allocate();
+			verify(NewPool->Create(FChessParallelSearch::GetMaxThreadCount(), SearchStackSize, TPri_Normal));
+
+			//Running searches are waited for, queued ones are abandoned
+			FCoreDelegates::OnPreExit.AddLambda([NewPool]()
+			{
+				NewPool->Destroy();
+				delete NewPool;
+			});
+
+			return NewPool;
+		}();
+
+		return *Pool;
+	}
+}
+
+FChessAnalysis::FChessAnalysis(const FChessSearchResult& Result) :
+	BestMove(Result.BestMove),
+	Score(Result.Score),
+	Depth(Result.Depth),
+	Nodes(static_cast<int64>(Result.Nodes)),
+	Seconds(static_cast<float>(Result.Seconds)),
+	PrincipalVariation(Result.PrincipalVariation)
+{
+}
+
+FChessAsyncSearch::FChessAsyncSearch(const FChessPosition& InPosition,
+                                     const FChessSearchLimits& InLimits,
+                                     const TSharedRef<FChessTranspositionTable, ESPMode::ThreadSafe>& InTable,
+                                     FOnComplete InOnComplete) :
+	Table(InTable),
+	Position(InPosition),
+	Limits(InLimits),
+	OnComplete(MoveTemp(InOnComplete))
+{
+}
+
+FChessAsyncSearch::FChessAsyncSearch(const FChessSearchResult& InResult) :
+	Result(InResult),
+	bDone(true)
+{
+}
+
+TSharedRef<FChessAsyncSearch, ESPMode::ThreadSafe> FChessAsyncSearch::Launch(const FChessPosition& Position,
+                                                                             const FChessSearchLimits& Limits,
+                                                                             const TSharedRef<FChessTranspositionTable, ESPMode::ThreadSafe>& Table,
+                                                                             FOnComplete OnComplete)
+{
+	//Position is copied here, everything else is made on the worker
+	TSharedRef<FChessAsyncSearch, ESPMode::ThreadSafe> Task = MakeShared<FChessAsyncSearch, ESPMode::ThreadSafe>(Position, Limits, Table, MoveTemp(OnComplete));
+
+	AsyncPool(GetSearchPool(), [Task]()
+	{
+		Task->Run();
+	});
+
+	return Task;
+}
+
+TSharedRef<FChessAsyncSearch, ESPMode::ThreadSafe> FChessAsyncSearch::MakeDone(const FChessSearchResult& InResult)
+{
+	return MakeShared<FChessAsyncSearch, ESPMode::ThreadSafe>(InResult);
+}
+
+void FChessAsyncSearch::Cancel()
+{
+	bCancelled = true;
+
+	FScopeLock ScopeLock(&SearchLock);
+
+	//Search made after this sees the flag and doesn't run
+	if (Search.IsValid())
+	{
+		Search->Stop();
+	}
+}
+
+void FChessAsyncSearch::Run()
+{
+	{
+		FScopeLock ScopeLock(&SearchLock);
+
+		//Cancelled while queued, nothing to search
+		if (!bCancelled)
+		{
+			Search = MakeUnique<FChessParallelSearch>(*Table, FChessParallelSearch::GetDefaultThreadCount());
+			Search->Setup(Position, Limits);
+		}
+	}
+
+	//Cancel coming after Setup stops the search, Run must still follow to give the helpers back
+	if (Search.IsValid())
+	{
+		Result = Search->Run();
+
+		//Tables of the search aren't kept alive until the task is released
+		FScopeLock ScopeLock(&SearchLock);
+		Search.Reset();
+	}
+
+	bDone = true;
+
+	//Cancel is called on the game thread, so it's checked there to never execute a cancelled delegate
+	//Delegate bound to a destroyed object isn't executed either
+	AsyncTask(ENamedThreads::GameThread, [Task = AsShared()]()
+	{
+		if (!Task->IsCancelled())
+		{
+			Task->OnComplete.ExecuteIfBound(Task->Result);
+		}
+	});
+}
+
+FChessSearchLatentAction::FChessSearchLatentAction(const TSharedRef<FChessAsyncSearch, ESPMode::ThreadSafe>& InTask,
+                                                   const FLatentActionInfo& LatentInfo,
+                                                   FChessMove* InOutMove,
+                                                   FChessAnalysis* InOutAnalysis) :
+	Task(InTask),
+	ExecutionFunction(LatentInfo.ExecutionFunction),
+	OutputLink(LatentInfo.Linkage),
+	CallbackTarget(LatentInfo.CallbackTarget),
+	OutMove(InOutMove),
+	OutAnalysis(InOutAnalysis)
+{
+}
+
+void FChessSearchLatentAction::UpdateOperation(FLatentResponse& Response)
+{
+	if (Task->IsCancelled())
+	{
+		Response.DoneIf(true);
+		return;
+	}
+
+	if (!Task->IsDone())
+	{
+		return;
+	}
+
+	const FChessSearchResult& Result = Task->GetResult();
+
+	if (OutMove)
+	{
+		*OutMove = Result.BestMove;
+	}
+
+	if (OutAnalysis)
+	{
+		*OutAnalysis = FChessAnalysis(Result);
+	}
+
+	Response.FinishAndTriggerIf(true, ExecutionFunction, OutputLink, CallbackTarget);
+}
+
+void FChessSearchLatentAction::NotifyObjectDestroyed()
+{
+	Task->Cancel();
+}
+
+void FChessSearchLatentAction::NotifyActionAborted()
+{
+	Task->Cancel();
+}
+
+#if WITH_EDITOR
+FString FChessSearchLatentAction::GetDescription() const
+{
+	return Task->IsDone() ? TEXT("Search done") : TEXT("Searching");
+}
+#endif
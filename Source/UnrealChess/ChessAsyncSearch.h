@@ -0,0 +1,166 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChessMove.h"
+#include "ChessParallelSearch.h"
+#include "ChessSearch.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeBool.h"
+#include "LatentActions.h"
+
+#include "ChessAsyncSearch.generated.h"
+
+class FChessTranspositionTable;
+
+//Search result for Blueprints
+USTRUCT(BlueprintType)
+struct UNREALCHESS_API FChessAnalysis
+{
+	GENERATED_BODY()
+
+	//Invalid if there are no legal moves
+	UPROPERTY(BlueprintReadOnly, Category = "AI")
+	FChessMove BestMove;
+
+	//Centipawns for the moving side, mate scores are above 30000
+	UPROPERTY(BlueprintReadOnly, Category = "AI")
+	int32 Score = 0;
+
+	//Depth of the last completed iteration
+	UPROPERTY(BlueprintReadOnly, Category = "AI")
+	int32 Depth = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AI")
+	int64 Nodes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AI")
+	float Seconds = 0.f;
+
+	//Expected line of play, starting with BestMove
+	UPROPERTY(BlueprintReadOnly, Category = "AI")
+	TArray<FChessMove> PrincipalVariation;
+
+	FChessAnalysis() = default;
+	explicit FChessAnalysis(const FChessSearchResult& Result);
+};
+
+/*
+ * Search running on a thread of the chess search pool against a copy of the position, so the game thread never waits for it
+ * The search and its tables are made on the worker, the game thread only copies the position
+ * Each request has FChessParallelSearch::GetDefaultThreadCount threads at most, helpers are borrowed from the shared pool
+ * only while cores are idle, so the pool size bounds the busy threads of all boards
+ *
+ * The task is shared by the game thread and the worker, whichever releases it last deletes it
+ * Completion delegate is executed on the game thread, unless the task is cancelled before
+ */
+class UNREALCHESS_API FChessAsyncSearch : public TSharedFromThis<FChessAsyncSearch, ESPMode::ThreadSafe>
+{
+public:
+
+	DECLARE_DELEGATE_OneParam(FOnComplete, const FChessSearchResult&);
+
+	/**Copy the position and start searching it on a thread of the chess search pool
+	 * @param Position Position to search, may change right after the call
+	 * @param Limits When to stop, set at least one of them or the search only ends by Cancel
+	 * @param Table Transposition table, kept alive by the search, must not start a new search (NewSearch) while it runs
+	 * @param OnComplete Executed on the game thread with the result, may be unbound for polling with IsDone
+	 */
+	static TSharedRef<FChessAsyncSearch, ESPMode::ThreadSafe> Launch(const FChessPosition& Position,
+	                                                                 const FChessSearchLimits& Limits,
+	                                                                 const TSharedRef<FChessTranspositionTable, ESPMode::ThreadSafe>& Table,
+	                                                                 FOnComplete OnComplete);
+
+	/**Task which is done from the start, for moves found without searching (opening book)
+	 * @param InResult Result returned by GetResult
+	 */
+	static TSharedRef<FChessAsyncSearch, ESPMode::ThreadSafe> MakeDone(const FChessSearchResult& InResult);
+
+	//Stop the search as soon as possible, the completion delegate won't be executed
+	void Cancel();
+
+	bool IsCancelled() const { return bCancelled; }
+
+	//Has the worker finished, the result can be read then
+	bool IsDone() const { return bDone; }
+
+	//Result of the finished search
+	const FChessSearchResult& GetResult() const
+	{
+		check(IsDone());
+		return Result;
+	}
+
+	FChessAsyncSearch(const FChessPosition& InPosition,
+	                  const FChessSearchLimits& InLimits,
+	                  const TSharedRef<FChessTranspositionTable, ESPMode::ThreadSafe>& InTable,
+	                  FOnComplete InOnComplete);
+	explicit FChessAsyncSearch(const FChessSearchResult& InResult);
+
+private:
+
+	//Worker thread body
+	void Run();
+
+	//Owner of the table may be destroyed before the worker finishes, null for done tasks
+	TSharedPtr<FChessTranspositionTable, ESPMode::ThreadSafe> Table;
+
+	//Copied by Launch, searched by the worker
+	//
+	FChessPosition Position;
+	FChessSearchLimits Limits;
+
+	//Made by the worker, null before it starts and for done tasks
+	TUniquePtr<FChessParallelSearch> Search;
+
+	//Guards making the search against Cancel
+	FCriticalSection SearchLock;
+
+	FOnComplete OnComplete;
+	FChessSearchResult Result;
+
+	FThreadSafeBool bCancelled;
+	FThreadSafeBool bDone;
+};
+
+/*
+ * Blueprint latent action waiting for the async search, writes the result to the node outputs and triggers the next node
+ * Aborting the action (owner destroyed, level unloaded) cancels the search, cancelled searches never trigger
+ */
+class UNREALCHESS_API FChessSearchLatentAction : public FPendingLatentAction
+{
+public:
+
+	/**Make action
+	 * @param InTask Search to wait for
+	 * @param LatentInfo Node to trigger
+	 * @param InOutMove Best move output, may be null
+	 * @param InOutAnalysis Whole result output, may be null
+	 */
+	FChessSearchLatentAction(const TSharedRef<FChessAsyncSearch, ESPMode::ThreadSafe>& InTask,
+	                         const FLatentActionInfo& LatentInfo,
+	                         FChessMove* InOutMove,
+	                         FChessAnalysis* InOutAnalysis);
+
+	void UpdateOperation(FLatentResponse& Response) override;
+	void NotifyObjectDestroyed() override;
+	void NotifyActionAborted() override;
+
+#if WITH_EDITOR
+	FString GetDescription() const override;
+#endif
+
+private:
+
+	TSharedRef<FChessAsyncSearch, ESPMode::ThreadSafe> Task;
+
+	FName ExecutionFunction;
+	int32 OutputLink;
+	FWeakObjectPtr CallbackTarget;
+
+	//Outputs live in the Blueprint frame of the node
+	//
+	FChessMove* OutMove;
+	FChessAnalysis* OutAnalysis;
+};
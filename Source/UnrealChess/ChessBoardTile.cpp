@@ -1 +0,0 @@
-#include "ChessBoardTile.h"
\ No newline at end of file
@@ -0,0 +1,179 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ChessEvalBenchCommandlet.h"
+#include "ChessEvaluation.h"
+#include "ChessNetwork.h"
+#include "ChessPawnTable.h"
+#include "ChessPerft.h"
+#include "ChessPosition.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogChessEvalBench, Log, All);
+
+namespace
+{
+	//Totals over all trees for one evaluator
+	struct FBenchRun
+	{
+		FString Name;
+		uint64 Evaluations = 0;
+		double Seconds = 0.0;
+
+		//Sum of all scores, keeps the evaluations from being optimized away and shows evaluators differ
+		int64 Checksum = 0;
+	};
+
+	//Evaluate every node of the tree
+	template <typename EvaluatorType>
+	void WalkTree(FChessPosition& Position, int32 Depth, EvaluatorType& Evaluator, FBenchRun& Run)
+	{
+		Run.Checksum += Evaluator(Position);
+		++Run.Evaluations;
+
+		if (Depth == 0)
+		{
+			return;
+		}
+
+		FChessMoveList Moves;
+		Position.GenerateMoves(Moves);
+
+		for (const FChessMove& Move : Moves)
+		{
+			Position.MakeMove(Move);
+			WalkTree(Position, Depth - 1, Evaluator, Run);
+			Position.TakeMove();
+		}
+	}
+
+	template <typename EvaluatorType>
+	FBenchRun RunBench(const FString& Name, int32 Depth, const FChessNetwork* Network, EvaluatorType&& Evaluator)
+	{
+		FBenchRun Run;
+		Run.Name = Name;
+
+		for (auto&& Reference : FChessPerft::GetReferencePositions())
+		{
+			FChessPosition Position;
+			Position.InitBoard(Reference.FEN);
+			Position.SetNetwork(Network);
+
+			const double StartTime = FPlatformTime::Seconds();
+			WalkTree(Position, Depth, Evaluator, Run);
+			Run.Seconds += FPlatformTime::Seconds() - StartTime;
+		}
+
+		UE_LOG(LogChessEvalBench, Display, TEXT("  %s: %llu evaluations, %.3f s, checksum %lld"),
+		       *Run.Name,
+		       Run.Evaluations,
+		       Run.Seconds,
+		       Run.Checksum
+		);
+
+		return Run;
+	}
+}
+
+UChessEvalBenchCommandlet::UChessEvalBenchCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Measures evaluations per second of material, piece-square and network evaluation");
+	HelpUsage = TEXT("-run=ChessEvalBench [-depth=N] [-network=Path] [-export]");
+}
+
+int32 UChessEvalBenchCommandlet::Main(const FString& Params)
+{
+	int32 Depth = 3;
+	FParse::Value(*Params, TEXT("depth="), Depth);
+
+	FString NetworkPath = FChessNetwork::GetDefaultPath();
+	FParse::Value(*Params, TEXT("network="), NetworkPath);
+
+	TUniquePtr<FChessNetwork> Network = MakeUnique<FChessNetwork>();
+
+	if (FParse::Param(*Params, TEXT("export")))
+	{
+		Network->InitFromPieceSquareTables();
+
+		if (!Network->Save(NetworkPath))
+		{
+			UE_LOG(LogChessEvalBench, Error, TEXT("Can't write network file %s"), *NetworkPath);
+			return 1;
+		}
+
+		UE_LOG(LogChessEvalBench, Display, TEXT("Bootstrap network written to %s"), *NetworkPath);
+		return 0;
+	}
+
+	if (!Network->Load(NetworkPath))
+	{
+		UE_LOG(LogChessEvalBench, Warning, TEXT("Using the piece-square bootstrap network"));
+		Network->InitFromPieceSquareTables();
+	}
+
+	UE_LOG(LogChessEvalBench, Display, TEXT("Depth %d, network %s"), Depth, *NetworkPath);
+
+	TArray<FBenchRun> Runs;
+
+	//Base line, what the search scored by before the piece-square tables
+	Runs.Add(RunBench(TEXT("Material"), Depth, nullptr, [](const FChessPosition& Position)
+	{
+		const int32 Score = Position.GetMaterial(EPieceColor::White) - Position.GetMaterial(EPieceColor::Black);
+		return Position.GetSide() == EPieceColor::White ? Score : -Score;
+	}));
+
+	FChessPawnTable PawnTable;
+	Runs.Add(RunBench(TEXT("Piece-square"), Depth, nullptr, [&PawnTable](const FChessPosition& Position)
+	{
+		return FChessEvaluation::Evaluate(Position, &PawnTable);
+	}));
+
+	//Instruction set is global, restore the default when done
+	const EChessNetworkSimd DefaultSimd = FChessNetwork::GetSimd();
+
+	for (EChessNetworkSimd Simd : { EChessNetworkSimd::Scalar, EChessNetworkSimd::SSE41, EChessNetworkSimd::AVX2 })
+	{
+		FChessNetwork::SetSimd(Simd);
+
+		//Unsupported instruction sets fall back to the previous one, which was measured already
+		if (FChessNetwork::GetSimd() != Simd)
+		{
+			UE_LOG(LogChessEvalBench, Display, TEXT("  %s is not supported"), FChessNetwork::GetSimdName(Simd));
+			continue;
+		}
+
+		Runs.Add(RunBench(FString::Printf(TEXT("Network %s"), FChessNetwork::GetSimdName(Simd)), Depth, Network.Get(),
+			[](const FChessPosition& Position)
+			{
+				return FChessEvaluation::Evaluate(Position);
+			}
+		));
+	}
+
+	FChessNetwork::SetSimd(DefaultSimd);
+
+	//Speedups are relative to material only scoring
+	const FBenchRun& Base = Runs[0];
+	const double BaseEvalsPerSecond = Base.Seconds > 0.0 ? Base.Evaluations / Base.Seconds : 0.0;
+
+	UE_LOG(LogChessEvalBench, Display, TEXT("Evaluator             Evaluations     Time      Evals/s  Relative"));
+
+	for (auto&& Run : Runs)
+	{
+		const double EvalsPerSecond = Run.Seconds > 0.0 ? Run.Evaluations / Run.Seconds : 0.0;
+
+		UE_LOG(LogChessEvalBench, Display, TEXT("%-20s %12llu %8.3f %12.0f %8.2fx"),
+		       *Run.Name,
+		       Run.Evaluations,
+		       Run.Seconds,
+		       EvalsPerSecond,
+		       BaseEvalsPerSecond > 0.0 ? EvalsPerSecond / BaseEvalsPerSecond : 0.0
+		);
+	}
+
+	return 0;
+}
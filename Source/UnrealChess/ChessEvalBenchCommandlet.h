@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "ChessEvalBenchCommandlet.generated.h"
+
+/**
+ * Headless evaluation benchmark, compares evaluations per second of the evaluators
+ *
+ * Usage: UE4Editor-Cmd UnrealChess -run=ChessEvalBench -nullrhi [options]
+ *   -depth=N			Depth of the perft suite trees to evaluate, 3 by default
+ *   -network=Path		Weights file, Content/Network/Chess.nnue by default
+ *   -export			Write the piece-square bootstrap network to the weights file and exit
+ *
+ * Every node of the trees is evaluated by material only, the piece-square evaluation,
+ * and the network with each supported instruction set
+ * Make and unmake moves are included in the time, network runs also keep the accumulator up to date
+ */
+UCLASS()
+class UNREALCHESS_API UChessEvalBenchCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UChessEvalBenchCommandlet();
+
+	int32 Main(const FString& Params) override;
+};
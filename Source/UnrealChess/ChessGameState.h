@@ -7,12 +7,15 @@
 #include "GameFramework/GameStateBase.h"
 #include "TileCoordinate.h"
 #include "ChessMove.h"
-#include "ChessMoveRecord.h"
-#include "ChessBoardTile.h"
+#include "ChessPosition.h"
+#include "ChessAsyncSearch.h"
+#include "Engine/LatentActionManager.h"
 
 #include "ChessGameState.generated.h"
 
 class AChessboard;
+class FChessSlicedSearch;
+class FChessTranspositionTable;
 class UDataTable;
 
 UENUM(BlueprintType)
@@ -22,6 +25,10 @@ enum class EEndChessGameReason : uint8
 	Stalemate
 };
 
+/*
+ * Game-side wrapper over FChessPosition
+ * Adds replication, delegates and logging, the rules themselves live in ChessCore
+ */
 UCLASS(CustomConstructor, Blueprintable)
 class UNREALCHESS_API AChessGameState : public AGameStateBase
 {
@@ -33,6 +40,7 @@ public:
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnKingCheck, EPieceColor, Side);
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnCheckMate, EPieceColor, Side);
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnStaleMate);
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnSlicedSearchComplete, const FChessAnalysis&, Analysis);
 	
 	UPROPERTY(BlueprintAssignable)
 	FOnMoveFailed MoveFailed;
@@ -45,8 +53,13 @@ public:
 
 	UPROPERTY(BlueprintAssignable)
 	FOnStaleMate StaleMate;
+
+	//Sliced search has finished, by a limit or the end of the iterations
+	UPROPERTY(BlueprintAssignable)
+	FOnSlicedSearchComplete SlicedSearchComplete;
 	
 	AChessGameState(const FObjectInitializer& ObjectInitializer);
+	~AChessGameState();
 
 	//Set moving side
 	UFUNCTION(BlueprintCallable, NetMulticast, Reliable, Category = "Set")
@@ -63,50 +76,129 @@ public:
 	const FChessPiece& GetPieceAtTile(EBoardFile File, EBoardRank Rank) const;
 
 	//Is tile attacked at index
-	bool IsTileAttacked(EBoardFile File, EBoardRank Rank, EPieceColor Side);
-	
-	//Add basic moves
-	void AddQuietMove(const FChessMove& Move);
-	void AddCaptureMove(const FChessMove& Move);
-	void AddEnPassantMove(const FChessMove& Move);
-
-	//Add pawn moves because they are tricky
-	void AddWhitePawnCaptureMove(const FTileCoord& From, const FTileCoord& To, const FChessPiece& Captured);
-	void AddWhitePawnMove(const FTileCoord& From, const FTileCoord& To);
-	void AddBlackPawnCaptureMove(const FTileCoord& From, const FTileCoord& To, const FChessPiece& Captured);
-	void AddBlackPawnMove(const FTileCoord& From, const FTileCoord& To);
+	bool IsTileAttacked(EBoardFile File, EBoardRank Rank, EPieceColor Side) const;
 
 	//All pieces move generation
 	UFUNCTION(NetMulticast, Reliable)
 	void GenerateAllMoves();
-	
-	//Move related functions
-	void ClearPiece(const FTileCoord& Coord);
-	
-	void AddPiece(const FTileCoord& Coord, const FChessPiece& Piece);
-	void MovePiece(const FTileCoord& From, const FTileCoord& To);
 
 	//Main move functions
 	//
 	//Revert move (Undo)
 	void TakeMove();
-	//Make move (Do)
+	//Make move (Do), returns false if the move is not one of the legal moves
 	bool MakeMove(const FChessMove& Move);
 
 	//Restart
 	void ResetBoard();
 	void CheckKingState();
 
-	//Get current moves for moving side
-	const TArray<FChessMove>& GetMoves() const;
+	//Get current moves for moving side, captures losing material are flagged (see FChessMoveList::IsLosingCapture)
+	const FChessMoveList& GetMoves() const;
+
+	/**Static exchange evaluation of the move in the current position
+	 * @param Move Legal move of the moving side
+	 * @return Material won by the exchange on the target square in centipawns, negative if the move loses material
+	 */
+	UFUNCTION(BlueprintCallable, Category = "AI")
+	int32 SEE(const FChessMove& Move) const;
+
+	//Underlying position, copy it to run analysis outside of the game thread
+	const FChessPosition& GetPosition() const;
+
+	/**Move of the opening book for the current position, picked at random by the book weights
+	 * The book is mapped once and shared by all games (see FChessOpeningBook::GetDefault)
+	 * @return Invalid move if there is no book or the position isn't in it
+	 */
+	UFUNCTION(BlueprintCallable, Category = "AI")
+	FChessMove GetBookMove() const;
+
+	/**Best move for the moving side, from the opening book or searched, blocks until any of the limits is reached
+	 * Searches use chess.SearchThreads threads, like the requests
+	 * @param TimeMs Time limit in milliseconds, 0 for no limit
+	 * @param Nodes Visited nodes limit, 0 for no limit
+	 * @param Depth Depth limit, 0 for no limit, the search takes a second if all limits are 0
+	 * @return Best move, invalid if there are no legal moves
+	 */
+	UFUNCTION(BlueprintCallable, Category = "AI")
+	FChessMove FindBestMove(int32 TimeMs, int32 Nodes, int32 Depth) const;
+
+	/**Search the current position on a worker thread, the game thread never waits for it
+	 * Pending requests are cancelled when the position changes (moves, undo, restart)
+	 * @param Limits When to stop, set at least one of them or the search only ends when cancelled
+	 * @param OnComplete Executed on the game thread with the result, unless cancelled
+	 * @return Task to poll or cancel
+	 */
+	TSharedRef<FChessAsyncSearch, ESPMode::ThreadSafe> RequestSearch(const FChessSearchLimits& Limits, FChessAsyncSearch::FOnComplete OnComplete);
+
+	/**Best move for the moving side, from the opening book or searched on a worker thread, latent version of FindBestMove
+	 * @param TimeMs Time limit in milliseconds, 0 for no limit
+	 * @param Nodes Visited nodes limit, 0 for no limit
+	 * @param Depth Depth limit, 0 for no limit, the search takes a second if all limits are 0
+	 * @param BestMove Best move, invalid if there are no legal moves
+	 */
+	UFUNCTION(BlueprintCallable, Category = "AI", meta = (Latent, LatentInfo = "LatentInfo"))
+	void RequestBestMove(int32 TimeMs, int32 Nodes, int32 Depth, FChessMove& BestMove, FLatentActionInfo LatentInfo);
+
+	/**Analyse the current position on a worker thread
+	 * @param TimeMs Time limit in milliseconds, 0 for no limit
+	 * @param Nodes Visited nodes limit, 0 for no limit
+	 * @param Depth Depth limit, 0 for no limit, the search takes a second if all limits are 0
+	 * @param Analysis Best move, score and the expected line
+	 */
+	UFUNCTION(BlueprintCallable, Category = "AI", meta = (Latent, LatentInfo = "LatentInfo"))
+	void RequestAnalysis(int32 TimeMs, int32 Nodes, int32 Depth, FChessAnalysis& Analysis, FLatentActionInfo LatentInfo);
+
+	//Stop all pending requests and the sliced search, their latent nodes and delegates never fire
+	UFUNCTION(BlueprintCallable, Category = "AI")
+	void CancelRequests();
+
+	//Is any request still searching
+	UFUNCTION(BlueprintCallable, Category = "AI")
+	bool HasPendingRequests() const;
+
+	/**Start searching the current position on the game thread, a slice each AdvanceSlicedSearch call
+	 * For servers without worker threads, AChessboard advances it every tick
+	 * Running sliced search is restarted, and stopped when the position changes
+	 * @param TimeMs Wall time limit in milliseconds, 0 for no limit
+	 * @param Nodes Visited nodes limit, 0 for no limit
+	 * @param Depth Depth limit, 0 for no limit, the search takes a second if all limits are 0
+	 */
+	UFUNCTION(BlueprintCallable, Category = "AI")
+	void StartSlicedSearch(int32 TimeMs, int32 Nodes, int32 Depth);
+
+	/**Search for the budget, then return with the search state kept for the next call
+	 * SlicedSearchComplete is broadcast when the search finishes
+	 * @param BudgetMicroseconds Wall time of the slice
+	 * @return True if the search is running after the slice
+	 */
+	bool AdvanceSlicedSearch(int32 BudgetMicroseconds);
+
+	//Stop the sliced search without broadcasting, the result found so far stays available
+	UFUNCTION(BlueprintCallable, Category = "AI")
+	void StopSlicedSearch();
+
+	UFUNCTION(BlueprintCallable, Category = "AI")
+	bool IsSlicedSearchRunning() const;
+
+	//Best move and score found so far, valid at any time after the start, also while searching
+	UFUNCTION(BlueprintCallable, Category = "AI")
+	FChessAnalysis GetSlicedSearchResult() const;
+
+	/**Static evaluation of the current position, by the network if chess.UseNetwork is set
+	 * @return Centipawns for the moving side
+	 */
+	UFUNCTION(BlueprintCallable, Category = "AI")
+	int32 Evaluate() const;
 
 	//
 	void BeginPlay() override;
+	void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	//Index converters
 	//
-	int32 GetTileAs64(int32 Tile120);
-	int32 GetTileAs120(int32 Tile64);
+	int32 GetTileAs64(int32 Tile120) const;
+	int32 GetTileAs120(int32 Tile64) const;
 
 	//
 	void EndGame(EEndChessGameReason Reason);
@@ -114,147 +206,23 @@ public:
 	//
 	UFUNCTION(BlueprintCallable, Category="Get")
 	bool IsFinished() const;
-
-	//Tile where en passant move is active
-	TOptional<int32> EnPassantTile = 0;
 	
 private:
 
 	bool bEnded = false;
-	
-	//Is king under check on moving side
-	bool IsCheck();
-
-	//Is king under checkmate on moving side
-	bool IsCheckMate();
-
-	//No moves?
-	bool IsStalemate() const;
-
-	//All tiles
-	TStaticArray<FChessBoardTile, 120> Tiles{ };
-
-	//Moves
-	TArray<FChessMove> Moves;
-
-	//For faster move generation
-	//Piece list
-	TStaticArray<TStaticArray<FTileCoord, 10>, 13> PieceList{ };
-	
-	//Pawns locations
-	TStaticArray<uint64, 3> Pawns{ 0 };
-
-	//King pieces positions
-	TStaticArray<FTileCoord, 2> Kings{ };
-
-	//The side that needs to make a move
-	EPieceColor Side = EPieceColor::Both;
-
-	//Total count of each chess piece, including empty tiles
-	//13 is a count of chess piece types by each color plus empty tiles count
-	TStaticArray<int32, 13> PieceCount{ 0 };
-
-	//Count of all non-pawn pieces
-	TStaticArray<int32, 2> BigPieces{ 0 };
-
-	//Count of rooks, queens
-	TStaticArray<int32, 2> MajorPieces{ 0 };
-
-	//Count of bishops, knights
-	TStaticArray<int32, 2> MinorPieces{ 0 };
-
-	//Total values of pieces by color
-	TStaticArray<int32, 2> Material;
 
-	//Tells which castle is available
-	int32 CastlePermission = 0;
-	
-	//Move generator helpers
-	//
-	void GenerateWhitePawnMoves();
-	void GenerateBlackPawnMoves();
-	void GenerateSlideMoves();
-	void GenerateNonSlideMoves();
-	void GenerateWhiteCastling();
-	void GenerateBlackCastling();
-
-	//Calculate total material
-	void UpdateListsMaterial();
-	
-	//Hashing related functions
-	//Will be used in history
-	//
-	void HashPiece(const FChessPiece& Piece, const FTileCoord& Coord);
-	void HashCastle();
-	void HashSide();
-	void HashEnPassant();
-
-	TStaticArray<TStaticArray<uint64, 120>, 13> PieceHashKeys{ TStaticArray<uint64, 120>{0} };
-	TStaticArray<uint64, 16> CastleHashKeys{ 0 };
-	uint64 SideHashKey = 0;
-	uint64 PosHashKey = 0;
-
-	void MakeHashKeys();
-	uint64 GeneratePositionHashKey();
-
-	//Converter arrays
-	//
-	TStaticArray<int32, 120> Array120To64Converter{ 0 };
-	TStaticArray<int32, 64> Array64To120Converter{ 0 };
-
-	//Init converter arrays
-	void MakeConverterArray_120To64();
-
-	//Main bitboard
-	uint64 Bitboard = 0;
-
-	//Masks
-	//
-	TStaticArray<uint64, 64> SetMask{ 0 };
-	TStaticArray<uint64, 64> ClearMask{ 0 };
+	//Board state and rules
+	FChessPosition Position;
 
-	void MakeBitMasks();
+	//Table of the requests of this board, shared with their workers which may outlive the game state
+	TSharedPtr<FChessTranspositionTable, ESPMode::ThreadSafe> RequestTable;
 
-	//Takes first bit, starting from the least significant bit, returns its index and sets it to zero
-	int32 PopBit();
+	//Requests until their workers finish, cancelled ones included
+	TArray<TSharedRef<FChessAsyncSearch, ESPMode::ThreadSafe>> Requests;
 
-	//Counts and returns number of non-zero bits in bitboard
-	int32 CountBits() const;
+	//Game thread search, created on the first start
+	TUniquePtr<FChessSlicedSearch> SlicedSearch;
 
-	//Clears bit to 0 at given tile
-	void ClearBit(uint64& BitBoard, int32 Idx);
-
-	//Sets bit to 1 at given tile
-	void SetBit(uint64& BitBoard, int32 Idx);
-
-	
-	/*****************Going to the WIP section*****************/
-
-	//Counter that detects 50 move (100 half-move), when game is a draw
-	int32 FiftyMoveCounter = 0;
-	
-	//
-	TArray<FChessMoveRecord> History;
-	
-	//See definition on www.chessprogrammingwiki.com
-	TArray<int32> BitTable = {
-		63, 10, 3, 32, 25, 41, 22, 33, 15, 50, 42, 13, 11, 53, 19, 34, 61, 29, 2,
-		51, 21, 43, 45, 10, 18, 47, 1, 54, 9, 57, 0, 35, 62, 31, 40, 4, 49, 5, 52,
-		26, 60, 6, 23, 44, 46, 27, 56, 16, 7, 39, 48, 24, 59, 14, 12, 55, 38, 28,
-		58, 20, 37, 17, 36, 8
-	};
-	
-	/****************************************************/
+	//Create the table of the requests on the first use, forget finished requests and age the table if nothing searches
+	void NewRequestSearch();
 };
-
-/* Game Move Encoding */
-//Use 28 bits	
-/*
-0000 0000 0000 0000 0000 0111 1111 -> From				0x7F
-0000 0000 0000 0011 1111 1000 0000 -> To					>> 7, 0x7F
-0000 0000 0011 1100 0000 0000 0000 -> Captured piece	>> 14, 0XF
-0000 0000 0100 0000 0000 0000 0000 -> Is En Passant		0x40000
-0000 0000 1000 0000 0000 0000 0000 -> Pawn start			0x80000
-0000 1111 0000 0000 0000 0000 0000 -> Promoted piece	>> 20, 0xF
-0001 0000 0000 0000 0000 0000 0000 -> Is Castling		0x1000000
- */
@@ -2,6 +2,7 @@
 
 
 #include "ChessGameStatics.h"
+#include "ChessPosition.h"
 
 #include "Kismet/GameplayStatics.h"
 
@@ -22,50 +23,30 @@ bool UChessGameStatics::IsCastlingMove(const FChessMove& Move)
 
 bool UChessGameStatics::IsCaptureMove(const FChessMove& Move)
 {
-	return Move.GetCapturedPiece() != GEmptyChessPiece.GetCode();
+	return Move.IsCapture();
 }
 
 bool UChessGameStatics::IsPromotionMove(const FChessMove& Move)
 {
-	return Move.GetPromotedPiece() != GEmptyChessPiece.GetCode();
+	return Move.IsPromotion();
 }
 
 int32 UChessGameStatics::GetTileIndexAt(EBoardFile File, EBoardRank Rank)
 {
-	return static_cast<int32>(File) + 21 + static_cast<int32>(Rank) * 10;
+	return FChessPosition::GetTileIndexAt(File, Rank);
 }
 
 int32 UChessGameStatics::GetTileIndexAt_64(EBoardFile File, EBoardRank Rank)
 {
-	return (int32)Rank * 8 + (int32)File;
+	return FChessPosition::GetTileIndexAt_64(File, Rank);
 }
 
-//Order of processing
-//
-//Assume we have 64bit integer
-//4		 15                   15                  15                  15 bit
-//0000 000000000000000 000000000000000 000000000000000 000000000000000
-//
-//We will have the following (divided by lines):
-//1. 0000 000000000000000 000000000000000 000000000000000 aaaaaaaaaaaaaaaaa
-//2. 0000 000000000000000 000000000000000 bbbbbbbbbbbbbbbbb aaaaaaaaaaaaaaaaa
-//3. 0000 000000000000000 ccccccccccccccccc bbbbbbbbbbbbbbbbb aaaaaaaaaaaaaaaaa
-//4. 0000 ddddddddddddddddd ccccccccccccccccc bbbbbbbbbbbbbbbbb aaaaaaaaaaaaaaaaa
-//5. eeee ddddddddddddddddd ccccccccccccccccc bbbbbbbbbbbbbbbbb aaaaaaaaaaaaaaaaa
-//
-//So we have 64 randomized bits (or uint64 randomized)
-
 uint64 UChessGameStatics::GetRandom64()
 {
-	return
-		(uint64)FMath::Rand() + 
-		((uint64)FMath::Rand() << 15) + 
-		((uint64)FMath::Rand() << 30) +
-		((uint64)FMath::Rand() << 45) +
-		(((uint64)FMath::Rand() & 0xf) << 60);
+	return FChessPosition::GetRandom64();
 }
 
 TPair<EBoardFile, EBoardRank> UChessGameStatics::ParsePositionFromString(const FString& InString)
 {
-	return MakeTuple(static_cast<EBoardFile>(InString[0] - L'a'), static_cast<EBoardRank>(InString[1] - L'1'));
-};
+	return FChessPosition::ParsePositionFromString(InString);
+};
\ No newline at end of file
@@ -0,0 +1,252 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ChessPerftCommandlet.h"
+#include "ChessBitboards.h"
+#include "ChessPerft.h"
+#include "ChessPosition.h"
+#include "Misc/FileHelper.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogChessPerft, Log, All);
+
+namespace
+{
+	//Position to test with known counts, if any
+	struct FPerftEntry
+	{
+		FString Name;
+		FString FEN;
+		TArray<uint64> Nodes;
+	};
+
+	//Parse line of "FEN ;D1 20 ;D2 400" format
+	bool ParseEntry(const FString& Line, FPerftEntry& OutEntry)
+	{
+		TArray<FString> Parts;
+		Line.ParseIntoArray(Parts, TEXT(";"), true);
+
+		if (Parts.Num() == 0 || Parts[0].TrimStartAndEnd().IsEmpty())
+		{
+			return false;
+		}
+
+		OutEntry.FEN = Parts[0].TrimStartAndEnd();
+		OutEntry.Name = OutEntry.FEN;
+
+		for (int32 i = 1; i < Parts.Num(); ++i)
+		{
+			FString DepthPart, CountPart;
+			if (Parts[i].TrimStartAndEnd().Split(TEXT(" "), &DepthPart, &CountPart) && DepthPart.StartsWith(TEXT("D")))
+			{
+				const int32 Depth = FCString::Atoi(*DepthPart.Mid(1));
+				if (Depth > 0)
+				{
+					OutEntry.Nodes.SetNumZeroed(FMath::Max(OutEntry.Nodes.Num(), Depth));
+					OutEntry.Nodes[Depth - 1] = FCString::Strtoui64(*CountPart.TrimStartAndEnd(), nullptr, 10);
+				}
+			}
+		}
+
+		return true;
+	}
+
+	//Run perft on each entry with the active backend, returns count of mismatches
+	//HashSizeMB above zero counts transposed subtrees only once
+	int32 RunEntries(const TArray<FPerftEntry>& Entries, int32 Depth, bool bDivide, int32 HashSizeMB)
+	{
+		TUniquePtr<FChessPerftCache> Cache;
+		if (HashSizeMB > 0)
+		{
+			Cache = MakeUnique<FChessPerftCache>(HashSizeMB);
+		}
+
+		int32 Failed = 0;
+		uint64 TotalNodes = 0;
+		double TotalSeconds = 0.0;
+
+		for (auto&& Entry : Entries)
+		{
+			FChessPosition Position;
+			if (!Position.InitBoard(Entry.FEN))
+			{
+				UE_LOG(LogChessPerft, Error, TEXT("Invalid FEN: %s"), *Entry.FEN);
+				++Failed;
+				continue;
+			}
+
+			//Without explicit depth use every known depth, but keep the run short
+			const int32 MaxDepth = Depth > 0 ? Depth : FMath::Clamp(Entry.Nodes.Num(), 1, 4);
+
+			UE_LOG(LogChessPerft, Display, TEXT("%s"), *Entry.Name);
+
+			for (int32 CurrentDepth = Depth > 0 ? Depth : 1; CurrentDepth <= MaxDepth; ++CurrentDepth)
+			{
+				const bool bLastDepth = CurrentDepth == MaxDepth;
+				const FChessPerftResult Result = FChessPerft::Run(Position, CurrentDepth, bDivide && bLastDepth, Cache.Get());
+
+				TotalNodes += Result.Nodes;
+				TotalSeconds += Result.Seconds;
+
+				const bool bKnown = Entry.Nodes.IsValidIndex(CurrentDepth - 1) && Entry.Nodes[CurrentDepth - 1] != 0;
+				const bool bMatch = !bKnown || Entry.Nodes[CurrentDepth - 1] == Result.Nodes;
+
+				if (bDivide && bLastDepth)
+				{
+					for (auto&& Divide : Result.Divide)
+					{
+						UE_LOG(LogChessPerft, Display, TEXT("    %s: %llu"), *Divide.Key.ToString(), Divide.Value);
+					}
+				}
+
+				UE_LOG(LogChessPerft, Display, TEXT("  depth %d: %llu nodes, %.3f s, %.0f nodes/s %s"),
+				       CurrentDepth,
+				       Result.Nodes,
+				       Result.Seconds,
+				       Result.GetNodesPerSecond(),
+				       bKnown ? (bMatch ? TEXT("OK") : TEXT("MISMATCH")) : TEXT("")
+				);
+
+				if (!bMatch)
+				{
+					UE_LOG(LogChessPerft, Error, TEXT("  expected %llu nodes"), Entry.Nodes[CurrentDepth - 1]);
+					++Failed;
+					break;
+				}
+			}
+		}
+
+		UE_LOG(LogChessPerft, Display, TEXT("Total: %llu nodes, %.3f s, %.0f nodes/s, %d failed"),
+		       TotalNodes,
+		       TotalSeconds,
+		       TotalSeconds > 0.0 ? TotalNodes / TotalSeconds : 0.0,
+		       Failed
+		);
+
+		return Failed;
+	}
+}
+
+UChessPerftCommandlet::UChessPerftCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Counts and times move generation on the chess test positions");
+	HelpUsage = TEXT("-run=ChessPerft [-depth=N] [-fen=\"FEN|FEN\"] [-fenfile=Path] [-divide] [-backend=classical|magic|pext|all] [-hash=MB]");
+}
+
+int32 UChessPerftCommandlet::Main(const FString& Params)
+{
+	int32 Depth = 0;
+	FParse::Value(*Params, TEXT("depth="), Depth);
+
+	const bool bDivide = FParse::Param(*Params, TEXT("divide"));
+
+	int32 HashSizeMB = 0;
+	FParse::Value(*Params, TEXT("hash="), HashSizeMB);
+
+	TArray<FPerftEntry> Entries;
+
+	FString FENList;
+	FString FENFile;
+
+	if (FParse::Value(*Params, TEXT("fen="), FENList))
+	{
+		TArray<FString> FENs;
+		FENList.ParseIntoArray(FENs, TEXT("|"), true);
+
+		for (auto&& FEN : FENs)
+		{
+			FPerftEntry Entry;
+			if (ParseEntry(FEN, Entry))
+			{
+				Entries.Emplace(MoveTemp(Entry));
+			}
+		}
+	}
+	else if (FParse::Value(*Params, TEXT("fenfile="), FENFile))
+	{
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadFileToStringArray(Lines, *FENFile))
+		{
+			UE_LOG(LogChessPerft, Error, TEXT("Failed to read %s"), *FENFile);
+			return 1;
+		}
+
+		for (auto&& Line : Lines)
+		{
+			FPerftEntry Entry;
+			if (ParseEntry(Line, Entry))
+			{
+				Entries.Emplace(MoveTemp(Entry));
+			}
+		}
+	}
+	else
+	{
+		for (auto&& Reference : FChessPerft::GetReferencePositions())
+		{
+			Entries.Add({ Reference.Name, Reference.FEN, Reference.Nodes });
+		}
+	}
+
+	if (Entries.Num() == 0)
+	{
+		UE_LOG(LogChessPerft, Error, TEXT("No positions to test"));
+		return 1;
+	}
+
+	TArray<EChessSliderBackend> Backends;
+
+	FString BackendName;
+	if (FParse::Value(*Params, TEXT("backend="), BackendName))
+	{
+		if (BackendName == TEXT("classical") || BackendName == TEXT("all"))
+		{
+			Backends.Add(EChessSliderBackend::Classical);
+		}
+
+		if (BackendName == TEXT("magic") || BackendName == TEXT("all"))
+		{
+			Backends.Add(EChessSliderBackend::Magic);
+		}
+
+		if (BackendName == TEXT("pext") || BackendName == TEXT("all"))
+		{
+			Backends.Add(EChessSliderBackend::Pext);
+		}
+
+		if (Backends.Num() == 0)
+		{
+			UE_LOG(LogChessPerft, Error, TEXT("Unknown backend %s"), *BackendName);
+			return 1;
+		}
+	}
+	else
+	{
+		Backends.Add(FChessBitboards::GetSliderBackend());
+	}
+
+	const EChessSliderBackend InitialBackend = FChessBitboards::GetSliderBackend();
+	int32 Failed = 0;
+
+	for (EChessSliderBackend Backend : Backends)
+	{
+		if (!FChessBitboards::SetSliderBackend(Backend))
+		{
+			UE_LOG(LogChessPerft, Warning, TEXT("%s backend is not supported by this CPU, skipping"),
+			       FChessBitboards::GetSliderBackendName(Backend));
+			continue;
+		}
+
+		UE_LOG(LogChessPerft, Display, TEXT("Sliding attacks backend: %s"), FChessBitboards::GetSliderBackendName(Backend));
+
+		Failed += RunEntries(Entries, Depth, bDivide, HashSizeMB);
+	}
+
+	FChessBitboards::SetSliderBackend(InitialBackend);
+
+	return Failed;
+}
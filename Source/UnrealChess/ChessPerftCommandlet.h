@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "ChessPerftCommandlet.generated.h"
+
+/**
+ * Headless move generator benchmark and validation
+ *
+ * Usage: UE4Editor-Cmd UnrealChess -run=ChessPerft -nullrhi [options]
+ *   -depth=N			Depth to search, by default every known depth up to 4
+ *   -fen="FEN"			Positions to test instead of the reference set, separated by '|'
+ *   -fenfile=Path		EPD-like file, one "FEN ;D1 20 ;D2 400" position per line
+ *   -divide			Print node counts for each root move
+ *   -backend=Name		Sliding attacks backend: classical, magic, pext or all to compare them
+ *   -hash=MB			Cache node counts of subtrees, transpositions are counted once
+ *
+ * Returns count of positions which didn't match known node counts
+ */
+UCLASS()
+class UNREALCHESS_API UChessPerftCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UChessPerftCommandlet();
+
+	int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,217 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ChessSearchBenchCommandlet.h"
+#include "ChessParallelSearch.h"
+#include "ChessPosition.h"
+#include "ChessTranspositionTable.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogChessSearchBench, Log, All);
+
+namespace
+{
+	//Middlegame positions of the perft suite, openings and endgames scale differently
+	const TCHAR* BenchPositions[] = {
+		TEXT("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"),
+		TEXT("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"),
+		TEXT("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"),
+		TEXT("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"),
+		TEXT("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"),
+		TEXT("r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10")
+	};
+
+	//Totals over all positions for one thread count
+	struct FBenchRun
+	{
+		int32 Threads = 0;
+		uint64 Nodes = 0;
+		double Seconds = 0.0;
+	};
+
+	FBenchRun RunBench(int32 Threads, int32 Depth, int32 HashSizeMB, const FChessSearchOptions& Options)
+	{
+		FBenchRun Run;
+		Run.Threads = Threads;
+
+		FChessTranspositionTable Table(HashSizeMB);
+		FChessParallelSearch Search(Table, Threads);
+		Search.SetOptions(Options);
+
+		FChessSearchLimits Limits;
+		Limits.Depth = Depth;
+
+		for (const TCHAR* FEN : BenchPositions)
+		{
+			FChessPosition Position;
+			Position.InitBoard(FEN);
+
+			//Every position starts cold, so runs with different thread counts are comparable
+			Table.Clear();
+
+			const FChessSearchResult Result = Search.Search(Position, Limits);
+
+			UE_LOG(LogChessSearchBench, Display, TEXT("  %2d threads: %s score %d, %llu nodes, %.3f s"),
+			       Threads,
+			       *Result.BestMove.ToString(),
+			       Result.Score,
+			       Result.Nodes,
+			       Result.Seconds
+			);
+
+			//Share of interior nodes which had to generate quiet moves, the rest cut off earlier
+			const FChessMovePickerStats& Stats = Result.PickerStats;
+			UE_LOG(LogChessSearchBench, Display, TEXT("              stages: %llu pickers, captures %llu, killers %llu, quiets %llu (%.1f%%), pawn hash hits %.1f%%"),
+			       Stats.GetPicks(),
+			       Stats.GetReached(EChessPickStage::Captures),
+			       Stats.GetReached(EChessPickStage::Killers),
+			       Stats.GetReached(EChessPickStage::Quiets),
+			       Stats.GetPicks() > 0 ? 100.0 * Stats.GetReached(EChessPickStage::Quiets) / Stats.GetPicks() : 0.0,
+			       100.0 * Result.PawnTableHitRate
+			);
+
+			Run.Nodes += Result.Nodes;
+			Run.Seconds += Result.Seconds;
+		}
+
+		return Run;
+	}
+
+	//Single thread runs with no pruning, each pruning alone, and all of them
+	void RunPruningBench(int32 Depth, int32 HashSizeMB)
+	{
+		FChessSearchOptions None;
+		None.bNullMove = false;
+		None.bLateMoveReductions = false;
+		None.bReverseFutility = false;
+		None.bRazoring = false;
+
+		TArray<TPair<FString, FChessSearchOptions>> Configs;
+		Configs.Emplace(TEXT("None"), None);
+
+		FChessSearchOptions Options = None;
+		Options.bNullMove = true;
+		Configs.Emplace(TEXT("Null move"), Options);
+
+		Options = None;
+		Options.bLateMoveReductions = true;
+		Configs.Emplace(TEXT("Late move reductions"), Options);
+
+		Options = None;
+		Options.bReverseFutility = true;
+		Configs.Emplace(TEXT("Reverse futility"), Options);
+
+		Options = None;
+		Options.bRazoring = true;
+		Configs.Emplace(TEXT("Razoring"), Options);
+
+		Configs.Emplace(TEXT("All"), FChessSearchOptions());
+
+		TArray<FBenchRun> Runs;
+
+		for (auto&& Config : Configs)
+		{
+			UE_LOG(LogChessSearchBench, Display, TEXT("%s:"), *Config.Key);
+			Runs.Add(RunBench(1, Depth, HashSizeMB, Config.Value));
+		}
+
+		//Savings are relative to the full width search
+		const FBenchRun& Base = Runs[0];
+
+		UE_LOG(LogChessSearchBench, Display, TEXT("Pruning                     Nodes     Time  Nodes saved  Time to depth speedup"));
+
+		for (int32 i = 0; i < Runs.Num(); ++i)
+		{
+			const FBenchRun& Run = Runs[i];
+
+			UE_LOG(LogChessSearchBench, Display, TEXT("%-20s %12llu %8.3f %11.1f%% %21.2fx"),
+			       *Configs[i].Key,
+			       Run.Nodes,
+			       Run.Seconds,
+			       Base.Nodes > 0 ? 100.0 - 100.0 * Run.Nodes / Base.Nodes : 0.0,
+			       Run.Seconds > 0.0 ? Base.Seconds / Run.Seconds : 0.0
+			);
+		}
+	}
+}
+
+UChessSearchBenchCommandlet::UChessSearchBenchCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Measures nodes per second and time to depth of the parallel search, or node savings of pruning");
+	HelpUsage = TEXT("-run=ChessSearchBench [-depth=N] [-threads=1,2,4,8,16] [-hash=MB] [-pruning]");
+}
+
+int32 UChessSearchBenchCommandlet::Main(const FString& Params)
+{
+	int32 Depth = 6;
+	FParse::Value(*Params, TEXT("depth="), Depth);
+
+	int32 HashSizeMB = 64;
+	FParse::Value(*Params, TEXT("hash="), HashSizeMB);
+
+	if (FParse::Param(*Params, TEXT("pruning")))
+	{
+		UE_LOG(LogChessSearchBench, Display, TEXT("Depth %d, hash %d MB, pruning comparison"), Depth, HashSizeMB);
+		RunPruningBench(Depth, HashSizeMB);
+		return 0;
+	}
+
+	TArray<int32> ThreadCounts = { 1, 2, 4, 8, 16 };
+
+	FString ThreadsList;
+	if (FParse::Value(*Params, TEXT("threads="), ThreadsList, false))
+	{
+		TArray<FString> Counts;
+		ThreadsList.ParseIntoArray(Counts, TEXT(","), true);
+
+		ThreadCounts.Reset();
+		for (auto&& Count : Counts)
+		{
+			ThreadCounts.Add(FMath::Max(FCString::Atoi(*Count), 1));
+		}
+	}
+
+	UE_LOG(LogChessSearchBench, Display, TEXT("Depth %d, hash %d MB, %d logical cores"),
+	       Depth,
+	       HashSizeMB,
+	       FPlatformMisc::NumberOfCoresIncludingHyperthreads()
+	);
+
+	TArray<FBenchRun> Runs;
+
+	for (int32 Threads : ThreadCounts)
+	{
+		Runs.Add(RunBench(Threads, Depth, HashSizeMB, FChessSearchOptions()));
+	}
+
+	if (Runs.Num() == 0)
+	{
+		return 1;
+	}
+
+	//Speedups are relative to the first run, a single thread one by default
+	const FBenchRun& Base = Runs[0];
+	const double BaseNodesPerSecond = Base.Seconds > 0.0 ? Base.Nodes / Base.Seconds : 0.0;
+
+	UE_LOG(LogChessSearchBench, Display, TEXT("Threads        Nodes     Time      Nodes/s  NPS scaling  Time to depth speedup"));
+
+	for (auto&& Run : Runs)
+	{
+		const double NodesPerSecond = Run.Seconds > 0.0 ? Run.Nodes / Run.Seconds : 0.0;
+
+		UE_LOG(LogChessSearchBench, Display, TEXT("%7d %12llu %8.3f %12.0f %11.2fx %21.2fx"),
+		       Run.Threads,
+		       Run.Nodes,
+		       Run.Seconds,
+		       NodesPerSecond,
+		       BaseNodesPerSecond > 0.0 ? NodesPerSecond / BaseNodesPerSecond : 0.0,
+		       Run.Seconds > 0.0 ? Base.Seconds / Run.Seconds : 0.0
+		);
+	}
+
+	return 0;
+}
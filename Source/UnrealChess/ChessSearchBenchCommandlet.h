@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "ChessSearchBenchCommandlet.generated.h"
+
+/**
+ * Headless search benchmark, measures Lazy SMP scaling or pruning node savings
+ *
+ * Usage: UE4Editor-Cmd UnrealChess -run=ChessSearchBench -nullrhi [options]
+ *   -depth=N			Depth to search each position to, 6 by default
+ *   -threads=1,2,4		Thread counts to compare, 1,2,4,8,16 by default
+ *   -hash=MB			Transposition table size, 64 by default
+ *   -pruning			Compare pruning options on one thread instead of thread counts
+ *
+ * Every thread count searches the same positions with a cleared table,
+ * nodes per second and time to depth are reported relative to the single thread run
+ * With -pruning the search without any pruning is the base, and each option is measured alone and all together
+ */
+UCLASS()
+class UNREALCHESS_API UChessSearchBenchCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UChessSearchBenchCommandlet();
+
+	int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,240 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ChessTablebaseCommandlet.h"
+#include "ChessPosition.h"
+#include "ChessTablebase.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogChessTablebaseCheck, Log, All);
+
+namespace
+{
+	//Position with a known result, for the side to move
+	struct FTablebaseCheck
+	{
+		const TCHAR* Name;
+		const TCHAR* FEN;
+
+		//Probe results, they ignore the fifty move counter
+		//
+		EChessWdl Wdl;
+		int32 Dtz;
+
+		//Result after the ProbeRoot move, the fifty move counter of the FEN is counted in
+		EChessWdl RootWdl;
+
+		//Best moves by ProbeRoot separated by spaces, empty if any move keeping the result is fine, null to not probe the root
+		const TCHAR* RootMoves;
+	};
+
+	/**Draws, and wins by a capture or promotion at once (DTZ 1), follow from the rules alone
+	 * Pawnless wins without captures only end by mate, so their DTZ is the distance to mate in plies,
+	 * found by a retrograde analysis which gives the published longest mates: KQvK 10 moves, KRvK 16, KBNvK 33
+	 * Cursed wins and blessed losses come from the fifty move counter of the FEN, tables store them from 5 pieces on only
+	 */
+	const FTablebaseCheck Checks[] = {
+		{ TEXT("KQvK win"), TEXT("4k3/8/8/8/8/8/8/4K2Q w - - 0 1"), EChessWdl::Win, 13, EChessWdl::Win, TEXT("") },
+		{ TEXT("KQvK loss"), TEXT("4k3/8/8/8/8/8/8/4K2Q b - - 0 1"), EChessWdl::Loss, -16, EChessWdl::Loss, TEXT("") },
+		{ TEXT("KQvK longest win"), TEXT("8/8/8/5k2/8/8/1Q6/K7 w - - 0 1"), EChessWdl::Win, 19, EChessWdl::Win, TEXT("") },
+		{ TEXT("KQvK longest loss"), TEXT("8/8/8/8/4k3/8/1Q6/K7 b - - 0 1"), EChessWdl::Loss, -20, EChessWdl::Loss, TEXT("") },
+		{ TEXT("KQvK queen taken"), TEXT("8/8/8/8/8/8/1k6/Q3K3 b - - 0 1"), EChessWdl::Draw, 0, EChessWdl::Draw, TEXT("b2a1") },
+		{ TEXT("KRvK win"), TEXT("4k3/8/8/8/8/8/8/R3K3 w - - 0 1"), EChessWdl::Win, 23, EChessWdl::Win, TEXT("") },
+		{ TEXT("KRvK win 2"), TEXT("5R2/8/8/3k4/8/K7/8/8 w - - 0 1"), EChessWdl::Win, 27, EChessWdl::Win, TEXT("") },
+		{ TEXT("KRvK loss"), TEXT("3k4/8/8/8/8/5R2/8/K7 b - - 0 1"), EChessWdl::Loss, -30, EChessWdl::Loss, TEXT("") },
+		{ TEXT("KRvK longest win"), TEXT("8/8/8/8/8/2k5/1R6/K7 w - - 0 1"), EChessWdl::Win, 31, EChessWdl::Win, TEXT("") },
+		{ TEXT("KRvK longest loss"), TEXT("8/8/8/8/8/8/1Rk5/K7 b - - 0 1"), EChessWdl::Loss, -32, EChessWdl::Loss, TEXT("") },
+		{ TEXT("KNvK draw"), TEXT("4k3/8/8/8/8/8/8/1N2K3 w - - 0 1"), EChessWdl::Draw, 0, EChessWdl::Draw, TEXT("") },
+		{ TEXT("KPvK promotion"), TEXT("8/4P3/8/8/8/8/k7/4K3 w - - 0 1"), EChessWdl::Win, 1, EChessWdl::Win, TEXT("e7e8q e7e8r") },
+		{ TEXT("KPvK rook pawn"), TEXT("k7/8/8/8/8/8/P7/K7 w - - 0 1"), EChessWdl::Draw, 0, EChessWdl::Draw, TEXT("") },
+		{ TEXT("KPvK stalemate"), TEXT("4k3/4P3/4K3/8/8/8/8/8 b - - 0 1"), EChessWdl::Draw, 0, EChessWdl::Draw, nullptr },
+		{ TEXT("KBNvK win"), TEXT("4k3/8/8/8/8/8/8/2B1KN2 w - - 0 1"), EChessWdl::Win, 57, EChessWdl::Win, TEXT("") },
+		{ TEXT("KBNvK loss"), TEXT("4k3/8/8/8/8/8/8/2B1KN2 b - - 0 1"), EChessWdl::Loss, -58, EChessWdl::Loss, TEXT("") },
+		{ TEXT("KBNvK win 2"), TEXT("8/k5K1/8/4N1B1/8/8/8/8 w - - 0 1"), EChessWdl::Win, 53, EChessWdl::Win, TEXT("") },
+		{ TEXT("KBNvK loss 2"), TEXT("2N5/2B5/8/k7/8/8/K7/8 b - - 0 1"), EChessWdl::Loss, -62, EChessWdl::Loss, TEXT("") },
+		{ TEXT("KBNvK longest win"), TEXT("8/8/7N/8/8/8/8/K1k1B3 w - - 0 1"), EChessWdl::Win, 65, EChessWdl::Win, TEXT("") },
+		{ TEXT("KBNvK longest loss"), TEXT("8/8/7N/8/8/8/8/K1k1B3 b - - 0 1"), EChessWdl::Loss, -66, EChessWdl::Loss, TEXT("") },
+		{ TEXT("KBNvK win in time"), TEXT("8/8/7N/8/8/8/8/K1k1B3 w - - 30 1"), EChessWdl::Win, 65, EChessWdl::Win, TEXT("") },
+		{ TEXT("KBNvK cursed win"), TEXT("8/8/7N/8/8/8/8/K1k1B3 w - - 36 1"), EChessWdl::Win, 65, EChessWdl::CursedWin, TEXT("") },
+		{ TEXT("KBNvK loss in time"), TEXT("8/8/7N/8/8/8/8/K1k1B3 b - - 30 1"), EChessWdl::Loss, -66, EChessWdl::Loss, TEXT("") },
+		{ TEXT("KBNvK blessed loss"), TEXT("8/8/7N/8/8/8/8/K1k1B3 b - - 36 1"), EChessWdl::Loss, -66, EChessWdl::BlessedLoss, TEXT("") },
+		{ TEXT("KNNvK draw"), TEXT("4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1"), EChessWdl::Draw, 0, EChessWdl::Draw, TEXT("") },
+		{ TEXT("KRvKR white takes"), TEXT("r3k3/8/8/8/8/8/8/R3K3 w - - 0 1"), EChessWdl::Win, 1, EChessWdl::Win, TEXT("a1a8") },
+		{ TEXT("KRvKR black takes"), TEXT("r3k3/8/8/8/8/8/8/R3K3 b - - 0 1"), EChessWdl::Win, 1, EChessWdl::Win, TEXT("a8a1") },
+		{ TEXT("KRRvKR white takes"), TEXT("r3k3/8/8/8/8/8/8/R3K2R w - - 0 1"), EChessWdl::Win, 1, EChessWdl::Win, TEXT("a1a8") },
+		{ TEXT("KRRvKR black takes"), TEXT("r3k3/8/8/8/8/8/8/R3K2R b - - 0 1"), EChessWdl::Win, 1, EChessWdl::Win, TEXT("a8a1") }
+	};
+
+	//Files which store full moves may give a distance one ply too long
+	bool IsExpectedDtz(int32 Dtz, int32 Expected)
+	{
+		return Dtz == Expected || (FMath::Abs(Expected) > 1 && Dtz == Expected + FMath::Sign(Expected));
+	}
+
+	const TCHAR* GetWdlName(EChessWdl Wdl)
+	{
+		switch (Wdl)
+		{
+		case EChessWdl::Loss:
+			return TEXT("loss");
+		case EChessWdl::BlessedLoss:
+			return TEXT("blessed loss");
+		case EChessWdl::CursedWin:
+			return TEXT("cursed win");
+		case EChessWdl::Win:
+			return TEXT("win");
+		default:
+			return TEXT("draw");
+		}
+	}
+
+	//Is the move one of the space separated ones
+	bool IsExpectedMove(const FChessMove& Move, const TCHAR* RootMoves)
+	{
+		TArray<FString> Expected;
+		FString(RootMoves).ParseIntoArray(Expected, TEXT(" "), true);
+
+		return Expected.Num() == 0 || Expected.Contains(Move.ToString());
+	}
+
+	enum class ECheckResult : uint8
+	{
+		Passed,
+		Failed,
+		Skipped
+	};
+
+	ECheckResult RunCheck(const FChessTablebase& Tablebase, const FTablebaseCheck& Check)
+	{
+		FChessPosition Position;
+		if (!Position.InitBoard(Check.FEN))
+		{
+			UE_LOG(LogChessTablebaseCheck, Error, TEXT("%s: invalid FEN %s"), Check.Name, Check.FEN);
+			return ECheckResult::Failed;
+		}
+
+		EChessWdl Wdl;
+		if (!Tablebase.ProbeWdl(Position, Wdl))
+		{
+			UE_LOG(LogChessTablebaseCheck, Display, TEXT("%s: skipped, table missing or unreadable"), Check.Name);
+			return ECheckResult::Skipped;
+		}
+
+		bool bPassed = Wdl == Check.Wdl;
+		FString Details = FString::Printf(TEXT("WDL %s"), GetWdlName(Wdl));
+
+		if (Wdl != Check.Wdl)
+		{
+			Details += FString::Printf(TEXT(" (expected %s)"), GetWdlName(Check.Wdl));
+		}
+
+		//WDL tables are often installed without the DTZ ones
+		int32 Dtz = 0;
+		if (Tablebase.ProbeDtz(Position, Dtz))
+		{
+			const bool bDtzMatch = IsExpectedDtz(Dtz, Check.Dtz);
+			bPassed &= bDtzMatch;
+
+			Details += FString::Printf(TEXT(", DTZ %d"), Dtz);
+
+			if (!bDtzMatch)
+			{
+				Details += FString::Printf(TEXT(" (expected %d)"), Check.Dtz);
+			}
+
+			FChessMove Move;
+			EChessWdl RootWdl;
+			int32 RootDtz;
+
+			if (Check.RootMoves != nullptr && Tablebase.ProbeRoot(Position, Move, RootWdl, RootDtz))
+			{
+				const bool bRootMatch = RootWdl == Check.RootWdl && IsExpectedMove(Move, Check.RootMoves);
+				bPassed &= bRootMatch;
+
+				Details += FString::Printf(TEXT(", root %s %s"), *Move.ToString(), GetWdlName(RootWdl));
+
+				if (!bRootMatch)
+				{
+					Details += FString::Printf(TEXT(" (expected %s %s)"), *Check.RootMoves ? Check.RootMoves : TEXT("any move"), GetWdlName(Check.RootWdl));
+				}
+			}
+			else if (Check.RootMoves != nullptr)
+			{
+				bPassed = false;
+				Details += TEXT(", root probe failed");
+			}
+		}
+		else
+		{
+			Details += TEXT(", DTZ table missing");
+		}
+
+		UE_LOG(LogChessTablebaseCheck, Display, TEXT("%s: %s %s"), Check.Name, *Details, bPassed ? TEXT("OK") : TEXT("MISMATCH"));
+
+		return bPassed ? ECheckResult::Passed : ECheckResult::Failed;
+	}
+}
+
+UChessTablebaseCommandlet::UChessTablebaseCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Checks Syzygy WDL, DTZ and root move probes against positions with known results");
+	HelpUsage = TEXT("-run=ChessTablebase [-path=Dir]");
+}
+
+int32 UChessTablebaseCommandlet::Main(const FString& Params)
+{
+	FString Directory = FChessTablebase::GetDefaultDirectory();
+	const bool bExplicitPath = FParse::Value(*Params, TEXT("path="), Directory);
+
+	FChessTablebase Tablebase(Directory);
+
+	//Tables are optional in the project, but a folder given to test must have them
+	if (Tablebase.GetTableCount() == 0)
+	{
+		if (bExplicitPath)
+		{
+			UE_LOG(LogChessTablebaseCheck, Error, TEXT("No Syzygy tables in %s"), *Directory);
+			return 1;
+		}
+
+		UE_LOG(LogChessTablebaseCheck, Display, TEXT("No Syzygy tables in %s, skipping"), *Directory);
+		return 0;
+	}
+
+	UE_LOG(LogChessTablebaseCheck, Display, TEXT("%d tables in %s, up to %d pieces"), Tablebase.GetTableCount(), *Directory, Tablebase.GetMaxPieces());
+
+	int32 Passed = 0;
+	int32 Failed = 0;
+	int32 Skipped = 0;
+
+	for (const FTablebaseCheck& Check : Checks)
+	{
+		switch (RunCheck(Tablebase, Check))
+		{
+		case ECheckResult::Passed:
+			++Passed;
+			break;
+		case ECheckResult::Failed:
+			++Failed;
+			break;
+		default:
+			++Skipped;
+			break;
+		}
+	}
+
+	UE_LOG(LogChessTablebaseCheck, Display, TEXT("Total: %d passed, %d failed, %d skipped"), Passed, Failed, Skipped);
+
+	//Unreadable tables skip every position, which mustn't pass as a test of the given folder
+	if (bExplicitPath && Passed == 0 && Failed == 0)
+	{
+		UE_LOG(LogChessTablebaseCheck, Error, TEXT("No position of %s could be probed"), *Directory);
+		return 1;
+	}
+
+	return Failed;
+}
@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "ChessTablebaseCommandlet.generated.h"
+
+/**
+ * Headless check of the Syzygy probing code against positions with known results
+ *
+ * Usage: UE4Editor-Cmd UnrealChess -run=ChessTablebase -nullrhi [options]
+ *   -path=Dir			Folder with the 3-4-5 piece tables, chess.SyzygyPath or Content/Syzygy by default
+ *
+ * Each position checks the WDL result, the exact DTZ, and the ProbeRoot move and result
+ * Positions whose tables are missing are skipped, and so is the whole run when the default folder has no tables
+ *
+ * Returns count of positions which didn't match known results, 1 if no position of the -path folder could be probed
+ */
+UCLASS()
+class UNREALCHESS_API UChessTablebaseCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UChessTablebaseCommandlet();
+
+	int32 Main(const FString& Params) override;
+};
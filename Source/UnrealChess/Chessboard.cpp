@@ -76,7 +76,7 @@ void AChessboard::AddSelection(AChess* Chess)
 
 				if (Tile)
 				{
-					if (Move.GetCapturedPiece() != GEmptyChessPiece.GetCode())
+					if (Move.IsCapture())
 						(*Tile)->SetType(ETileType::Capture);
 					else
 						(*Tile)->SetType(ETileType::Move);
@@ -303,6 +303,12 @@ void AChessboard::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	//Bots think a slice per frame, the tick never takes much longer than the budget
+	if (AChessGameState* GameState = GetChessGameState())
+	{
+		GameState->AdvanceSlicedSearch(SearchBudgetMicroseconds);
+	}
+
 	//DrawDebug();
 }
 
@@ -72,6 +72,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Board state")
 	FString FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 
+	//Wall time given to the sliced search of the game state every tick (see AChessGameState::StartSlicedSearch)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI", meta = (ClampMin = "0"))
+	int32 SearchBudgetMicroseconds = 2000;
+
 	//Perform move
 	//Called from controller
 	UFUNCTION(NetMulticast, Reliable)